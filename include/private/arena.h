@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_ARENA_H_
+#define PRIVATE_ARENA_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+#include <private/audio.h>
+#include <private/gain.h>
+#include <private/peaks.h>
+#include <private/window.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    class GainStage;
+
+    /**
+     * Scratch buffers and DSP units used by the processing of a single channel. The lists
+     * keep their capacity between uses, so they are allocated only when the processed data
+     * becomes larger than it was before. The filters and meters keep their configuration
+     * and buffers, so they are set up again only when the parameters change.
+     */
+    typedef struct scratch_t
+    {
+        lltl::darray<peak_t>    vPeaks;         // Local extremums of the signal
+        lltl::darray<peak_t>    vPosPeaks;      // Quantized positive peaks
+        lltl::darray<peak_t>    vNegPeaks;      // Quantized negative peaks
+        lltl::darray<float>     vValues;        // Values for estimating the median
+
+        WeightingFilter         sFilter;        // Weighting filter
+        SlidingWindow           sWindow;        // Sliding window over the weighted signal
+        RMSMeter                sMeter;         // Short-time RMS meter
+        ControlMeter            sControl;       // RMS meter at the control rate
+        LevelMeter              sLevel;         // Long-time RMS level meter
+        PeakDetector            sDetector;      // Detector of local extremums
+        GainComputer            sGain;          // Gain computer of the compressor
+        lltl::parray<GainStage> vStages;        // Gain stages of the passes
+
+        explicit scratch_t();
+        ~scratch_t();
+
+        void                    clear();
+
+        /**
+         * Get the list of gain stages, the stages are kept with their buffers between uses
+         * and should be initialized before processing
+         * @param count number of stages
+         * @return list of stages or NULL if there is not enough memory
+         */
+        GainStage             **stages(size_t count);
+    } scratch_t;
+
+    /**
+     * Arena of reusable scratch buffers: holds one slot per channel, processing
+     * stages draw their temporary data from the slot of the channel instead of
+     * allocating it on each call
+     */
+    class ScratchArena
+    {
+        private:
+            ScratchArena & operator = (const ScratchArena &);
+            ScratchArena(const ScratchArena &);
+
+        private:
+            lltl::parray<scratch_t> vSlots;
+
+        public:
+            explicit ScratchArena();
+            ~ScratchArena();
+
+            void                    destroy();
+
+        public:
+            /**
+             * Get number of allocated slots
+             * @return number of allocated slots
+             */
+            inline size_t           slots() const   { return vSlots.size(); }
+
+            /**
+             * Ensure that the arena has enough slots. Should be called before the slots are
+             * requested by the parallel tasks.
+             * @param count number of slots
+             * @return status of operation
+             */
+            status_t                reserve(size_t count);
+
+            /**
+             * Get the slot with cleared buffers
+             * @param index index of the slot
+             * @return pointer to the slot or NULL if the slot does not exist
+             */
+            scratch_t              *slot(size_t index);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_ARENA_H_ */
@@ -0,0 +1,208 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_ASYNC_H_
+#define PRIVATE_ASYNC_H_
+
+#include <lsp-plug.in/common/atomic.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/mm/IInAudioStream.h>
+#include <lsp-plug.in/mm/IOutAudioStream.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr size_t ASYNC_QUEUE_BLOCKS      = 4;            // Number of blocks in the queue between the I/O thread and the processing
+    static constexpr size_t ASYNC_WAIT_PERIOD       = 1;            // Period of polling the queue when it is full or empty, milliseconds
+
+    /**
+     * Lock-free single-producer single-consumer ring of fixed-size blocks of interleaved frames.
+     * The producer fills the block returned by back() and publishes it with push(), the consumer
+     * reads the block returned by front() and releases it with pop(). Each side modifies only its
+     * own counter, so no locking is required.
+     */
+    class BlockQueue
+    {
+        private:
+            BlockQueue & operator = (const BlockQueue &);
+            BlockQueue(const BlockQueue &);
+
+        private:
+            float                  *vData;          // Data of blocks
+            size_t                 *vCount;         // Number of frames in each block
+            size_t                  nBlocks;        // Number of blocks
+            size_t                  nBlockSize;     // Size of the block in samples
+            atomic_t                nHead;          // Number of blocks consumed
+            atomic_t                nTail;          // Number of blocks produced
+
+        public:
+            explicit BlockQueue();
+            ~BlockQueue();
+
+            /**
+             * Initialize the queue
+             * @param blocks number of blocks
+             * @param block_size size of each block in samples
+             * @return status of operation
+             */
+            status_t                init(size_t blocks, size_t block_size);
+            void                    destroy();
+
+        public:
+            /**
+             * Get the free block at the tail of the queue, producer side
+             * @return pointer to the block or NULL if the queue is full
+             */
+            float                  *back();
+
+            /**
+             * Publish the block obtained by back(), producer side
+             * @param count number of frames in the block, zero marks the end of data
+             */
+            void                    push(size_t count);
+
+            /**
+             * Get the block at the head of the queue, consumer side
+             * @param count pointer to store the number of frames in the block
+             * @return pointer to the block or NULL if the queue is empty
+             */
+            const float            *front(size_t *count);
+
+            /**
+             * Release the block obtained by front(), consumer side
+             */
+            void                    pop();
+    };
+
+    /**
+     * Reader of the audio stream in the separate thread: the thread decodes blocks ahead
+     * of the processing, so reading of the next block overlaps with processing of the
+     * current one.
+     */
+    class AsyncReader
+    {
+        private:
+            AsyncReader & operator = (const AsyncReader &);
+            AsyncReader(const AsyncReader &);
+
+        private:
+            BlockQueue              sQueue;         // Queue of read blocks
+            mm::IInAudioStream     *pStream;        // Input stream
+            ipc::Thread            *pThread;        // Reader thread
+            size_t                  nFrames;        // Maximum number of frames in the block
+            status_t                nResult;        // Result of reading: error code or STATUS_EOF
+            atomic_t                bCancel;        // Request to stop reading
+
+        protected:
+            static status_t         reader_main(void *arg);
+
+        public:
+            explicit AsyncReader();
+            ~AsyncReader();
+
+            /**
+             * Start reading the stream
+             * @param is input stream, should stay open until the reader is closed
+             * @param frames maximum number of frames in the block
+             * @return status of operation
+             */
+            status_t                open(mm::IInAudioStream *is, size_t frames);
+
+            /**
+             * Stop reading and wait for the thread to finish
+             */
+            void                    close();
+
+        public:
+            /**
+             * Wait for the next block of interleaved frames, the block stays valid until release()
+             * @param frames pointer to store the pointer to the block
+             * @return number of frames in the block, negative error code or -STATUS_EOF at the end of stream
+             */
+            ssize_t                 read(const float **frames);
+
+            /**
+             * Release the block obtained by read()
+             */
+            void                    release();
+    };
+
+    /**
+     * Writer of the audio stream in the separate thread: the thread encodes blocks submitted
+     * by the processing, so writing of the current block overlaps with processing of the
+     * next one.
+     */
+    class AsyncWriter
+    {
+        private:
+            AsyncWriter & operator = (const AsyncWriter &);
+            AsyncWriter(const AsyncWriter &);
+
+        private:
+            BlockQueue              sQueue;         // Queue of blocks to write
+            mm::IOutAudioStream    *pStream;        // Output stream
+            ipc::Thread            *pThread;        // Writer thread
+            size_t                  nChannels;      // Number of channels
+            status_t                nResult;        // Result of writing
+            atomic_t                bFailed;        // Writing has failed
+
+        protected:
+            static status_t         writer_main(void *arg);
+
+        public:
+            explicit AsyncWriter();
+            ~AsyncWriter();
+
+            /**
+             * Start writing the stream
+             * @param os output stream, should stay open until the writer is closed
+             * @param frames maximum number of frames in the block
+             * @return status of operation
+             */
+            status_t                open(mm::IOutAudioStream *os, size_t frames);
+
+            /**
+             * Write all submitted blocks and wait for the thread to finish
+             * @return status of writing
+             */
+            status_t                close();
+
+        public:
+            /**
+             * Wait for the free block to fill with interleaved frames
+             * @return pointer to the block or NULL if writing has failed
+             */
+            float                  *buffer();
+
+            /**
+             * Submit the block obtained by buffer() for writing
+             * @param frames number of frames in the block
+             */
+            void                    submit(size_t frames);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_ASYNC_H_ */
@@ -23,13 +23,22 @@
 #define PRIVATE_AUDIO_H_
 
 #include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/dynamics/DynamicProcessor.h>
+#include <lsp-plug.in/dsp-units/filters/Filter.h>
 #include <lsp-plug.in/dsp-units/sampling/Sample.h>
 #include <lsp-plug.in/lltl/darray.h>
 
+#include <private/control.h>
+#include <private/gain.h>
+#include <private/pool.h>
+
 namespace spike_bender
 {
     using namespace lsp;
 
+    class ScratchArena;
+    class Stats;
+
     /**
      * Frequency weightening function for the RMS estimation
      */
@@ -51,6 +60,13 @@ namespace spike_bender
         NORM_ALWAYS     // Always normalize
     };
 
+    enum resample_t
+    {
+        RESAMPLE_FAST,      // Short filter, lower stopband attenuation
+        RESAMPLE_NORMAL,    // Balance between speed and quality
+        RESAMPLE_BEST       // Long filter, high stopband attenuation
+    };
+
     typedef struct range_t
     {
         size_t first;   // The first sample in range
@@ -65,35 +81,77 @@ namespace spike_bender
         float  gain;    // The peak value
     } peak_t;
 
+    typedef struct duration_t
+    {
+        size_t h;
+        size_t m;
+        size_t s;
+        size_t ms;
+    } duration_t;
+
+    /**
+     * Compute the duration of the audio data
+     *
+     * @param d structure to store the duration
+     * @param samples number of samples
+     * @param sample_rate sample rate
+     */
+    void calc_duration(duration_t *d, wsize_t samples, size_t sample_rate);
+    void calc_duration(duration_t *d, const dspu::Sample *sample);
+
     /**
      * Load audio file and perform resampling
      *
      * @param sample sample to store audio data
      * @param name name of the file
      * @param srate desired sample rate
+     * @param quality quality of the sample rate conversion
+     * @param stats statistics to record decoding and resampling stages, may be NULL
      * @return status of operation
      */
-    status_t load_audio_file(dspu::Sample *sample, const LSPString *name, ssize_t srate);
+    status_t load_audio_file(dspu::Sample *sample, const LSPString *name, ssize_t srate,
+        resample_t quality = RESAMPLE_NORMAL, Stats *stats = NULL);
 
     /**
      * Save audio file
      *
      * @param sample sample to save
      * @param name file name
+     * @param gain gain applied to samples while encoding
      * @return status of operation
      */
-    status_t save_audio_file(const dspu::Sample *sample, const LSPString *name);
+    status_t save_audio_file(const dspu::Sample *sample, const LSPString *name, float gain = 1.0f);
 
 
+    /**
+     * Initialize the frequency weighting filter
+     * @param f filter to initialize
+     * @param weight weightening function
+     * @param sample_rate sample rate of the processed data
+     * @return status of operation
+     */
+    status_t init_weighting(dspu::Filter *f, weighting_t weight, size_t sample_rate);
+
+    /**
+     * Configure the dynamic processor to the upward compressor curve used for the gain adjustment
+     * @param dp dynamic processor to configure
+     * @param sample_rate sample rate of the processed data
+     * @param thresh the reference RMS gain
+     * @param range_db dynamic range in decibels
+     * @param knee_db knee in decibels
+     */
+    void configure_dynamics(dspu::DynamicProcessor *dp, size_t sample_rate, float thresh, float range_db, float knee_db);
+
     /**
      * Estimate the RMS of the input sample and store to another sample
      * @param dst destination sample to store data, is larger by period number of samples
      * @param src source sample to read data
      * @param weight weightening function
-     * @param period the RMS estimation frame size in samples
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param arena arena that holds weighting filters of channels, may be NULL
      * @return status of operation
      */
-    status_t apply_weight(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight);
+    status_t apply_weight(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, TaskPool *pool = NULL, ScratchArena *arena = NULL);
 
     /**
      * Estimate the RMS of the input sample and store to another sample
@@ -101,12 +159,46 @@ namespace spike_bender
      * @param src source sample to read data
      * @param weight weightening function
      * @param period the RMS estimation frame size in samples
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param arena arena that holds meters of channels, may be NULL
+     * @return status of operation
+     */
+    status_t estimate_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period,
+        TaskPool *pool = NULL, ScratchArena *arena = NULL);
+
+    /**
+     * Estimate the maximum of the RMS of each channel of the input sample without storing the RMS
+     * @param dst destination buffer to store the maximum RMS value of each channel
+     * @param src source sample to read data
+     * @param weight weightening function
+     * @param period the RMS estimation frame size in samples
+     * @param decimation decimation factor of the coarse pre-scan: the window slides by blocks of
+     *        the specified size, 1 for the same result as the maximum of estimate_rms() output
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param arena arena that holds meters of channels, may be NULL
      * @return status of operation
      */
-    status_t estimate_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period);
-    status_t estimate_average(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period);
-    status_t estimate_partial_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, bool positive);
-    status_t estimate_rms_balance(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period);
+    status_t estimate_rms_peak(float *dst, const dspu::Sample *src, weighting_t weight, size_t period,
+        size_t decimation, TaskPool *pool = NULL, ScratchArena *arena = NULL);
+
+    /**
+     * Estimate the RMS of the input sample at the control rate and store it in the specified format
+     * @param dst destination buffer to store data, covers the input sample extended by period number of samples
+     * @param src source sample to read data
+     * @param weight weightening function
+     * @param period the RMS estimation frame size in samples
+     * @param decimation decimation factor of the RMS, each output value is the RMS of the window that
+     *        ends at the last sample of the decimation block
+     * @param format storage format of the RMS values
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param arena arena that holds meters of channels, may be NULL
+     * @return status of operation
+     */
+    status_t estimate_control_rms(ControlBuffer *dst, const dspu::Sample *src, weighting_t weight, size_t period,
+        size_t decimation, control_format_t format, TaskPool *pool = NULL, ScratchArena *arena = NULL);
+    status_t estimate_average(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, ScratchArena *arena = NULL);
+    status_t estimate_partial_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, bool positive, ScratchArena *arena = NULL);
+    status_t estimate_rms_balance(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, ScratchArena *arena = NULL);
     status_t apply_rms_balance(dspu::Sample *dst, const dspu::Sample *src, const dspu::Sample *rms);
 
     /**
@@ -135,27 +227,145 @@ namespace spike_bender
 
     status_t apply_gain(float *buf, lltl::darray<range_t> *ranges, float threshold);
 
+    /**
+     * Adjust the gain of the signal according to the envelope. The processing is performed
+     * in place if dst is the same sample as src.
+     *
+     * @param dst destination sample, may be the same as src
+     * @param gain sample to store the gain, NULL if not required
+     * @param src source sample
+     * @param env envelope of the source sample
+     * @param offset offset of the envelope relative to the source sample (latency)
+     * @param thresh threshold for each channel
+     * @param range_db range of the gain adjustment
+     * @param knee_db knee of the compressor
+     * @param curve evaluation of the compressor curve
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param arena arena that holds gain computers of channels, may be NULL
+     * @param peaks array to store the absolute peak value of each output channel, may be NULL
+     * @return status of operation
+     */
     status_t adjust_gain(
         dspu::Sample *dst,
         dspu::Sample *gain,
         const dspu::Sample *src,
         const dspu::Sample *env,
+        size_t offset,
         const float *thresh,
         float range_db,
-        float knee_db);
+        float knee_db,
+        gain_curve_t curve = GAIN_CURVE_EXACT,
+        TaskPool *pool = NULL,
+        ScratchArena *arena = NULL,
+        float *peaks = NULL);
+
+    /**
+     * Adjust the gain of the signal according to the envelope at the control rate. The gain is
+     * computed at the control rate and linearly interpolated to the sample rate when applied.
+     * The processing is performed in place if dst is the same sample as src.
+     *
+     * @param dst destination sample, may be the same as src
+     * @param src source sample
+     * @param env envelope of the source sample at the control rate
+     * @param offset offset of the envelope relative to the source sample (latency)
+     * @param decimation decimation factor of the envelope
+     * @param thresh threshold for each channel
+     * @param range_db range of the gain adjustment
+     * @param knee_db knee of the compressor
+     * @param curve evaluation of the compressor curve
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param arena arena that holds gain computers of channels, may be NULL
+     * @param peaks array to store the absolute peak value of each output channel, may be NULL
+     * @return status of operation
+     */
+    status_t adjust_control_gain(
+        dspu::Sample *dst,
+        const dspu::Sample *src,
+        const ControlBuffer *env,
+        size_t offset,
+        size_t decimation,
+        const float *thresh,
+        float range_db,
+        float knee_db,
+        gain_curve_t curve = GAIN_CURVE_EXACT,
+        TaskPool *pool = NULL,
+        ScratchArena *arena = NULL,
+        float *peaks = NULL);
+
+    status_t estimate_envelope(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, ScratchArena *arena = NULL);
+
+    /**
+     * Smash the peaks that are significantly above the median peak values. The gain is ramped
+     * between neighbour peaks, the ranges longer than PEAK_RAMP_MAX samples are split at the samples
+     * between them. The processing is performed in place if dst is the same sample as src.
+     *
+     * @param dst destination sample, may be the same as src
+     * @param src source sample
+     * @param threshold threshold relative to the median peak value
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param arena arena of scratch buffers, may be NULL
+     * @param peaks array to store the absolute peak value of each output channel, may be NULL
+     * @return status of operation
+     */
+    status_t smash_amplitude(dspu::Sample *dst, const dspu::Sample *src, float threshold, TaskPool *pool = NULL,
+        ScratchArena *arena = NULL, float *peaks = NULL);
 
-    status_t estimate_envelope(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period);
+    /**
+     * Compute the median gain of the list of peaks
+     * @param res pointer to store the result
+     * @param list list of peaks
+     * @param buf buffer to store temporary data, may be NULL
+     * @return false if there is not enough memory
+     */
+    bool median_value(float *res, const lltl::darray<peak_t> *list, lltl::darray<float> *buf = NULL);
+
+    /**
+     * Compute the gain that should be applied to the peak when smashing amplitude
+     * @param peak the peak value
+     * @param p_avg median value of positive peaks
+     * @param n_avg median value of negative peaks
+     * @param threshold peak threshold relative to the median value
+     * @return gain to apply to the peak
+     */
+    float peak_gain(float peak, float p_avg, float n_avg, float threshold);
+
+    /**
+     * Apply smooth gain transition between two peaks. The buffer is left untouched
+     * if the gain stays at unity
+     * @param dst buffer to apply the gain
+     * @param gain the gain at the beginning of the buffer
+     * @param egain the gain at the end of the buffer, reached right after the last sample of the buffer
+     * @param count number of samples in the buffer
+     */
+    void apply_peak_ramp(float *dst, float gain, float egain, size_t count);
 
-    status_t smash_amplitude(dspu::Sample *dst, const dspu::Sample *src, float threshold);
+    /**
+     * Compute the normalization gain
+     * @param peak the maximum peak value of the signal
+     * @param gain the maximum peak gain
+     * @param mode the normalization mode
+     * @return the gain to apply to the signal
+     */
+    float normalize_gain(float peak, float gain, normalize_t mode);
+
+    /**
+     * Estimate the absolute peak value of each channel
+     * @param src source sample
+     * @param peaks array to store the absolute peak value of each channel
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @return status of operation
+     */
+    status_t estimate_peaks(const dspu::Sample *src, float *peaks, TaskPool *pool = NULL);
 
     /**
      * Normalize sample to the specified gain
      * @param dst sample to normalize
      * @param gain the maximum peak gain
      * @param mode the normalization mode
+     * @param pool the pool to process channels in parallel, may be NULL
      * @return status of operation
      */
-    status_t normalize(dspu::Sample *dst, float gain, normalize_t mode);
+    status_t normalize(dspu::Sample *dst, float gain, normalize_t mode, TaskPool *pool = NULL);
 } /* namespace spike_bender */
 
 
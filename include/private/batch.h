@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_BATCH_H_
+#define PRIVATE_BATCH_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+#include <private/config.h>
+#include <private/stats.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    /**
+     * Single job of the batch
+     */
+    typedef struct job_t
+    {
+        LSPString           sInFile;        // Input file
+        LSPString           sOutFile;       // Output file
+        status_t            nResult;        // Result of processing
+        Stats               sStats;         // Statistics of processing
+    } job_t;
+
+    /**
+     * Destroy the list of jobs
+     * @param list list of jobs
+     */
+    void destroy_jobs(lltl::parray<job_t> *list);
+
+    /**
+     * Build the list of jobs from the batch file or the input directory. The jobs that would
+     * overwrite the input file or the output file of another job are marked as failed
+     *
+     * @param list list to store jobs
+     * @param cfg configuration
+     * @return status of operation
+     */
+    status_t build_jobs(lltl::parray<job_t> *list, const config_t *cfg);
+
+    /**
+     * Process the batch of files. Failure of processing the single file does not
+     * abort processing of the rest files.
+     *
+     * @param cfg configuration
+     * @return status of operation: STATUS_OK if all files have been processed successfully
+     */
+    status_t process_batch(const config_t *cfg);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_BATCH_H_ */
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_CACHE_H_
+#define PRIVATE_CACHE_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+#include <private/config.h>
+#include <private/wavmap.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    /**
+     * Key of the analysis: everything the decoded signal and the long-time RMS depend on
+     */
+    typedef struct cache_key_t
+    {
+        uint64_t                nHash;          // Hash of the input file contents
+        uint64_t                nSize;          // Size of the input file
+        int64_t                 nSampleRate;    // Requested sample rate
+        uint32_t                nResample;      // Resampling quality
+        uint32_t                nWeighting;     // Weighting function
+        uint64_t                nScanDecimation;// Decimation factor of the long-time RMS pre-scan
+    } cache_key_t;
+
+    /**
+     * Analysis cache: the sidecar file that holds the decoded (and resampled) signal along
+     * with the long-time RMS level of each channel. The file is stored in the native byte
+     * order and is mapped into memory for reading, so the re-run with different dynamics
+     * parameters starts directly from the gain adjustment.
+     */
+    class AnalysisCache
+    {
+        private:
+            AnalysisCache & operator = (const AnalysisCache &);
+            AnalysisCache(const AnalysisCache &);
+
+        private:
+            MappedFile              sFile;          // Mapped file
+            const float            *vLevels;        // Long-time RMS levels
+            const float            *vData;          // Samples of channels
+            size_t                  nChannels;      // Number of channels
+            size_t                  nLength;        // Length of each channel
+            size_t                  nSampleRate;    // Sample rate
+
+        public:
+            explicit AnalysisCache();
+            ~AnalysisCache();
+
+            /**
+             * Open the cache file
+             * @param path path to the cache file
+             * @param key the expected key of the analysis
+             * @return status of operation, STATUS_NOT_FOUND if there is no file,
+             *   STATUS_BAD_FORMAT if the file is damaged or holds another analysis
+             */
+            status_t                open(const LSPString *path, const cache_key_t *key);
+            status_t                close();
+
+        public:
+            inline size_t           channels() const    { return nChannels; }
+            inline size_t           length() const      { return nLength; }
+            inline size_t           sample_rate() const { return nSampleRate; }
+            inline float            level(size_t channel) const { return vLevels[channel]; }
+
+            /**
+             * Copy the cached signal to the sample
+             * @param dst destination sample
+             * @return status of operation
+             */
+            status_t                load(dspu::Sample *dst) const;
+
+            /**
+             * Write the analysis to the cache file
+             * @param path path to the cache file
+             * @param key key of the analysis
+             * @param src decoded signal
+             * @param levels long-time RMS level of each channel
+             * @return status of operation
+             */
+            static status_t         save(const LSPString *path, const cache_key_t *key,
+                                        const dspu::Sample *src, const float *levels);
+    };
+
+    /**
+     * Compute the key of the analysis
+     * @param key key to store
+     * @param in_file input file
+     * @param cfg configuration
+     * @return status of operation
+     */
+    status_t make_cache_key(cache_key_t *key, const LSPString *in_file, const config_t *cfg);
+
+    /**
+     * Get the path to the cache file of the analysis
+     * @param dst string to store the path
+     * @param dir cache directory
+     * @param key key of the analysis
+     * @return status of operation
+     */
+    status_t make_cache_path(LSPString *dst, const LSPString *dir, const cache_key_t *key);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_CACHE_H_ */
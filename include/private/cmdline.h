@@ -48,6 +48,33 @@ namespace spike_bender
      */
     status_t parse_cmdline(config_t *cfg, int argc, const char **argv);
 
+    /**
+     * Parse integer value
+     * @param dst pointer to store the value
+     * @param val string representation of the value
+     * @param parameter name of the parameter for the error message
+     * @return status of operation
+     */
+    status_t parse_cmdline_int(ssize_t *dst, const char *val, const char *parameter);
+
+    /**
+     * Parse floating-point value
+     * @param dst pointer to store the value
+     * @param val string representation of the value
+     * @param parameter name of the parameter for the error message
+     * @return status of operation
+     */
+    status_t parse_cmdline_float(float *dst, const char *val, const char *parameter);
+
+    /**
+     * Parse normalization mode
+     * @param dst pointer to store the value
+     * @param val string representation of the value
+     * @param parameter name of the parameter for the error message
+     * @return status of operation
+     */
+    status_t parse_cmdline_normalize(normalize_t *dst, const char *val, const char *parameter);
+
 } /* namespace spike_bender */
 
 
@@ -29,6 +29,18 @@ namespace spike_bender
 {
     using namespace lsp;
 
+    /**
+     * Parameters of the dynamics processing that may differ between outputs of the same input
+     */
+    typedef struct dynamics_t
+    {
+        ssize_t                                 nPasses;        // Number of passes
+        float                                   fRange;         // Range in decibels
+        float                                   fKnee;          // Knee in decibels
+        float                                   fPeakThresh;    // Amplitude smash threshold
+        normalize_t                             enNormalize;    // Normalization method
+    } dynamics_t;
+
     /**
      * Overall configuration
      */
@@ -39,17 +51,35 @@ namespace spike_bender
 
         public:
             ssize_t                                 nSampleRate;    // Sample rate
+            resample_t                              enResample;     // Resampling quality
             LSPString                               sInFile;        // Input file
             LSPString                               sOutFile;       // Output file
             ssize_t                                 nPasses;        // Number of passes
             float                                   fReactivity;    // Reactivity in milliseconds
             float                                   fRange;         // Range in decibels
             float                                   fKnee;          // Knee in decibels
+            ssize_t                                 nDecimation;    // Decimation factor of the control signal
+            control_format_t                        enControlFormat;// Storage format of the decimated control signal
+            ssize_t                                 nScanDecimation;// Decimation factor of the long-time RMS pre-scan
+            gain_curve_t                            enGainCurve;    // Evaluation of the compressor curve
             weighting_t                             enWeighting;    // Weighting function
             normalize_t                             enNormalize;    // Normalization method
             float                                   fNormGain;      // Normalization gain
             float                                   fPeakThresh;    // Amplitude smash threshold
             bool                                    bEliminatePeaks;// Eliminate peaks
+            bool                                    bStreaming;     // Streaming (block-based) processing
+            ssize_t                                 nBlockSize;     // Block size for streaming processing
+            ssize_t                                 nThreads;       // Number of worker threads, 0 for number of CPU cores
+            bool                                    bLive;          // Live (low-latency) processing of the standard input
+            ssize_t                                 nChannels;      // Number of channels of the live stream
+            LSPString                               sBatchFile;     // Batch manifest file
+            LSPString                               sInDir;         // Input directory for batch processing
+            LSPString                               sOutDir;        // Output directory for batch processing
+            LSPString                               sOutName;       // Output file name template for batch processing
+            ssize_t                                 nJobs;          // Number of files processed simultaneously
+            LSPString                               sStatsFile;     // Output file for processing statistics
+            LSPString                               sCacheDir;      // Directory of the analysis cache
+            LSPString                               sSweepFile;     // Parameter sweep file
 
         public:
             explicit config_t();
@@ -57,6 +87,24 @@ namespace spike_bender
 
         public:
             void clear();
+
+            /**
+             * Get the dynamics parameters
+             * @param dst parameters to store
+             */
+            void get_dynamics(dynamics_t *dst) const;
+
+            /**
+             * Check that batch processing is configured
+             * @return true if batch processing is configured
+             */
+            inline bool is_batch() const { return (!sBatchFile.is_empty()) || (!sInDir.is_empty()); }
+
+            /**
+             * Check that parameter sweep is configured
+             * @return true if parameter sweep is configured
+             */
+            inline bool is_sweep() const { return !sSweepFile.is_empty(); }
     };
 
 } /* namespace spike_bender */
@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_CONTEXT_H_
+#define PRIVATE_CONTEXT_H_
+
+#include <private/arena.h>
+#include <private/config.h>
+#include <private/pool.h>
+#include <private/stats.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    /**
+     * Processing context: holds the resources that are reused between passes and stages
+     * while processing the file, and between files processed by the same batch worker
+     */
+    class Context
+    {
+        private:
+            Context & operator = (const Context &);
+            Context(const Context &);
+
+        private:
+            TaskPool                sPool;          // Pool of threads to process channels
+            ScratchArena            sArena;         // Scratch buffers of channels
+            Stats                   sStats;         // Statistics of processing stages
+
+        public:
+            /**
+             * Create the context
+             * @param cfg configuration to take the number of threads to process channels from
+             */
+            explicit Context(const config_t *cfg);
+            ~Context();
+
+        public:
+            inline TaskPool        *pool()          { return &sPool; }
+            inline ScratchArena    *arena()         { return &sArena; }
+            inline Stats           *stats()         { return &sStats; }
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_CONTEXT_H_ */
@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_CONTROL_H_
+#define PRIVATE_CONTROL_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr ssize_t CONTROL_LOG16_MIN_EXP  = -28;          // Binary exponent of the smallest non-zero value of logarithmic code (-168 dB)
+    static constexpr size_t CONTROL_BLOCK_SIZE      = 0x400;        // Block size for conversion of control values
+
+    /**
+     * Storage format of the control signal
+     */
+    enum control_format_t
+    {
+        CONTROL_F32,        // 32-bit floating point
+        CONTROL_F16,        // 16-bit half-precision floating point
+        CONTROL_LOG16       // 16-bit logarithmic code: exponent and 11 upper bits of mantissa
+    };
+
+    /**
+     * Multi-channel buffer of the smooth control signal (RMS, envelope) stored in full or
+     * reduced precision. The values are converted on store and load block by block with
+     * plain loops over integer representation, so the conversion is vectorized by the compiler.
+     *
+     * The logarithmic code holds the exponent and the upper bits of mantissa of non-negative
+     * float values in range of 32 octaves starting from 2^CONTROL_LOG16_MIN_EXP, so the
+     * relative precision is 2^-12 over the whole range. Zero code stands for zero value.
+     */
+    class ControlBuffer
+    {
+        private:
+            ControlBuffer & operator = (const ControlBuffer &);
+            ControlBuffer(const ControlBuffer &);
+
+        private:
+            uint8_t                *vData;          // Data of channels
+            size_t                  nChannels;      // Number of channels
+            size_t                  nLength;        // Length of each channel in values
+            size_t                  nSampleRate;    // Sample rate of the original signal
+            control_format_t        enFormat;       // Storage format
+
+        protected:
+            inline size_t           value_size() const  { return (enFormat == CONTROL_F32) ? sizeof(float) : sizeof(uint16_t); }
+            inline uint8_t         *data(size_t channel, size_t offset) const
+                                                        { return &vData[(channel * nLength + offset) * value_size()]; }
+
+        public:
+            explicit ControlBuffer();
+            ~ControlBuffer();
+
+            /**
+             * Initialize the buffer
+             * @param channels number of channels
+             * @param length length of each channel in values
+             * @param format storage format
+             * @return status of operation
+             */
+            status_t                init(size_t channels, size_t length, control_format_t format);
+            void                    destroy();
+
+        public:
+            inline size_t           channels() const    { return nChannels; }
+            inline size_t           length() const      { return nLength; }
+            inline size_t           sample_rate() const { return nSampleRate; }
+            inline control_format_t format() const      { return enFormat; }
+            inline size_t           bytes() const       { return nChannels * nLength * value_size(); }
+            inline void             set_sample_rate(size_t sr)  { nSampleRate = sr; }
+
+            /**
+             * Swap contents with another buffer
+             * @param dst buffer to swap with
+             */
+            void                    swap(ControlBuffer *dst);
+
+            /**
+             * Convert values and store them to the buffer
+             * @param channel channel number
+             * @param offset offset of the first value
+             * @param src values to store
+             * @param count number of values
+             */
+            void                    store(size_t channel, size_t offset, const float *src, size_t count);
+
+            /**
+             * Fill the range of the buffer with a single value
+             * @param channel channel number
+             * @param offset offset of the first value
+             * @param value value to store
+             * @param count number of values
+             */
+            void                    fill(size_t channel, size_t offset, float value, size_t count);
+
+            /**
+             * Load values from the buffer and convert them to floating point
+             * @param dst destination to store values
+             * @param channel channel number
+             * @param offset offset of the first value
+             * @param count number of values
+             */
+            void                    load(float *dst, size_t channel, size_t offset, size_t count) const;
+    };
+
+    // Conversion of the control values, exposed for testing
+    void encode_f16(uint16_t *dst, const float *src, size_t count);
+    void decode_f16(float *dst, const uint16_t *src, size_t count);
+    void encode_log16(uint16_t *dst, const float *src, size_t count);
+    void decode_log16(float *dst, const uint16_t *src, size_t count);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_CONTROL_H_ */
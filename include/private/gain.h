@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_GAIN_H_
+#define PRIVATE_GAIN_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/dynamics/DynamicProcessor.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr float  GAIN_ATTACK_TIME        = 5.0f;         // Attack time above the reaction level, ms
+    static constexpr float  GAIN_RELEASE_LOW_TIME   = 5.0f;         // Release time below the reaction level, ms
+    static constexpr float  GAIN_RELEASE_TIME       = 2.0f;         // Release time above the reaction level, ms
+    static constexpr float  GAIN_REACTION_LEVEL     = -6.0f;        // Reaction level relative to the threshold, dB
+    static constexpr size_t GAIN_TABLE_BITS         = 6;            // Number of mantissa bits that index the gain table
+    static constexpr ssize_t GAIN_TABLE_MIN_EXP     = -24;          // Binary exponent of the lowest envelope level in the table
+    static constexpr ssize_t GAIN_TABLE_MAX_EXP     = 4;            // Binary exponent of the highest envelope level in the table
+
+    /**
+     * Evaluation of the compressor curve
+     */
+    enum gain_curve_t
+    {
+        GAIN_CURVE_EXACT,           // The dynamic processor computes the gain
+        GAIN_CURVE_TABLE            // The gain is looked up in the table of the curve
+    };
+
+    /**
+     * Gain computer of the upward compressor configured by configure_dynamics().
+     *
+     * By default the gain is computed by the dynamic processor, so the output is exactly
+     * the same as the output of dspu::DynamicProcessor::process().
+     *
+     * The table mode trades precision for speed. The curve is defined by the range and knee
+     * relative to the threshold, so it is sampled once for the unit threshold into the table
+     * indexed by the exponent and the upper mantissa bits of the envelope (that is, in the log
+     * domain) and the gain is linearly interpolated between entries, the interpolation error
+     * is within 1% of the gain. The threshold only scales the envelope before the lookup.
+     * The envelope follower performs the same computations as the dynamic processor for the
+     * attack and release reactions configured by configure_dynamics(): the reaction is selected
+     * without branches by the direction of the change and the envelope level, the lookup runs
+     * as a separate loop over the block. Several gain computers may follow their envelopes in
+     * lockstep, so the recurrences of channels processed by the same thread overlap.
+     */
+    class GainComputer
+    {
+        private:
+            GainComputer & operator = (const GainComputer &);
+            GainComputer(const GainComputer &);
+
+        private:
+            dspu::DynamicProcessor  sProc;          // Dynamic processor for the exact curve
+            float                  *vTable;         // Gain for the unit threshold
+            float                   vTau[4];        // Reactions: release low, release high, attack low, attack high
+            float                   fEnvelope;      // Current envelope
+            float                   fThresh;        // Threshold
+            float                   fKThresh;       // Reciprocal of the threshold
+            float                   fLevel;         // Reaction level
+            float                   fRange;         // Range in decibels
+            float                   fKnee;          // Knee in decibels
+            float                   fTableRange;    // Range of the curve in the table
+            float                   fTableKnee;     // Knee of the curve in the table
+            size_t                  nSampleRate;    // Sample rate
+            gain_curve_t            enCurve;        // Evaluation of the curve
+
+        protected:
+            status_t                init_table(size_t sample_rate, float range_db, float knee_db);
+            template <size_t L>
+            static void             follow_envelopes(GainComputer * const *gc, float * const *dst,
+                                        const float * const *src, size_t count);
+            void                    lookup(float *dst, size_t count);
+
+        public:
+            explicit GainComputer();
+            ~GainComputer();
+
+            /**
+             * Initialize the gain computer and reset the envelope
+             * @param sample_rate sample rate of the envelope
+             * @param thresh threshold
+             * @param range_db range of the gain adjustment
+             * @param knee_db knee of the compressor
+             * @param curve evaluation of the compressor curve
+             * @return status of operation
+             */
+            status_t                init(size_t sample_rate, float thresh, float range_db, float knee_db,
+                                        gain_curve_t curve = GAIN_CURVE_EXACT);
+            void                    destroy();
+
+        public:
+            inline float            threshold() const   { return fThresh; }
+            inline gain_curve_t     curve() const       { return enCurve; }
+
+            /**
+             * Change the threshold, the curve table and the envelope are kept
+             * @param thresh new threshold
+             */
+            void                    set_threshold(float thresh);
+
+            /**
+             * Compute the gain for the envelope of the signal
+             * @param dst destination buffer to store the gain
+             * @param src the envelope (RMS) of the signal, may be the same to destination
+             * @param count number of samples to process
+             */
+            void                    process(float *dst, const float *src, size_t count);
+
+            /**
+             * Compute the gain of several gain computers with the same evaluation of the curve,
+             * in the table mode the envelopes are followed in lockstep
+             * @param gc list of gain computers
+             * @param dst destination buffers to store the gain, one per gain computer
+             * @param src envelopes (RMS) of signals, may be the same to destination buffers
+             * @param lanes number of gain computers
+             * @param count number of samples to process
+             */
+            static void             process(GainComputer * const *gc, float * const *dst,
+                                        const float * const *src, size_t lanes, size_t count);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_GAIN_H_ */
@@ -0,0 +1,50 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_LIVE_H_
+#define PRIVATE_LIVE_H_
+
+#include <lsp-plug.in/common/status.h>
+
+#include <private/config.h>
+#include <private/stats.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr size_t LIVE_SAMPLE_RATE        = 48000;        // Default sample rate of the live stream
+    static constexpr size_t LIVE_BLOCK_SIZE         = 256;          // Default block size of the live stream
+    static constexpr size_t LIVE_LATENCY_MAX        = 100;          // Latency bound of the live stream in milliseconds
+
+    /**
+     * Process the live stream: raw 32-bit float interleaved samples are read from the standard
+     * input and written to the standard output block by block with the bounded latency
+     *
+     * @param cfg configuration
+     * @param stats statistics to record the processing, may be NULL
+     * @return status of operation
+     */
+    status_t process_live(const config_t *cfg, Stats *stats = NULL);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_LIVE_H_ */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_PEAKS_H_
+#define PRIVATE_PEAKS_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+#include <private/audio.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr size_t PEAK_BLOCK_SIZE         = 0x1000;       // Block size for the extremum detection
+    static constexpr size_t PEAK_RAMP_MAX           = 0x10000;      // Maximum length of the gain ramp between peaks, longer ranges are split
+
+    /**
+     * Block-based detector of local extremums of the signal. Each block is processed in two
+     * steps: the branch-free loop marks the local maximums above zero and the local minimums
+     * below zero, then the marks are scanned word by word, so regions without extremums are
+     * skipped quickly. Along with the full list of extremums, the detector quantizes them:
+     * for each quantization step it keeps the largest positive and the smallest negative
+     * extremum.
+     *
+     * The sample is an extremum if it is greater than zero, not less than the previous
+     * sample and greater than the next one (or symmetrically for negative samples).
+     * The signal is assumed to be zero before the first sample and after the last sample.
+     */
+    class PeakDetector
+    {
+        private:
+            PeakDetector & operator = (const PeakDetector &);
+            PeakDetector(const PeakDetector &);
+
+        private:
+            uint8_t                *vFlags;         // Extremum flags of the block
+            peak_t                  sPos;           // Current quantized positive peak
+            peak_t                  sNeg;           // Current quantized negative peak
+            size_t                  nStep;          // Quantization step
+            size_t                  nBoundary;      // Index of the next quantization boundary
+            size_t                  nOffset;        // Number of processed samples
+            float                   fPrev;          // Previous sample
+            float                   fCurr;          // Current sample, not examined yet
+            bool                    bPending;       // The current sample is pending for examination
+
+        protected:
+            bool                    add(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+                                        size_t index, float value);
+            bool                    commit(lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg);
+            bool                    examine(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+                                        float next);
+
+        public:
+            explicit PeakDetector();
+            ~PeakDetector();
+
+            /**
+             * Initialize the detector
+             * @param step quantization step in samples
+             * @return status of operation
+             */
+            status_t                init(size_t step);
+            void                    destroy();
+
+            /**
+             * Start detection from the middle of the signal, should be called right after init()
+             * @param offset index of the next sample to process, should be aligned to the quantization step
+             * @param prev the sample that precedes the next sample
+             */
+            void                    seek(size_t offset, float prev);
+
+        public:
+            /**
+             * Process the block of data. The last sample of the block is examined
+             * when the next block is processed or when the processing is finished.
+             * @param peaks list to append all extremums, may be NULL
+             * @param pos list to append quantized positive peaks, may be NULL
+             * @param neg list to append quantized negative peaks, may be NULL
+             * @param src source buffer
+             * @param count number of samples in the buffer
+             * @return status of operation
+             */
+            status_t                process(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+                                        const float *src, size_t count);
+
+            /**
+             * Examine the last sample of the signal. The last quantization step is
+             * not committed since it is not followed by any sample.
+             * @param peaks list to append all extremums, may be NULL
+             * @param pos list to append quantized positive peaks, may be NULL
+             * @param neg list to append quantized negative peaks, may be NULL
+             * @return status of operation
+             */
+            status_t                finish(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg);
+
+            /**
+             * Examine the last sample of the segment when the signal is processed by segments.
+             * The end of the segment should be aligned to the quantization step, so the last
+             * quantization step is always committed.
+             * @param peaks list to append all extremums, may be NULL
+             * @param pos list to append quantized positive peaks, may be NULL
+             * @param neg list to append quantized negative peaks, may be NULL
+             * @param next the first sample of the next segment
+             * @return status of operation
+             */
+            status_t                finish_segment(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+                                        float next);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_PEAKS_H_ */
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_POOL_H_
+#define PRIVATE_POOL_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/ipc/Condition.h>
+#include <lsp-plug.in/ipc/Thread.h>
+#include <lsp-plug.in/lltl/parray.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    /**
+     * The task executed by the pool
+     * @param arg argument passed to the pool
+     * @param index index of the task (usually the channel number)
+     * @return status of operation
+     */
+    typedef status_t (* task_t)(void *arg, size_t index);
+
+    /**
+     * Small pool of worker threads that executes a batch of independent tasks
+     * and waits for their completion. The calling thread also takes part in the
+     * processing, so the pool with one thread executes all tasks serially.
+     *
+     * The workers are started once by the constructor, wait for the next batch
+     * between runs and are stopped by the destructor, so running the batch does
+     * not create threads. Batches are executed one at a time: the batch passed
+     * while another one is running is executed serially by the calling thread.
+     */
+    class TaskPool
+    {
+        private:
+            TaskPool & operator = (const TaskPool &);
+            TaskPool(const TaskPool &);
+
+        private:
+            typedef struct batch_t
+            {
+                task_t          pTask;          // Task to execute
+                void           *pArg;           // Argument of the task
+                size_t          nCount;         // Overall number of tasks
+                size_t          nNext;          // Next task to execute
+                size_t          nActive;        // Number of workers executing tasks of the batch
+                status_t        nResult;        // Result of execution
+            } batch_t;
+
+        private:
+            ipc::Condition      sCond;          // Condition to synchronize the batch and workers
+            lltl::parray<ipc::Thread> vWorkers; // Additional worker threads
+            batch_t            *pBatch;         // Current batch, NULL if there is no batch
+            size_t              nBatch;         // Sequence number of the current batch
+            size_t              nThreads;       // Number of threads
+            bool                bShutdown;      // Workers should stop
+
+        protected:
+            static status_t     worker_main(void *arg);
+            void                execute(batch_t *b);
+            void                shutdown();
+
+        public:
+            /**
+             * Create the pool and start the workers
+             * @param threads number of threads, zero for the number of CPU cores
+             */
+            explicit TaskPool(size_t threads = 1);
+            ~TaskPool();
+
+        public:
+            /**
+             * Get number of threads
+             * @return number of threads
+             */
+            inline size_t       threads() const     { return nThreads; }
+
+            /**
+             * Execute the batch of tasks and wait for their completion
+             * @param count number of tasks, each task gets its index in range [0, count)
+             * @param task the task to execute
+             * @param arg argument to pass to the task
+             * @return status of operation: the first error reported by the task, STATUS_OK otherwise
+             */
+            status_t            run(size_t count, task_t task, void *arg);
+    };
+
+    /**
+     * Execute the batch of tasks with the pool or serially if pool is not specified
+     * @param pool the pool, may be NULL
+     * @param count number of tasks
+     * @param task the task to execute
+     * @param arg argument to pass to the task
+     * @return status of operation
+     */
+    status_t run_tasks(TaskPool *pool, size_t count, task_t task, void *arg);
+
+    /**
+     * Estimate the number of segments each channel should be split into, so all threads
+     * of the pool are busy when there are less channels than threads
+     * @param pool the pool, may be NULL
+     * @param channels number of channels
+     * @param length length of each channel
+     * @param min_length minimum length of the segment
+     * @return number of segments per channel, at least one
+     */
+    size_t channel_segments(const TaskPool *pool, size_t channels, size_t length, size_t min_length);
+
+    /**
+     * Estimate the number of channels each task should process in lockstep, so the channels
+     * are grouped when there are more channels than threads of the pool
+     * @param pool the pool, may be NULL
+     * @param channels number of channels
+     * @param max_lanes maximum number of channels processed by the task
+     * @return number of channels per task, at least one
+     */
+    size_t channel_lanes(const TaskPool *pool, size_t channels, size_t max_lanes);
+
+    /**
+     * Get the offset of the segment of the channel
+     * @param length length of the channel
+     * @param index index of the segment, the index equal to the number of segments gives the length
+     * @param segments number of segments
+     * @param align alignment of the offset
+     * @return offset of the first sample of the segment
+     */
+    size_t segment_offset(size_t length, size_t index, size_t segments, size_t align = 1);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_POOL_H_ */
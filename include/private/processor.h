@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_PROCESSOR_H_
+#define PRIVATE_PROCESSOR_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+
+#include <private/config.h>
+#include <private/pool.h>
+#include <private/stream.h>
+#include <private/window.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr float LIVE_LEVEL_RELEASE       = 10.0f;        // Release time of the running long-time RMS level in live mode, seconds
+    static constexpr float LIVE_LEVEL_MIN           = 1e-3f;        // Minimum running long-time RMS level in live mode (-60 dB)
+
+    /**
+     * Block processor for embedding the dynamics flattening into the external pipeline.
+     * The data is passed as caller-owned non-interleaved buffers, no file I/O is performed.
+     *
+     * The processing consists of two phases:
+     *   - analysis: the signal is passed to analyze() to estimate the long-time RMS level
+     *     of each channel; the phase may be skipped if the level is set by set_level();
+     *   - processing: the signal is passed to process() and the latency tail is pulled
+     *     by flush() after the end of the signal.
+     *
+     * In live mode the analysis phase is not used: the long-time RMS level is estimated
+     * while processing as the running maximum of the long-time RMS that slowly decays,
+     * so the cost of each block depends only on its size and the lookahead is bounded
+     * by the half of the reactivity window for each pass.
+     *
+     * When there are more channels than threads, the channels are grouped and the gain
+     * adjustment stages of each group are processed in lockstep.
+     *
+     * The peak elimination and normalization require the whole processed signal and
+     * are not performed by the processor.
+     */
+    class Processor
+    {
+        private:
+            Processor & operator = (const Processor &);
+            Processor(const Processor &);
+
+        private:
+            enum state_t
+            {
+                ST_ANALYZE,         // Analysis of the long-time RMS
+                ST_PROCESS,         // Gain adjustment
+                ST_FLUSH            // Flushing the latency tail
+            };
+
+            typedef struct channel_t
+            {
+                RMSMeter                sMeter;         // Long-time RMS meter
+                GainStage              *vStages;        // Gain adjustment stages, one per pass
+                float                   fLevel;         // Long-time RMS level
+                float                  *vBuf;           // Processing buffer
+                float                  *vOut;           // Current output buffer
+                const float            *vIn;            // Current input buffer
+                size_t                  nOut;           // Number of samples written for the current block
+                bool                    bAnalyzed;      // The level is estimated by the analysis
+            } channel_t;
+
+        private:
+            TaskPool               *pPool;          // Pool of persistent threads to process channels
+            channel_t              *vChannels;      // List of channels
+            float                  *vBuffers;       // Buffers for channels
+            size_t                  nChannels;      // Number of channels
+            size_t                  nLanes;         // Number of channels processed in lockstep by each task
+            size_t                  nGroups;        // Number of groups of channels processed in lockstep
+            size_t                  nSampleRate;    // Sample rate
+            size_t                  nBlockSize;     // Block size
+            size_t                  nPasses;        // Number of passes
+            size_t                  nPeriod;        // Short-time RMS period
+            weighting_t             enWeighting;    // Weighting function
+            float                   fRange;         // Range in decibels
+            float                   fKnee;          // Knee in decibels
+            gain_curve_t            enCurve;        // Evaluation of the compressor curve
+            float                   fRelease;       // Release time of the running level in samples
+            bool                    bLive;          // Live mode
+            size_t                  nCount;         // Number of samples in the current block
+            state_t                 enState;        // Current state
+
+        protected:
+            static status_t         analyze_channel(void *arg, size_t index);
+            static status_t         process_group(void *arg, size_t index);
+            static status_t         flush_group(void *arg, size_t index);
+
+            void                    update_level(channel_t *c, size_t count);
+            status_t                start();
+
+        public:
+            explicit Processor();
+            ~Processor();
+
+            /**
+             * Initialize the processor
+             * @param cfg configuration: the gain adjustment parameters, number of threads, block size and live mode
+             * @param channels number of channels
+             * @param sample_rate sample rate of the signal
+             * @return status of operation
+             */
+            status_t                init(const config_t *cfg, size_t channels, size_t sample_rate);
+            void                    destroy();
+
+        public:
+            inline size_t           channels() const    { return nChannels; }
+            inline size_t           sample_rate() const { return nSampleRate; }
+            inline bool             live() const        { return bLive; }
+
+            /**
+             * Get the latency of the processor: number of samples the output lags behind the input
+             * @return latency in samples
+             */
+            size_t                  latency() const;
+
+            /**
+             * Reset the processor to the analysis phase to process another signal
+             * with the same configuration
+             * @return status of operation
+             */
+            status_t                reset();
+
+            /**
+             * Set the long-time RMS level of the channel instead of analysing the signal,
+             * in live mode sets the initial running level
+             * @param channel channel number
+             * @param level the long-time RMS level
+             * @return status of operation
+             */
+            status_t                set_level(size_t channel, float level);
+
+            /**
+             * Get the long-time RMS level of the channel
+             * @param channel channel number
+             * @return the long-time RMS level, estimated or set by set_level()
+             */
+            float                   level(size_t channel) const;
+
+            /**
+             * Pass the block of data to the analysis phase
+             * @param src source buffers, one per channel
+             * @param count number of samples in each buffer
+             * @return status of operation, STATUS_BAD_STATE if processing already has been started
+             *         or the processor is in live mode
+             */
+            status_t                analyze(const float * const *src, size_t count);
+
+            /**
+             * Process the block of data. The first call finishes the analysis phase. The output lags
+             * behind the input by latency() samples, so less samples may be written than passed.
+             * @param dst destination buffers, one per channel, should hold at least count samples each
+             * @param src source buffers, one per channel, may be the same as destination buffers
+             * @param count number of samples in each buffer
+             * @param written pointer to store the number of samples written to each destination buffer
+             * @return status of operation
+             */
+            status_t                process(float * const *dst, const float * const *src, size_t count, size_t *written);
+
+            /**
+             * Flush the latency tail after the end of the signal, should be called until
+             * less samples than requested are written
+             * @param dst destination buffers, one per channel, should hold at least count samples each
+             * @param count maximum number of samples to write
+             * @param written pointer to store the number of samples written to each destination buffer
+             * @return status of operation
+             */
+            status_t                flush(float * const *dst, size_t count, size_t *written);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_PROCESSOR_H_ */
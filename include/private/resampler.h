@@ -0,0 +1,139 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_RESAMPLER_H_
+#define PRIVATE_RESAMPLER_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+
+#include <private/audio.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr size_t RESAMPLER_MAX_PHASES    = 1024;         // Maximum number of phases of the polyphase filter
+    static constexpr size_t RESAMPLER_BLOCK_SIZE    = 0x1000;       // Size of the input block processed at once
+
+    /**
+     * Streaming polyphase resampler with windowed sinc filter. The sample rate
+     * ratio is reduced to L/M, the filter bank holds one set of coefficients for
+     * each of L phases. Integer-ratio decimation (L = 1) is processed with the
+     * single set of coefficients. The output is aligned with the input: the latency
+     * of the filter is compensated at the start and the tail is flushed at the end.
+     */
+    class Resampler
+    {
+        private:
+            Resampler & operator = (const Resampler &);
+            Resampler(const Resampler &);
+
+        private:
+            float                  *vCoeffs;        // Coefficients of the filter bank: nL phases of nTaps samples
+            float                  *vBuffer;        // Input history
+            size_t                  nL;             // Interpolation factor
+            size_t                  nM;             // Decimation factor
+            size_t                  nHalf;          // Half-length of the filter
+            size_t                  nTaps;          // Number of taps of the filter
+            size_t                  nCapacity;      // Capacity of the input history
+            size_t                  nFill;          // Number of samples in the input history
+            size_t                  nPos;           // Position of the next output sample in the input history
+            size_t                  nPhase;         // Phase of the next output sample
+            wsize_t                 nIn;            // Number of input samples
+            wsize_t                 nOut;           // Number of output samples
+
+        protected:
+            size_t                  produce(float *dst, size_t count);
+            void                    compact();
+            size_t                  append(const float *src, size_t count);
+
+        public:
+            explicit Resampler();
+            ~Resampler();
+
+            /**
+             * Initialize the resampler
+             * @param src_rate source sample rate
+             * @param dst_rate destination sample rate
+             * @param quality quality preset
+             * @return status of operation, STATUS_NOT_SUPPORTED if the ratio of sample rates is too complex
+             */
+            status_t                init(size_t src_rate, size_t dst_rate, resample_t quality);
+            void                    destroy();
+
+            /**
+             * Reset the state of the resampler to process another stream
+             */
+            void                    reset();
+
+        public:
+            /**
+             * Check that the sample rate ratio is supported by the resampler
+             * @param src_rate source sample rate
+             * @param dst_rate destination sample rate
+             * @return true if the ratio is supported
+             */
+            static bool             supported(size_t src_rate, size_t dst_rate);
+
+            /**
+             * Get the maximum number of output samples produced by process()
+             * @param count number of input samples
+             * @return maximum number of output samples
+             */
+            inline size_t           max_output(size_t count) const  { return (count * nL) / nM + 1; }
+
+            /**
+             * Get the number of input samples that produce not more than the specified
+             * number of output samples
+             * @param count number of output samples
+             * @return number of input samples
+             */
+            inline size_t           max_input(size_t count) const   { return lsp_max(((count - 1) * nM) / nL, size_t(1)); }
+
+            /**
+             * Get the length of the resampled stream
+             * @param length length of the input stream
+             * @return length of the output stream
+             */
+            inline wsize_t          output_length(wsize_t length) const { return (length * nL + nM - 1) / nM; }
+
+            /**
+             * Process the block of data
+             * @param dst destination buffer, should hold at least max_output(count) samples
+             * @param src source buffer
+             * @param count number of input samples
+             * @return number of output samples
+             */
+            size_t                  process(float *dst, const float *src, size_t count);
+
+            /**
+             * Flush the tail of the output stream
+             * @param dst destination buffer
+             * @param count maximum number of samples to output
+             * @return number of output samples, zero if the stream is complete
+             */
+            size_t                  flush(float *dst, size_t count);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_RESAMPLER_H_ */
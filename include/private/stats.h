@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_STATS_H_
+#define PRIVATE_STATS_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    /**
+     * Measurement of the single processing stage. The processor time and the resident memory
+     * are measured for the whole process, so in batch and sweep modes they include the jobs
+     * processed simultaneously. The peak resident memory is the high-water mark of the process
+     * at the end of the stage, the memory of the stage itself is estimated by the change of the
+     * resident memory and by the growth of the high-water mark during the stage.
+     */
+    typedef struct stage_t
+    {
+        const char         *sName;          // Name of the stage
+        ssize_t             nPass;          // Number of the pass, negative if not applicable
+        double              fWallTime;      // Wall clock time in seconds
+        double              fProcessCpuTime; // Processor time of the process in seconds
+        wsize_t             nSamples;       // Number of processed samples of all channels
+        wsize_t             nProcessPeakRss; // Peak resident memory of the process in bytes, 0 if unknown
+        wssize_t            nRssDelta;      // Change of the resident memory during the stage in bytes, 0 if unknown
+        wsize_t             nPeakRssGrowth; // Growth of the peak resident memory during the stage in bytes, 0 if unknown
+    } stage_t;
+
+    /**
+     * The state of the timers at the beginning of the stage
+     */
+    typedef struct probe_t
+    {
+        double              fWallTime;      // Wall clock time in seconds
+        double              fProcessCpuTime; // Processor time of the process in seconds
+        wsize_t             nProcessRss;    // Resident memory of the process in bytes
+        wsize_t             nProcessPeakRss; // Peak resident memory of the process in bytes
+    } probe_t;
+
+    /**
+     * Statistics of processing the single file
+     */
+    class Stats
+    {
+        private:
+            Stats & operator = (const Stats &);
+            Stats(const Stats &);
+
+        private:
+            lltl::darray<stage_t>   vStages;
+
+        public:
+            explicit Stats();
+            ~Stats();
+
+        public:
+            inline size_t           size() const            { return vStages.size(); }
+            inline const stage_t   *get(size_t index) const { return vStages.get(index); }
+
+            void                    clear();
+            void                    swap(Stats *dst);
+
+            /**
+             * Start the measurement of the stage
+             * @param p probe to store the state of timers
+             */
+            static void             start(probe_t *p);
+
+            /**
+             * Finish the measurement of the stage and record it
+             * @param p probe initialized by start()
+             * @param name name of the stage, should be a static string
+             * @param pass number of the pass, negative if not applicable
+             * @param samples number of processed samples of all channels
+             * @return status of operation
+             */
+            status_t                commit(const probe_t *p, const char *name, ssize_t pass, wsize_t samples);
+    };
+
+    /**
+     * Statistics of the processed file for the report
+     */
+    typedef struct file_stats_t
+    {
+        const LSPString    *pInFile;        // Input file
+        const LSPString    *pOutFile;       // Output file
+        status_t            nResult;        // Result of processing
+        const Stats        *pStats;         // Statistics of stages
+    } file_stats_t;
+
+    /**
+     * Write the statistics report in JSON format
+     * @param path path to the report file
+     * @param files list of files
+     * @param count number of files
+     * @return status of operation
+     */
+    status_t write_stats(const LSPString *path, const file_stats_t *files, size_t count);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_STATS_H_ */
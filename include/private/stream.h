@@ -0,0 +1,311 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_STREAM_H_
+#define PRIVATE_STREAM_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/lltl/darray.h>
+
+#include <private/audio.h>
+#include <private/config.h>
+#include <private/gain.h>
+#include <private/peaks.h>
+#include <private/pool.h>
+#include <private/stats.h>
+#include <private/window.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    /**
+     * Growable FIFO of samples
+     */
+    class SampleFifo
+    {
+        private:
+            SampleFifo & operator = (const SampleFifo &);
+            SampleFifo(const SampleFifo &);
+
+        private:
+            float                  *vData;
+            size_t                  nHead;
+            size_t                  nTail;
+            size_t                  nCapacity;
+
+        public:
+            explicit SampleFifo();
+            ~SampleFifo();
+
+            void                    destroy();
+
+        public:
+            inline size_t           size() const    { return nTail - nHead; }
+            inline float           *head()          { return &vData[nHead]; }
+            inline void             clear()         { nHead = nTail = 0; }
+
+            /**
+             * Reserve space at the tail of the FIFO
+             * @param count number of samples to reserve
+             * @return pointer to the tail of the FIFO or NULL if there is not enough memory
+             */
+            float                  *reserve(size_t count);
+
+            /**
+             * Append reserved samples to the FIFO
+             * @param count number of samples to append
+             */
+            void                    commit(size_t count);
+
+            /**
+             * Remove samples from the head of the FIFO
+             * @param count number of samples to remove
+             */
+            void                    skip(size_t count);
+
+            /**
+             * Append samples to the tail of the FIFO
+             * @param src samples to append
+             * @param count number of samples to append
+             * @return false if there is not enough memory
+             */
+            bool                    append(const float *src, size_t count);
+    };
+
+    /**
+     * Single pass of the gain adjustment of a single channel: estimates the centered short-time RMS
+     * and applies the upward compressor. The output is delayed by period/2 samples relative to the input,
+     * and the delay is compensated so the overall output matches the input sample by sample.
+     */
+    class GainStage
+    {
+        private:
+            GainStage & operator = (const GainStage &);
+            GainStage(const GainStage &);
+
+        private:
+            RMSMeter                sMeter;         // Short-time RMS meter
+            GainComputer            sGain;          // Gain computer
+            float                  *vDelay;         // Delay line of the input signal
+            float                  *vRms;           // RMS values of the block
+            float                  *vBuffer;        // Temporary buffer
+            size_t                  nDelay;         // Delay (latency) in samples
+            size_t                  nDelayHead;     // Delay line head position
+            size_t                  nSkip;          // Number of samples to skip at the beginning
+            size_t                  nTail;          // Number of samples to flush at the end
+            size_t                  nBlockSize;     // Block size
+            size_t                  nCapacity;      // Capacity of the delay line buffer
+
+        protected:
+            void                    delay(const float *src, size_t count);
+
+        public:
+            explicit GainStage();
+            ~GainStage();
+
+            status_t                init(size_t sample_rate, size_t block_size, weighting_t weight, size_t period,
+                                        float thresh, float range_db, float knee_db, gain_curve_t curve = GAIN_CURVE_EXACT);
+            void                    destroy();
+
+        public:
+            inline size_t           latency() const { return nDelay; }
+            inline size_t           tail() const    { return nTail; }
+            inline float            threshold() const { return sGain.threshold(); }
+
+            /**
+             * Update the threshold of the compressor without resetting the state of the stage
+             * @param thresh threshold
+             */
+            void                    set_threshold(float thresh);
+
+            /**
+             * Process the block of data
+             * @param dst destination buffer
+             * @param src source buffer, NULL for zero input
+             * @param count number of samples to process, should not be larger than the block size
+             * @return number of samples written to the destination buffer
+             */
+            size_t                  process(float *dst, const float *src, size_t count);
+
+            /**
+             * Flush the latency tail of the processed signal
+             * @param dst destination buffer
+             * @param count maximum number of samples to feed, should not be larger than the block size
+             * @return number of samples written to the destination buffer
+             */
+            size_t                  flush(float *dst, size_t count);
+
+            /**
+             * Process the block of data of several stages with the same configuration in lockstep
+             * @param stages list of stages
+             * @param dst destination buffers, one per stage
+             * @param src source buffers, one per stage, NULL for zero input of all stages
+             * @param lanes number of stages
+             * @param count number of samples to process, should not be larger than the block size
+             * @return number of samples written to each destination buffer
+             */
+            static size_t           process(GainStage * const *stages, float * const *dst,
+                                        const float * const *src, size_t lanes, size_t count);
+
+            /**
+             * Flush the latency tail of several stages with the same configuration in lockstep
+             * @param stages list of stages
+             * @param dst destination buffers, one per stage
+             * @param lanes number of stages
+             * @param count maximum number of samples to feed, should not be larger than the block size
+             * @return number of samples written to each destination buffer
+             */
+            static size_t           flush(GainStage * const *stages, float * const *dst, size_t lanes, size_t count);
+    };
+
+    /**
+     * Peak scanner: collects the quantized positive and negative peaks of the signal
+     * for further estimation of their median values
+     */
+    class PeakScanner
+    {
+        private:
+            PeakScanner & operator = (const PeakScanner &);
+            PeakScanner(const PeakScanner &);
+
+        private:
+            PeakDetector            sDetector;      // Detector of local extremums
+            lltl::darray<peak_t>    vPos;           // Quantized positive peaks
+            lltl::darray<peak_t>    vNeg;           // Quantized negative peaks
+
+        public:
+            explicit PeakScanner();
+            ~PeakScanner();
+
+            status_t                init(size_t sample_rate);
+            void                    destroy();
+
+        public:
+            /**
+             * Process the block of data
+             * @param src source buffer
+             * @param count number of samples in the buffer
+             * @return status of operation
+             */
+            status_t                process(const float *src, size_t count);
+
+            /**
+             * Finish the processing and estimate median values of peaks
+             * @param p_avg pointer to store median value of positive peaks
+             * @param n_avg pointer to store median value of negative peaks
+             * @return status of operation
+             */
+            status_t                finish(float *p_avg, float *n_avg);
+    };
+
+    /**
+     * Peak smasher: applies the gain reduction to the peaks that exceed the median peak values
+     * in the same manner as smash_amplitude() does
+     */
+    class PeakSmasher
+    {
+        private:
+            PeakSmasher & operator = (const PeakSmasher &);
+            PeakSmasher(const PeakSmasher &);
+
+        private:
+            PeakDetector            sDetector;      // Detector of local extremums
+            SampleFifo              sHold;          // Samples since the last peak, at most PEAK_RAMP_MAX plus the block
+            lltl::darray<peak_t>    vPeaks;         // Peaks found in the current block
+            float                   fPAvg;          // Median of positive peaks
+            float                   fNAvg;          // Median of negative peaks
+            float                   fThresh;        // Threshold
+            float                   fGain;          // Gain at the last peak
+            size_t                  nLast;          // Index of the last peak
+            size_t                  nOffset;        // Number of processed samples
+
+        protected:
+            bool                    emit(SampleFifo *dst, size_t index, float peak);
+            bool                    split(SampleFifo *dst, size_t index);
+            bool                    emit_peaks(SampleFifo *dst);
+
+        public:
+            explicit PeakSmasher();
+            ~PeakSmasher();
+
+            status_t                init(float p_avg, float n_avg, float threshold);
+            void                    destroy();
+
+        public:
+            /**
+             * Process the block of data. The output is emitted peak by peak, so the number of
+             * samples written to the destination FIFO may differ from the number of input samples.
+             * @param dst destination FIFO
+             * @param src source buffer
+             * @param count number of samples in the buffer
+             * @return status of operation
+             */
+            status_t                process(SampleFifo *dst, const float *src, size_t count);
+
+            /**
+             * Flush all pending samples to the destination FIFO
+             * @param dst destination FIFO
+             * @return status of operation
+             */
+            status_t                finish(SampleFifo *dst);
+    };
+
+    /**
+     * Apply all gain adjustment passes to the sample in a single sweep: the passes are chained
+     * block by block through GainStage instances, so each pass processes the output of the previous
+     * one while it is still in cache. The processing is performed in place and produces the same
+     * result as the sequence of estimate_rms() and adjust_gain() calls for each pass.
+     *
+     * @param sample sample to process
+     * @param passes number of passes
+     * @param weight weighting function
+     * @param period the RMS estimation frame size in samples
+     * @param thresh threshold for each channel
+     * @param range_db range of the gain adjustment
+     * @param knee_db knee of the compressor
+     * @param curve evaluation of the compressor curve
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param peaks array to store the absolute peak value of each output channel, may be NULL
+     * @param arena arena of scratch slots to keep the stages between calls, may be NULL
+     * @return status of operation
+     */
+    status_t process_passes(dspu::Sample *sample, size_t passes, weighting_t weight, size_t period,
+        const float *thresh, float range_db, float knee_db, gain_curve_t curve = GAIN_CURVE_EXACT,
+        TaskPool *pool = NULL, float *peaks = NULL, ScratchArena *arena = NULL);
+
+    /**
+     * Process the input file in streaming mode: memory consumption depends on
+     * the block size and the lookahead, not on the length of the file
+     *
+     * @param cfg configuration
+     * @param in_file input file
+     * @param out_file output file, empty if output is not required
+     * @param pool the pool to process channels in parallel, may be NULL
+     * @param stats statistics to record the sweeps, may be NULL
+     * @return status of operation
+     */
+    status_t process_stream(const config_t *cfg, const LSPString *in_file, const LSPString *out_file, TaskPool *pool, Stats *stats = NULL);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_STREAM_H_ */
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PRIVATE_SWEEP_H_
+#define PRIVATE_SWEEP_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+#include <private/config.h>
+#include <private/stats.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    /**
+     * Single variant of the parameter sweep
+     */
+    typedef struct variant_t
+    {
+        LSPString           sOutFile;       // Output file
+        dynamics_t          sDynamics;      // Dynamics parameters
+        status_t            nResult;        // Result of processing
+        Stats               sStats;         // Statistics of processing
+    } variant_t;
+
+    /**
+     * Destroy the list of variants
+     * @param list list of variants
+     */
+    void destroy_variants(lltl::parray<variant_t> *list);
+
+    /**
+     * Read the list of variants from the sweep file. Each line of the file contains the
+     * output file name and, optionally, the dynamic range, knee, number of passes, peak
+     * threshold and normalization mode separated by the tab character. Omitted or empty
+     * values are taken from the configuration.
+     *
+     * @param list list to store variants
+     * @param cfg configuration
+     * @return status of operation
+     */
+    status_t read_sweep_file(lltl::parray<variant_t> *list, const config_t *cfg);
+
+    /**
+     * Process the input file with each variant of the parameter sweep. The input file is
+     * decoded and analyzed only once, variants are processed simultaneously. Failure of
+     * processing the single variant does not abort processing of the rest variants.
+     *
+     * @param cfg configuration
+     * @return status of operation: STATUS_OK if all variants have been processed successfully
+     */
+    status_t process_sweep(const config_t *cfg);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_SWEEP_H_ */
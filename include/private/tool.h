@@ -22,8 +22,55 @@
 #ifndef PRIVATE_TOOL_H_
 #define PRIVATE_TOOL_H_
 
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+#include <private/config.h>
+#include <private/context.h>
+
 namespace spike_bender
 {
+    /**
+     * Load the audio file and estimate the long-time RMS level of each channel,
+     * use the analysis cache if it is configured
+     *
+     * @param cfg configuration
+     * @param in_file input file
+     * @param out sample to store the decoded (and resampled) signal
+     * @param levels list to store the long-time RMS level of each channel
+     * @param ctx processing context
+     * @return status of operation
+     */
+    status_t analyze_file(const config_t *cfg, const LSPString *in_file, dspu::Sample *out,
+        lltl::darray<float> *levels, Context *ctx);
+
+    /**
+     * Process the analyzed signal in place and write the output file
+     *
+     * @param cfg configuration
+     * @param dyn dynamics parameters
+     * @param out signal to process
+     * @param rms_avg long-time RMS level of each channel
+     * @param out_file output file, the result is not written if empty
+     * @param ctx processing context
+     * @return status of operation
+     */
+    status_t process_dynamics(const config_t *cfg, const dynamics_t *dyn, dspu::Sample *out,
+        const float *rms_avg, const LSPString *out_file, Context *ctx);
+
+    /**
+     * Process the single audio file according to the configuration
+     *
+     * @param cfg configuration
+     * @param in_file input file
+     * @param out_file output file
+     * @param ctx processing context
+     * @return status of operation
+     */
+    status_t process_file(const config_t *cfg, const LSPString *in_file, const LSPString *out_file, Context *ctx);
+
     int main(int argc, const char **argv);
 } /* namespace spike_bender */
 
@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_WAVMAP_H_
+#define PRIVATE_WAVMAP_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/runtime/LSPString.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr size_t WAVMAP_BLOCK_SIZE       = 0x1000;       // Number of frames converted at once
+
+    /**
+     * Memory-mapped file
+     */
+    class MappedFile
+    {
+        private:
+            MappedFile & operator = (const MappedFile &);
+            MappedFile(const MappedFile &);
+
+        private:
+            uint8_t                *pData;          // Mapped data
+            wsize_t                 nSize;          // Size of the mapped data
+            LSPString               sTemp;          // Path to the temporary file, empty if not temporary
+            LSPString               sPath;          // Path the temporary file replaces on commit
+#if defined(PLATFORM_WINDOWS)
+            void                   *hFile;          // File handle
+            void                   *hMapping;       // File mapping handle
+#else
+            int                     hFd;            // File descriptor
+#endif /* PLATFORM_WINDOWS */
+
+        public:
+            explicit MappedFile();
+            ~MappedFile();
+
+            /**
+             * Map the existing file for reading
+             * @param path path to the file
+             * @return status of operation
+             */
+            status_t                open(const LSPString *path);
+
+            /**
+             * Create the file of the specified size and map it for writing
+             * @param path path to the file
+             * @param size size of the file
+             * @return status of operation
+             */
+            status_t                create(const LSPString *path, wsize_t size);
+
+            /**
+             * Create the temporary file of the specified size with the unique name in the directory
+             * of the path and map it for writing. The file replaces the file at the path only when
+             * committed, so the readers that have mapped the previous file are not affected
+             * @param path path to the file to replace
+             * @param size size of the file
+             * @return status of operation
+             */
+            status_t                create_temp(const LSPString *path, wsize_t size);
+
+            /**
+             * Unmap and close the temporary file and move it to the path it replaces
+             * @return status of operation
+             */
+            status_t                commit();
+
+            /**
+             * Unmap and close the file, the temporary file that has not been committed is removed
+             * @return status of operation
+             */
+            status_t                close();
+
+        public:
+            inline uint8_t         *data()          { return pData; }
+            inline const uint8_t   *data() const    { return pData; }
+            inline wsize_t          size() const    { return nSize; }
+    };
+
+    /**
+     * Reader of uncompressed WAV and RF64 files that converts samples directly
+     * from the memory-mapped file into the per-channel buffers
+     */
+    class WavReader
+    {
+        private:
+            WavReader & operator = (const WavReader &);
+            WavReader(const WavReader &);
+
+        private:
+            enum encoding_t
+            {
+                ENC_U8,
+                ENC_S16,
+                ENC_S24,
+                ENC_S32,
+                ENC_F32,
+                ENC_F64
+            };
+
+        private:
+            MappedFile              sFile;          // Mapped file
+            const uint8_t          *pFrames;        // Pointer to the first frame
+            wsize_t                 nFrames;        // Number of frames
+            size_t                  nChannels;      // Number of channels
+            size_t                  nSampleRate;    // Sample rate
+            size_t                  nFrameSize;     // Size of the frame in bytes
+            size_t                  nSampleSize;    // Size of the sample in bytes
+            encoding_t              enEncoding;     // Encoding of samples
+
+        protected:
+            status_t                parse();
+
+        public:
+            explicit WavReader();
+            ~WavReader();
+
+            /**
+             * Open the file
+             * @param path path to the file
+             * @return status of operation, STATUS_UNSUPPORTED_FORMAT if the file is not
+             *   an uncompressed WAV or RF64 file
+             */
+            status_t                open(const LSPString *path);
+            status_t                close();
+
+        public:
+            inline size_t           channels() const    { return nChannels; }
+            inline size_t           sample_rate() const { return nSampleRate; }
+            inline wsize_t          length() const      { return nFrames; }
+
+            /**
+             * Convert the range of frames of the channel to floating-point samples
+             * @param dst destination buffer
+             * @param channel index of the channel
+             * @param offset index of the first frame
+             * @param count number of frames to convert
+             * @return number of converted frames
+             */
+            size_t                  read(float *dst, size_t channel, wsize_t offset, size_t count) const;
+    };
+
+    /**
+     * Writer of 32-bit floating-point WAV files (RF64 for large files) that
+     * encodes samples directly into the pre-sized memory-mapped file
+     */
+    class WavWriter
+    {
+        private:
+            WavWriter & operator = (const WavWriter &);
+            WavWriter(const WavWriter &);
+
+        private:
+            MappedFile              sFile;          // Mapped file
+            uint8_t                *pFrames;        // Pointer to the first frame
+            wsize_t                 nFrames;        // Number of frames
+            size_t                  nChannels;      // Number of channels
+
+        public:
+            explicit WavWriter();
+            ~WavWriter();
+
+            /**
+             * Create the file
+             * @param path path to the file
+             * @param channels number of channels
+             * @param sample_rate sample rate
+             * @param frames number of frames
+             * @return status of operation
+             */
+            status_t                open(const LSPString *path, size_t channels, size_t sample_rate, wsize_t frames);
+            status_t                close();
+
+        public:
+            /**
+             * Write the range of frames of the channel
+             * @param channel index of the channel
+             * @param src source buffer
+             * @param offset index of the first frame
+             * @param count number of frames to write
+             * @param gain gain applied to samples
+             * @return number of written frames
+             */
+            size_t                  write(size_t channel, const float *src, wsize_t offset, size_t count, float gain = 1.0f);
+    };
+
+    /**
+     * Check that the file can be written by WavWriter
+     * @param path path to the file
+     * @return true if the file has the WAV extension
+     */
+    bool is_wav_file(const LSPString *path);
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_WAVMAP_H_ */
@@ -0,0 +1,319 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef PRIVATE_WINDOW_H_
+#define PRIVATE_WINDOW_H_
+
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/filters/Filter.h>
+
+#include <private/audio.h>
+
+namespace spike_bender
+{
+    using namespace lsp;
+
+    static constexpr size_t WINDOW_BLOCK_SIZE       = 0x1000;       // Block size for the sliding window processing
+    static constexpr size_t WINDOW_ANCHOR_PERIODS   = 16;           // Number of windows between re-anchoring of running sums
+    static constexpr size_t WINDOW_ANCHOR_MIN       = 0x10000;      // Minimum number of samples between re-anchoring of running sums
+    static constexpr size_t SEGMENT_MIN_LENGTH      = 0x100000;     // Minimum length of the channel segment processed by a separate thread
+    static constexpr float  SEGMENT_WARMUP          = 0.5f;         // Time for the filters to settle before the start of the segment, seconds
+    static constexpr size_t LOCKSTEP_LANES          = 8;            // Maximum number of channels processed in lockstep by the single task
+
+    /**
+     * Get the number of lanes processed by the single lockstep kernel
+     * @param lanes number of remaining lanes
+     * @return four, two or one lane
+     */
+    inline size_t lockstep_width(size_t lanes)
+    {
+        return (lanes >= 4) ? 4 : (lanes >= 2) ? 2 : 1;
+    }
+
+    /**
+     * Frequency weighting filter that keeps its configuration between uses:
+     * the filter is re-configured only when the weighting function or the
+     * sample rate changes, otherwise only its state is reset
+     */
+    class WeightingFilter
+    {
+        private:
+            WeightingFilter & operator = (const WeightingFilter &);
+            WeightingFilter(const WeightingFilter &);
+
+        private:
+            dspu::Filter            sFilter;        // Weighting filter
+            weighting_t             enWeight;       // Configured weighting function
+            size_t                  nSampleRate;    // Configured sample rate
+            bool                    bConfigured;    // Filter is configured
+
+        public:
+            explicit WeightingFilter();
+            ~WeightingFilter();
+
+            /**
+             * Configure the filter and reset its state
+             * @param weight weighting function
+             * @param sample_rate sample rate
+             * @return status of operation
+             */
+            status_t                init(weighting_t weight, size_t sample_rate);
+            void                    destroy();
+
+        public:
+            /**
+             * Apply the weighting filter to the block of data
+             * @param dst destination buffer
+             * @param src source buffer, NULL for zero input, may be the same to destination
+             * @param count number of samples to process
+             */
+            void                    process(float *dst, const float *src, size_t count);
+    };
+
+    /**
+     * Sliding window over the frequency-weighted signal: applies the weighting filter
+     * to the input data block by block and keeps the last period filtered samples
+     * in the ring buffer, so the full-length filtered signal is never stored.
+     */
+    class SlidingWindow
+    {
+        private:
+            SlidingWindow & operator = (const SlidingWindow &);
+            SlidingWindow(const SlidingWindow &);
+
+        private:
+            WeightingFilter         sFilter;        // Weighting filter
+            float                  *vHistory;       // History of the filtered signal
+            size_t                  nPeriod;        // Window size
+            size_t                  nHead;          // Head of the history buffer
+
+        public:
+            explicit SlidingWindow();
+            ~SlidingWindow();
+
+            status_t                init(size_t sample_rate, weighting_t weight, size_t period);
+            void                    destroy();
+
+        public:
+            inline size_t           period() const  { return nPeriod; }
+
+            /**
+             * Apply the weighting filter to the block of data
+             * @param dst destination buffer
+             * @param src source buffer, NULL for zero input, may be the same to destination
+             * @param count number of samples to process
+             */
+            void                    filter(float *dst, const float *src, size_t count);
+
+            /**
+             * Push the filtered sample to the window
+             * @param s filtered sample
+             * @return the sample that left the window, zero if the window is not full yet
+             */
+            inline float            push(float s)
+            {
+                float o             = vHistory[nHead];
+                vHistory[nHead]     = s;
+                if ((++nHead) >= nPeriod)
+                    nHead               = 0;
+                return o;
+            }
+
+            /**
+             * Push the block of filtered samples to the window
+             * @param dst destination buffer to store samples that left the window
+             * @param src filtered samples to push
+             * @param count number of samples to push
+             */
+            void                    push(float *dst, const float *src, size_t count);
+
+            /**
+             * Compute the sum of squares of all samples in the window
+             * @return sum of squares of samples in the window
+             */
+            double                  square_sum() const;
+    };
+
+    /**
+     * Weighted sliding-window RMS meter that processes the signal block by block.
+     * Produces the same values as estimate_rms() does for the whole sample.
+     * Squaring, normalization and square root are computed by vectorized DSP
+     * functions, only the running sum remains scalar. The running sum is kept in
+     * double precision and is periodically re-anchored to the exact sum of the
+     * window contents, so the error does not accumulate on long files.
+     */
+    class RMSMeter
+    {
+        private:
+            RMSMeter & operator = (const RMSMeter &);
+            RMSMeter(const RMSMeter &);
+
+        private:
+            SlidingWindow           sWindow;        // Sliding window
+            float                  *vOld;           // Squares of samples that left the window
+            float                  *vNew;           // Squares of samples that entered the window
+            double                  fSum;           // Sum of squares
+            float                   fKPeriod;       // Normalizing factor
+            size_t                  nAnchor;        // Number of samples between re-anchoring
+            size_t                  nCounter;       // Number of samples since the last re-anchoring
+
+        public:
+            explicit RMSMeter();
+            ~RMSMeter();
+
+            status_t                init(size_t sample_rate, weighting_t weight, size_t period);
+            void                    destroy();
+
+        public:
+            inline size_t           period() const  { return sWindow.period(); }
+
+            /**
+             * Process the block of data
+             * @param dst destination buffer to store RMS values
+             * @param src source buffer, NULL for zero input, may be the same to destination
+             * @param count number of samples to process
+             */
+            void                    process(float *dst, const float *src, size_t count);
+
+            /**
+             * Process the block of data of several meters in lockstep: the filtering is performed
+             * for each meter separately, the running sums of all meters are updated by the single
+             * loop, so the recurrences of channels overlap instead of running one after another
+             * @param meters list of meters
+             * @param dst destination buffers to store RMS values, one per meter
+             * @param src source buffers, one per meter, NULL for zero input of all meters
+             * @param lanes number of meters
+             * @param count number of samples to process
+             */
+            static void             process(RMSMeter * const *meters, float * const *dst,
+                                        const float * const *src, size_t lanes, size_t count);
+    };
+
+    /**
+     * Weighted sliding-window RMS meter that produces the control signal at the reduced rate.
+     * The weighting filter is applied at the full rate, squares of the filtered samples are
+     * summed over each decimation block and the sliding window runs over block sums, so each
+     * output value is the RMS of the window that ends at the last sample of the block.
+     */
+    class ControlMeter
+    {
+        private:
+            ControlMeter & operator = (const ControlMeter &);
+            ControlMeter(const ControlMeter &);
+
+        private:
+            WeightingFilter         sFilter;        // Weighting filter
+            float                  *vHistory;       // History of block sums
+            float                  *vBuffer;        // Buffer for the filtered signal
+            double                  fSum;           // Sum of squares in the window
+            double                  fBlock;         // Sum of squares in the current block
+            float                   fKPeriod;       // Normalizing factor
+            size_t                  nPeriod;        // Window size in blocks
+            size_t                  nHead;          // Head of the history buffer
+            size_t                  nDecimation;    // Decimation factor
+            size_t                  nPhase;         // Number of samples in the current block
+            size_t                  nAnchor;        // Number of blocks between re-anchoring
+            size_t                  nCounter;       // Number of blocks since the last re-anchoring
+
+        public:
+            explicit ControlMeter();
+            ~ControlMeter();
+
+            status_t                init(size_t sample_rate, weighting_t weight, size_t period, size_t decimation);
+            void                    destroy();
+
+        public:
+            inline size_t           period() const      { return nPeriod * nDecimation; }
+            inline size_t           decimation() const  { return nDecimation; }
+
+            /**
+             * Get the maximum number of control values produced by process()
+             * @param count number of input samples
+             * @return maximum number of control values
+             */
+            inline size_t           max_output(size_t count) const { return count / nDecimation + 1; }
+
+            /**
+             * Process the block of data
+             * @param dst destination buffer to store RMS values at the control rate
+             * @param src source buffer, NULL for zero input
+             * @param count number of samples to process
+             * @return number of control values written to the destination buffer
+             */
+            size_t                  process(float *dst, const float *src, size_t count);
+    };
+
+    /**
+     * Long-time RMS level meter: tracks the maximum of the weighted sliding-window RMS.
+     * Without decimation the RMS is estimated for each sample and the maximum is the same
+     * as the maximum of the estimate_rms() output. The coarse pre-scan slides the window
+     * by decimation blocks over the block sums of squares, so the cost of the window per
+     * sample is reduced and the output is kept only for the current block.
+     */
+    class LevelMeter
+    {
+        private:
+            LevelMeter & operator = (const LevelMeter &);
+            LevelMeter(const LevelMeter &);
+
+        private:
+            RMSMeter                sMeter;         // RMS meter for the exact estimation
+            ControlMeter            sControl;       // RMS meter for the coarse pre-scan
+            float                  *vBuffer;        // RMS values of the block
+            float                   fLevel;         // Maximum RMS value
+            size_t                  nDecimation;    // Decimation factor of the pre-scan
+
+        public:
+            explicit LevelMeter();
+            ~LevelMeter();
+
+            /**
+             * Initialize the meter and reset the level
+             * @param sample_rate sample rate
+             * @param weight weighting function
+             * @param period the RMS estimation frame size in samples
+             * @param decimation decimation factor of the pre-scan, 1 for the exact estimation
+             * @return status of operation
+             */
+            status_t                init(size_t sample_rate, weighting_t weight, size_t period, size_t decimation);
+            void                    destroy();
+
+        public:
+            inline float            level() const       { return fLevel; }
+            inline size_t           period() const      { return (nDecimation > 1) ? sControl.period() : sMeter.period(); }
+
+            /**
+             * Reset the level, the state of the window is kept, so the meter can settle
+             * on the signal before the measured range
+             */
+            inline void             clear_level()       { fLevel = 0.0f; }
+
+            /**
+             * Process the block of data and update the level
+             * @param src source buffer, NULL for zero input
+             * @param count number of samples to process
+             */
+            void                    process(const float *src, size_t count);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* PRIVATE_WINDOW_H_ */
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SPIKE_BENDER_PROCESSOR_H_
+#define SPIKE_BENDER_PROCESSOR_H_
+
+#include <stddef.h>
+
+namespace spike_bender
+{
+    class Processor;
+
+    /**
+     * Status codes returned by the block processor
+     */
+    enum block_status_t
+    {
+        SB_OK               = 0,    /**< Successful completion */
+        SB_NO_MEM           = 1,    /**< Not enough memory */
+        SB_BAD_ARGUMENTS    = 2,    /**< Invalid arguments or parameters */
+        SB_BAD_STATE        = 3,    /**< The method can not be called in the current state of the processor */
+        SB_UNKNOWN_ERROR    = 4     /**< Other error */
+    };
+
+    /**
+     * Frequency weighting function of the short-time RMS estimation
+     */
+    enum block_weighting_t
+    {
+        BLOCK_WEIGHT_NONE,      /**< No frequency weighting function */
+        BLOCK_WEIGHT_A,         /**< A-weighting (IEC 61672-1:2013) */
+        BLOCK_WEIGHT_B,         /**< B-weighting (IEC 61672-1:2013) */
+        BLOCK_WEIGHT_C,         /**< C-weighting (IEC 61672-1:2013) */
+        BLOCK_WEIGHT_D,         /**< D-weighting (IEC 61672-1:2013) */
+        BLOCK_WEIGHT_K          /**< K-weighting (ITU-R BS.1770-4/2015) */
+    };
+
+    /**
+     * Evaluation of the compressor curve
+     */
+    enum block_curve_t
+    {
+        BLOCK_CURVE_EXACT,      /**< The gain is computed by the dynamic processor for each sample */
+        BLOCK_CURVE_TABLE       /**< The gain is looked up in the table, the error is within 1% */
+    };
+
+    /**
+     * Parameters of the block processor, the defaults are the same as of the tool
+     */
+    typedef struct block_params_t
+    {
+        size_t                  nPasses;        // Number of passes, 1 by default
+        float                   fReactivity;    // Reactivity of the compressor in ms, 40 ms by default
+        float                   fRange;         // Dynamic range of the compressor in dB, 6 dB by default
+        float                   fKnee;          // Knee of the compressor in dB, 3 dB by default
+        block_weighting_t       enWeighting;    // Frequency weighting function, none by default
+        block_curve_t           enCurve;        // Evaluation of the compressor curve, exact by default
+        size_t                  nBlockSize;     // Maximum number of samples processed at once, 65536 by default
+        size_t                  nThreads;       // Number of threads to process channels, 0 for the number of CPU cores, 1 by default
+        bool                    bLive;          // Live mode: the long-time RMS level is tracked while processing
+    } block_params_t;
+
+    /**
+     * Set the default parameters of the block processor
+     * @param params parameters to initialize
+     */
+    void init_block_params(block_params_t *params);
+
+    /**
+     * Public interface of the block processor for embedding the dynamics flattening into the
+     * external pipeline. The data is passed as caller-owned non-interleaved buffers, no file I/O
+     * is performed. The methods return the status code, SB_OK on success.
+     *
+     * The processing consists of two phases:
+     *   - analysis: the signal is passed to analyze() to estimate the long-time RMS level
+     *     of each channel; the phase may be skipped if the level is set by set_level();
+     *   - processing: the signal is passed to process() and the latency tail is pulled
+     *     by flush() after the end of the signal.
+     *
+     * In live mode the analysis phase is not used: the long-time RMS level is estimated
+     * while processing.
+     */
+    class BlockProcessor
+    {
+        private:
+            BlockProcessor & operator = (const BlockProcessor &);
+            BlockProcessor(const BlockProcessor &);
+
+        private:
+            Processor              *pProcessor;     // Implementation
+
+        public:
+            explicit BlockProcessor();
+            ~BlockProcessor();
+
+            /**
+             * Initialize the processor
+             * @param params parameters of the processor
+             * @param channels number of channels
+             * @param sample_rate sample rate of the signal
+             * @return SB_OK on success, SB_BAD_ARGUMENTS on invalid parameters, SB_NO_MEM if there
+             *   is not enough memory
+             */
+            block_status_t          init(const block_params_t *params, size_t channels, size_t sample_rate);
+            void                    destroy();
+
+        public:
+            size_t                  channels() const;
+            size_t                  sample_rate() const;
+            bool                    live() const;
+
+            /**
+             * Get the latency of the processor: number of samples the output lags behind the input
+             * @return latency in samples
+             */
+            size_t                  latency() const;
+
+            /**
+             * Reset the processor to the analysis phase to process another signal
+             * with the same configuration
+             * @return SB_OK on success, SB_BAD_STATE if the processor is not initialized,
+             *   SB_NO_MEM if there is not enough memory
+             */
+            block_status_t          reset();
+
+            /**
+             * Set the long-time RMS level of the channel instead of analysing the signal,
+             * in live mode sets the initial running level
+             * @param channel channel number
+             * @param level the long-time RMS level
+             * @return SB_OK on success, SB_BAD_ARGUMENTS on invalid channel number, SB_BAD_STATE if
+             *   the processor is not initialized or the analysis phase is finished
+             */
+            block_status_t          set_level(size_t channel, float level);
+
+            /**
+             * Get the long-time RMS level of the channel
+             * @param channel channel number
+             * @return the long-time RMS level, estimated or set by set_level()
+             */
+            float                   level(size_t channel) const;
+
+            /**
+             * Pass the block of data to the analysis phase
+             * @param src source buffers, one per channel
+             * @param count number of samples in each buffer
+             * @return SB_OK on success, SB_BAD_STATE if the processor is not initialized, the analysis
+             *   phase is finished or the processor is in live mode
+             */
+            block_status_t          analyze(const float * const *src, size_t count);
+
+            /**
+             * Process the block of data. The first call finishes the analysis phase. The output lags
+             * behind the input by latency() samples, so less samples may be written than passed.
+             * @param dst destination buffers, one per channel, should hold at least count samples each
+             * @param src source buffers, one per channel, may be the same as destination buffers
+             * @param count number of samples in each buffer
+             * @param written pointer to store the number of samples written to each destination buffer
+             * @return SB_OK on success, SB_BAD_STATE if the processor is not initialized or flushed,
+             *   SB_NO_MEM if there is not enough memory
+             */
+            block_status_t          process(float * const *dst, const float * const *src, size_t count, size_t *written);
+
+            /**
+             * Flush the latency tail after the end of the signal, should be called until
+             * less samples than requested are written
+             * @param dst destination buffers, one per channel, should hold at least count samples each
+             * @param count maximum number of samples to write
+             * @param written pointer to store the number of samples written to each destination buffer
+             * @return SB_OK on success, SB_BAD_STATE if the processor is not initialized,
+             *   SB_NO_MEM if there is not enough memory
+             */
+            block_status_t          flush(float * const *dst, size_t count, size_t *written);
+    };
+
+} /* namespace spike_bender */
+
+#endif /* SPIKE_BENDER_PROCESSOR_H_ */
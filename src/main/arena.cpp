@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/arena.h>
+#include <private/stream.h>
+
+namespace spike_bender
+{
+    scratch_t::scratch_t()
+    {
+    }
+
+    scratch_t::~scratch_t()
+    {
+        for (size_t i=0, n=vStages.size(); i<n; ++i)
+        {
+            GainStage *gs = vStages.uget(i);
+            if (gs != NULL)
+                delete gs;
+        }
+        vStages.flush();
+    }
+
+    void scratch_t::clear()
+    {
+        vPeaks.clear();
+        vPosPeaks.clear();
+        vNegPeaks.clear();
+        vValues.clear();
+    }
+
+    GainStage **scratch_t::stages(size_t count)
+    {
+        while (vStages.size() < count)
+        {
+            GainStage *gs = new GainStage;
+            if (gs == NULL)
+                return NULL;
+            if (!vStages.add(gs))
+            {
+                delete gs;
+                return NULL;
+            }
+        }
+
+        return vStages.array();
+    }
+
+    ScratchArena::ScratchArena()
+    {
+    }
+
+    ScratchArena::~ScratchArena()
+    {
+        destroy();
+    }
+
+    void ScratchArena::destroy()
+    {
+        for (size_t i=0, n=vSlots.size(); i<n; ++i)
+        {
+            scratch_t *s = vSlots.uget(i);
+            if (s != NULL)
+                delete s;
+        }
+        vSlots.flush();
+    }
+
+    status_t ScratchArena::reserve(size_t count)
+    {
+        while (vSlots.size() < count)
+        {
+            scratch_t *s = new scratch_t;
+            if (s == NULL)
+                return STATUS_NO_MEM;
+            if (!vSlots.add(s))
+            {
+                delete s;
+                return STATUS_NO_MEM;
+            }
+        }
+
+        return STATUS_OK;
+    }
+
+    scratch_t *ScratchArena::slot(size_t index)
+    {
+        scratch_t *s = vSlots.get(index);
+        if (s != NULL)
+            s->clear();
+        return s;
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,345 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <private/async.h>
+
+namespace spike_bender
+{
+    //-------------------------------------------------------------------------
+    // BlockQueue
+    BlockQueue::BlockQueue()
+    {
+        vData       = NULL;
+        vCount      = NULL;
+        nBlocks     = 0;
+        nBlockSize  = 0;
+        nHead       = 0;
+        nTail       = 0;
+    }
+
+    BlockQueue::~BlockQueue()
+    {
+        destroy();
+    }
+
+    status_t BlockQueue::init(size_t blocks, size_t block_size)
+    {
+        destroy();
+        if ((blocks <= 0) || (block_size <= 0))
+            return STATUS_BAD_ARGUMENTS;
+
+        vData       = new float[blocks * block_size];
+        vCount      = new size_t[blocks];
+        if ((vData == NULL) || (vCount == NULL))
+        {
+            destroy();
+            return STATUS_NO_MEM;
+        }
+
+        nBlocks     = blocks;
+        nBlockSize  = block_size;
+        atomic_store(&nHead, atomic_t(0));
+        atomic_store(&nTail, atomic_t(0));
+
+        return STATUS_OK;
+    }
+
+    void BlockQueue::destroy()
+    {
+        if (vData != NULL)
+        {
+            delete [] vData;
+            vData       = NULL;
+        }
+        if (vCount != NULL)
+        {
+            delete [] vCount;
+            vCount      = NULL;
+        }
+        nBlocks     = 0;
+        nBlockSize  = 0;
+    }
+
+    float *BlockQueue::back()
+    {
+        // The counters wrap around, so only their difference is meaningful
+        uint32_t tail   = uint32_t(atomic_load(&nTail));
+        uint32_t head   = uint32_t(atomic_load(&nHead));
+        if ((tail - head) >= nBlocks)
+            return NULL;
+
+        return &vData[(tail % nBlocks) * nBlockSize];
+    }
+
+    void BlockQueue::push(size_t count)
+    {
+        // The count is stored before the block is published
+        uint32_t tail   = uint32_t(atomic_load(&nTail));
+        vCount[tail % nBlocks]  = count;
+        atomic_add(&nTail, atomic_t(1));
+    }
+
+    const float *BlockQueue::front(size_t *count)
+    {
+        uint32_t tail   = uint32_t(atomic_load(&nTail));
+        uint32_t head   = uint32_t(atomic_load(&nHead));
+        if (tail == head)
+            return NULL;
+
+        size_t index    = head % nBlocks;
+        *count          = vCount[index];
+        return &vData[index * nBlockSize];
+    }
+
+    void BlockQueue::pop()
+    {
+        atomic_add(&nHead, atomic_t(1));
+    }
+
+    //-------------------------------------------------------------------------
+    // AsyncReader
+    AsyncReader::AsyncReader()
+    {
+        pStream     = NULL;
+        pThread     = NULL;
+        nFrames     = 0;
+        nResult     = STATUS_OK;
+        bCancel     = 0;
+    }
+
+    AsyncReader::~AsyncReader()
+    {
+        close();
+    }
+
+    status_t AsyncReader::reader_main(void *arg)
+    {
+        AsyncReader *self   = static_cast<AsyncReader *>(arg);
+        BlockQueue *q       = &self->sQueue;
+
+        while (!atomic_load(&self->bCancel))
+        {
+            // Wait for the block released by the processing
+            float *buf          = q->back();
+            if (buf == NULL)
+            {
+                ipc::Thread::sleep(ASYNC_WAIT_PERIOD);
+                continue;
+            }
+
+            // The empty block marks the end of stream, the reason is passed with the result
+            ssize_t count       = self->pStream->read(buf, self->nFrames);
+            if (count <= 0)
+            {
+                self->nResult       = (count < 0) ? status_t(-count) : STATUS_EOF;
+                q->push(0);
+                break;
+            }
+            q->push(count);
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t AsyncReader::open(mm::IInAudioStream *is, size_t frames)
+    {
+        close();
+
+        status_t res    = sQueue.init(ASYNC_QUEUE_BLOCKS, frames * is->channels());
+        if (res != STATUS_OK)
+            return res;
+
+        pStream         = is;
+        nFrames         = frames;
+        nResult         = STATUS_OK;
+        atomic_store(&bCancel, atomic_t(0));
+
+        pThread         = new ipc::Thread(reader_main, this);
+        if (pThread == NULL)
+        {
+            sQueue.destroy();
+            return STATUS_NO_MEM;
+        }
+        if ((res = pThread->start()) != STATUS_OK)
+        {
+            delete pThread;
+            pThread         = NULL;
+            sQueue.destroy();
+        }
+
+        return res;
+    }
+
+    void AsyncReader::close()
+    {
+        if (pThread != NULL)
+        {
+            atomic_store(&bCancel, atomic_t(1));
+            pThread->join();
+            delete pThread;
+            pThread         = NULL;
+        }
+        sQueue.destroy();
+        pStream         = NULL;
+    }
+
+    ssize_t AsyncReader::read(const float **frames)
+    {
+        if (pThread == NULL)
+            return -STATUS_BAD_STATE;
+
+        size_t count;
+        const float *buf;
+        while ((buf = sQueue.front(&count)) == NULL)
+            ipc::Thread::sleep(ASYNC_WAIT_PERIOD);
+
+        // The end of stream is kept in the queue, so all further reads return it too
+        if (count <= 0)
+            return -nResult;
+
+        *frames         = buf;
+        return count;
+    }
+
+    void AsyncReader::release()
+    {
+        sQueue.pop();
+    }
+
+    //-------------------------------------------------------------------------
+    // AsyncWriter
+    AsyncWriter::AsyncWriter()
+    {
+        pStream     = NULL;
+        pThread     = NULL;
+        nChannels   = 0;
+        nResult     = STATUS_OK;
+        bFailed     = 0;
+    }
+
+    AsyncWriter::~AsyncWriter()
+    {
+        close();
+    }
+
+    status_t AsyncWriter::writer_main(void *arg)
+    {
+        AsyncWriter *self   = static_cast<AsyncWriter *>(arg);
+        BlockQueue *q       = &self->sQueue;
+
+        while (true)
+        {
+            // Wait for the block submitted by the processing
+            size_t count;
+            const float *buf    = q->front(&count);
+            if (buf == NULL)
+            {
+                ipc::Thread::sleep(ASYNC_WAIT_PERIOD);
+                continue;
+            }
+            else if (count <= 0)
+                break;
+
+            for (size_t off=0; off < count; )
+            {
+                ssize_t written     = self->pStream->write(&buf[off * self->nChannels], count - off);
+                if (written <= 0)
+                {
+                    // Nothing written to the stream means the stream can not accept the data
+                    self->nResult       = (written < 0) ? status_t(-written) : STATUS_IO_ERROR;
+                    atomic_store(&self->bFailed, atomic_t(1));
+                    return STATUS_OK;
+                }
+                off                += written;
+            }
+
+            q->pop();
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t AsyncWriter::open(mm::IOutAudioStream *os, size_t frames)
+    {
+        close();
+
+        status_t res    = sQueue.init(ASYNC_QUEUE_BLOCKS, frames * os->channels());
+        if (res != STATUS_OK)
+            return res;
+
+        pStream         = os;
+        nChannels       = os->channels();
+        nResult         = STATUS_OK;
+        atomic_store(&bFailed, atomic_t(0));
+
+        pThread         = new ipc::Thread(writer_main, this);
+        if (pThread == NULL)
+        {
+            sQueue.destroy();
+            return STATUS_NO_MEM;
+        }
+        if ((res = pThread->start()) != STATUS_OK)
+        {
+            delete pThread;
+            pThread         = NULL;
+            sQueue.destroy();
+        }
+
+        return res;
+    }
+
+    status_t AsyncWriter::close()
+    {
+        if (pThread != NULL)
+        {
+            // Mark the end of data unless the thread has already stopped on failure
+            if (buffer() != NULL)
+                submit(0);
+            pThread->join();
+            delete pThread;
+            pThread         = NULL;
+        }
+        sQueue.destroy();
+        pStream         = NULL;
+
+        return nResult;
+    }
+
+    float *AsyncWriter::buffer()
+    {
+        float *buf;
+        while ((buf = sQueue.back()) == NULL)
+        {
+            if (atomic_load(&bFailed))
+                return NULL;
+            ipc::Thread::sleep(ASYNC_WAIT_PERIOD);
+        }
+
+        return (atomic_load(&bFailed)) ? NULL : buf;
+    }
+
+    void AsyncWriter::submit(size_t frames)
+    {
+        sQueue.push(frames);
+    }
+
+} /* namespace spike_bender */
@@ -24,27 +24,26 @@
 #include <lsp-plug.in/dsp-units/dynamics/DynamicProcessor.h>
 #include <lsp-plug.in/dsp-units/units.h>
 #include <lsp-plug.in/lltl/darray.h>
-#include <lsp-plug.in/lltl/parray.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
 #include <lsp-plug.in/stdlib/math.h>
 #include <lsp-plug.in/stdlib/stdio.h>
 
+#include <private/arena.h>
 #include <private/audio.h>
+#include <private/gain.h>
+#include <private/peaks.h>
+#include <private/resampler.h>
+#include <private/stats.h>
+#include <private/wavmap.h>
+#include <private/window.h>
 
 namespace spike_bender
 {
     static constexpr float PRECISION = 2.5e-8f;
 
-    typedef struct duration_t
+    void calc_duration(duration_t *d, wsize_t samples, size_t sample_rate)
     {
-        size_t h;
-        size_t m;
-        size_t s;
-        size_t ms;
-    } duration_t;
-
-    void calc_duration(duration_t *d, const dspu::Sample *sample)
-    {
-        uint64_t duration = (uint64_t(sample->samples()) * 1000) / sample->sample_rate();
+        uint64_t duration = (uint64_t(samples) * 1000) / sample_rate;
         d->ms = duration % 1000;
         duration /= 1000;
         d->s = duration % 60;
@@ -53,10 +52,143 @@ namespace spike_bender
         d->h = duration / 60;
     }
 
-    status_t load_audio_file(dspu::Sample *sample, const LSPString *name, ssize_t srate)
+    void calc_duration(duration_t *d, const dspu::Sample *sample)
+    {
+        calc_duration(d, sample->samples(), sample->sample_rate());
+    }
+
+    static status_t decode_resampled(dspu::Sample *sample, mm::IInAudioStream *is, const LSPString *name,
+        size_t srate, resample_t quality)
     {
         status_t res;
         dspu::Sample temp;
+        const size_t channels   = is->channels();
+        const wsize_t length    = is->length();
+
+        // Initialize resamplers
+        Resampler *r            = new Resampler[channels];
+        if (r == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] r; };
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            if ((res = r[i].init(is->sample_rate(), srate, quality)) != STATUS_OK)
+                return res;
+        }
+
+        // Allocate buffers
+        const size_t out_len    = r[0].output_length(length);
+        if (!temp.init(channels, out_len, out_len))
+            return STATUS_NO_MEM;
+        temp.set_sample_rate(srate);
+
+        float *frames           = new float[RESAMPLER_BLOCK_SIZE * (channels + 1)];
+        if (frames == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] frames; };
+        float *buf              = &frames[RESAMPLER_BLOCK_SIZE * channels];
+
+        // Decode and resample the file block by block. The number of output samples
+        // never exceeds output_length() of the number of input samples, so the data
+        // can be written directly to the target sample.
+        wsize_t offset          = 0;
+        size_t out_offset       = 0;
+        while (offset < length)
+        {
+            size_t to_read          = lsp_min(length - offset, wsize_t(RESAMPLER_BLOCK_SIZE));
+            ssize_t count           = is->read(frames, to_read);
+            if (count < 0)
+            {
+                if (count == -STATUS_EOF)
+                    break;
+                fprintf(stderr, "  could not read file '%s', error code: %d\n", name->get_native(), int(-count));
+                return -count;
+            }
+            else if (count == 0)
+                break;
+
+            size_t produced         = 0;
+            for (size_t i=0; i<channels; ++i)
+            {
+                const float *src        = &frames[i];
+                for (ssize_t j=0; j<count; ++j, src += channels)
+                    buf[j]                  = *src;
+                produced                = r[i].process(temp.channel(i, out_offset), buf, count);
+            }
+
+            offset                 += count;
+            out_offset             += produced;
+        }
+
+        // Flush the tail of resamplers
+        for (size_t i=0; i<channels; ++i)
+        {
+            size_t tail             = out_offset;
+            for (size_t n; (n = r[i].flush(temp.channel(i, tail), out_len - tail)) > 0; )
+                tail                   += n;
+        }
+
+        // The file may appear shorter than declared
+        if (offset < length)
+        {
+            size_t n                = r[0].output_length(offset);
+            temp.set_length(n);
+        }
+
+        temp.swap(sample);
+
+        return STATUS_OK;
+    }
+
+    static status_t decode_mapped(dspu::Sample *sample, const WavReader *rd)
+    {
+        dspu::Sample temp;
+        const size_t channels   = rd->channels();
+        const size_t length     = rd->length();
+
+        if (!temp.init(channels, length, length))
+            return STATUS_NO_MEM;
+        temp.set_sample_rate(rd->sample_rate());
+
+        // Convert block by block, so the mapped frames stay in cache for all channels
+        for (size_t off=0; off<length; off += WAVMAP_BLOCK_SIZE)
+        {
+            size_t n                = lsp_min(length - off, WAVMAP_BLOCK_SIZE);
+            for (size_t i=0; i<channels; ++i)
+                rd->read(temp.channel(i, off), i, off, n);
+        }
+
+        temp.swap(sample);
+
+        return STATUS_OK;
+    }
+
+    static status_t encode_mapped(const dspu::Sample *sample, const LSPString *name, float gain)
+    {
+        status_t res;
+        WavWriter wr;
+        const size_t channels   = sample->channels();
+        const size_t length     = sample->length();
+
+        if ((res = wr.open(name, channels, sample->sample_rate(), length)) != STATUS_OK)
+            return res;
+
+        for (size_t off=0; off<length; off += WAVMAP_BLOCK_SIZE)
+        {
+            size_t n                = lsp_min(length - off, WAVMAP_BLOCK_SIZE);
+            for (size_t i=0; i<channels; ++i)
+                wr.write(i, &sample->channel(i)[off], off, n, gain);
+        }
+
+        return wr.close();
+    }
+
+    status_t load_audio_file(dspu::Sample *sample, const LSPString *name, ssize_t srate, resample_t quality, Stats *stats)
+    {
+        status_t res;
+        dspu::Sample temp;
+        probe_t p;
 
         // Check arguments
         if (name == NULL)
@@ -70,12 +202,79 @@ namespace spike_bender
             return STATUS_BAD_ARGUMENTS;
         }
 
+        // Convert uncompressed WAV file directly from the memory-mapped file if resampling is not required
+        {
+            WavReader rd;
+
+            Stats::start(&p);
+            if ((rd.open(name) == STATUS_OK) && ((srate <= 0) || (size_t(srate) == rd.sample_rate())))
+            {
+                duration_t d;
+                calc_duration(&d, rd.length(), rd.sample_rate());
+                fprintf(stdout, "  loaded file: '%s', channels: %d, samples: %d, sample rate: %d, duration: %02d:%02d:%02d.%03d\n",
+                    name->get_native(),
+                    int(rd.channels()), int(rd.length()), int(rd.sample_rate()),
+                    int(d.h), int(d.m), int(d.s), int(d.ms));
+
+                if ((res = decode_mapped(&temp, &rd)) != STATUS_OK)
+                {
+                    fprintf(stderr, "  could not read file '%s', error code: %d\n", name->get_native(), int(res));
+                    return res;
+                }
+                if ((stats != NULL) && ((res = stats->commit(&p, "decode", -1, temp.length() * temp.channels())) != STATUS_OK))
+                    return res;
+
+                temp.swap(sample);
+                return STATUS_OK;
+            }
+        }
+
+        // Decode the file and resample it on the fly if the sample rate ratio is supported
+        if (srate > 0)
+        {
+            mm::InAudioFileStream is;
+
+            Stats::start(&p);
+            if ((res = is.open(name)) != STATUS_OK)
+            {
+                fprintf(stderr, "  could not read file '%s', error code: %d\n", name->get_native(), int(res));
+                return res;
+            }
+            lsp_finally { is.close(); };
+
+            if ((size_t(srate) != is.sample_rate()) && (is.length() > 0) &&
+                (Resampler::supported(is.sample_rate(), srate)))
+            {
+                duration_t d;
+                calc_duration(&d, is.length(), is.sample_rate());
+                fprintf(stdout, "  loaded file: '%s', channels: %d, samples: %d, sample rate: %d, duration: %02d:%02d:%02d.%03d\n",
+                    name->get_native(),
+                    int(is.channels()), int(is.length()), int(is.sample_rate()),
+                    int(d.h), int(d.m), int(d.s), int(d.ms));
+
+                if ((res = decode_resampled(&temp, &is, name, srate, quality)) != STATUS_OK)
+                {
+                    fprintf(stderr, "  could not resample file '%s' to sample rate %d, error code: %d\n",
+                        name->get_native(), int(srate), int(res));
+                    return res;
+                }
+                if ((stats != NULL) && ((res = stats->commit(&p, "decode_resample", -1, temp.length() * temp.channels())) != STATUS_OK))
+                    return res;
+
+                temp.swap(sample);
+                return STATUS_OK;
+            }
+        }
+
         // Load sample from file
+        Stats::start(&p);
         if ((res = temp.load(name)) != STATUS_OK)
         {
             fprintf(stderr, "  could not read file '%s', error code: %d\n", name->get_native(), int(res));
             return res;
         }
+        if ((stats != NULL) && ((res = stats->commit(&p, "decode", -1, temp.length() * temp.channels())) != STATUS_OK))
+            return res;
 
         duration_t d;
         calc_duration(&d, &temp);
@@ -87,12 +286,15 @@ namespace spike_bender
         // Resample audio data
         if (srate > 0)
         {
+            Stats::start(&p);
             if ((res = temp.resample(srate)) != STATUS_OK)
             {
                 fprintf(stderr, "  could not resample file '%s' to sample rate %d, error code: %d\n",
                     name->get_native(), int(srate), int(res));
                 return res;
             }
+            if ((stats != NULL) && ((res = stats->commit(&p, "resample", -1, temp.length() * temp.channels())) != STATUS_OK))
+                return res;
         }
 
         // Return result
@@ -101,7 +303,7 @@ namespace spike_bender
         return STATUS_OK;
     }
 
-    status_t save_audio_file(const dspu::Sample *sample, const LSPString *name)
+    status_t save_audio_file(const dspu::Sample *sample, const LSPString *name, float gain)
     {
         status_t res;
 
@@ -117,11 +319,30 @@ namespace spike_bender
             return STATUS_BAD_ARGUMENTS;
         }
 
-        // Load sample from file
-        if ((res = sample->save(name)) < 0)
+        // Encode uncompressed WAV file directly to the memory-mapped file, fall back to the generic encoder
+        if ((!is_wav_file(name)) || (encode_mapped(sample, name, gain) != STATUS_OK))
         {
-            fprintf(stderr, "  could not write file '%s', error code: %d\n", name->get_native(), int(-res));
-            return -res;
+            // The generic encoder does not apply the gain, so it is applied to the copy of the sample
+            dspu::Sample scaled;
+            const dspu::Sample *out = sample;
+            if (gain != 1.0f)
+            {
+                if ((res = scaled.copy(sample)) != STATUS_OK)
+                {
+                    fprintf(stderr, "  not enough memory\n");
+                    return STATUS_NO_MEM;
+                }
+                for (size_t i=0, n=scaled.channels(); i<n; ++i)
+                    dsp::mul_k2(scaled.channel(i), gain, scaled.length());
+                scaled.set_sample_rate(sample->sample_rate());
+                out             = &scaled;
+            }
+
+            if ((res = out->save(name)) < 0)
+            {
+                fprintf(stderr, "  could not write file '%s', error code: %d\n", name->get_native(), int(-res));
+                return -res;
+            }
         }
 
         duration_t d;
@@ -134,13 +355,9 @@ namespace spike_bender
         return STATUS_OK;
     }
 
-    status_t apply_weight(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight)
+    status_t init_weighting(dspu::Filter *f, weighting_t weight, size_t sample_rate)
     {
-        status_t res;
-        dspu::Filter f;
-
-        // Initialize weighting filter
-        if (!f.init(NULL))
+        if (!f->init(NULL))
         {
             fprintf(stderr, "  error initializing filter\n");
             return STATUS_NO_MEM;
@@ -175,7 +392,144 @@ namespace spike_bender
         fp.fQuality     = 0.0f;
         fp.nSlope       = 1.0f;
 
-        f.update(src->sample_rate(), &fp);
+        f->update(sample_rate, &fp);
+        f->clear();
+
+        return STATUS_OK;
+    }
+
+    void configure_dynamics(dspu::DynamicProcessor *dp, size_t sample_rate, float thresh, float range_db, float knee_db)
+    {
+        dp->set_sample_rate(sample_rate);
+
+        dspu::dyndot_t dot;
+        dot.fOutput = thresh;
+        dot.fKnee   = dspu::db_to_gain(-fabs(knee_db));
+
+        dot.fInput  = thresh * dspu::db_to_gain(range_db - 3.0f);
+        dp->set_dot(0, &dot);
+
+//        lsp_trace("dot[0] x=%f, y=%f", dspu::gain_to_db(dot.fInput), dspu::gain_to_db(dot.fOutput));
+
+        dot.fInput  = thresh * dspu::db_to_gain(-range_db - 3.0f);
+        dp->set_dot(1, &dot);
+
+//        lsp_trace("dot[1] x=%f, y=%f", dspu::gain_to_db(dot.fInput), dspu::gain_to_db(dot.fOutput));
+
+        dot.fInput  = -1.0f;
+        dp->set_dot(2, &dot);
+        dp->set_dot(3, &dot);
+
+        dp->set_attack_time(0, 0.0f);
+        dp->set_attack_level(0, thresh * dspu::db_to_gain(GAIN_REACTION_LEVEL));
+
+//        lsp_trace("attack[0] = %f", dspu::gain_to_db(dp->get_attack_level(0)));
+        dp->set_attack_time(1, GAIN_ATTACK_TIME);
+        dp->set_attack_level(1, -1.0f);
+        dp->set_attack_level(2, -1.0f);
+        dp->set_attack_level(3, -1.0f);
+
+        dp->set_release_time(0, GAIN_RELEASE_LOW_TIME);
+        dp->set_release_level(0, thresh * dspu::db_to_gain(GAIN_REACTION_LEVEL));
+//        lsp_trace("release[0] = %f", dspu::gain_to_db(dp->get_release_level(0)));
+        dp->set_release_time(1, GAIN_RELEASE_TIME);
+        dp->set_release_level(1, -1.0f);
+        dp->set_release_level(2, -1.0f);
+        dp->set_release_level(3, -1.0f);
+
+        dp->set_in_ratio(1.0f);
+        dp->set_out_ratio(1.0f);
+
+        dp->update_settings();
+    }
+
+    /**
+     * Get the next block of the input signal padded with zeros
+     * @param count pointer to store the block size
+     * @param src source buffer
+     * @param offset offset of the block
+     * @param slength length of the source buffer
+     * @param dlength length of the padded signal
+     * @return pointer to the source data or NULL for the zero padding
+     */
+    static inline const float *window_block(size_t *count, const float *src, size_t offset, size_t slength, size_t dlength)
+    {
+        size_t n        = lsp_min(dlength - offset, WINDOW_BLOCK_SIZE);
+        if (offset >= slength)
+        {
+            *count          = n;
+            return NULL;
+        }
+
+        *count          = lsp_min(n, slength - offset);
+        return &src[offset];
+    }
+
+    static status_t use_arena(ScratchArena **arena, ScratchArena *tmp, size_t slots)
+    {
+        // Use the temporary arena if the arena is not provided
+        if (*arena == NULL)
+            *arena          = tmp;
+        return (*arena)->reserve(slots);
+    }
+
+    typedef struct weight_task_t
+    {
+        dspu::Sample       *dst;
+        const dspu::Sample *src;
+        weighting_t         weight;
+        size_t              segments;
+        size_t              warmup;
+        ScratchArena       *arena;
+    } weight_task_t;
+
+    static status_t apply_weight_segment(void *arg, size_t index)
+    {
+        status_t res;
+        weight_task_t *t    = static_cast<weight_task_t *>(arg);
+        size_t i            = index / t->segments;
+        size_t s            = index % t->segments;
+        scratch_t *sc       = t->arena->slot(index);
+        WeightingFilter *f  = &sc->sFilter;
+
+        // Initialize weighting filter
+        if ((res = f->init(t->weight, t->src->sample_rate())) != STATUS_OK)
+            return res;
+
+        size_t length       = t->dst->length();
+        size_t first        = segment_offset(length, s, t->segments);
+        size_t last         = segment_offset(length, s + 1, t->segments);
+
+        // Let the filter settle on the source signal before the segment, the output is discarded
+        const float *sbuf   = t->src->channel(i);
+        size_t off          = first - lsp_min(first, t->warmup);
+        if (off < first)
+        {
+            sc->vValues.clear();
+            float *buf          = sc->vValues.append_n(WINDOW_BLOCK_SIZE);
+            if (buf == NULL)
+                return STATUS_NO_MEM;
+            for (size_t n; off<first; off += n)
+            {
+                n                   = lsp_min(first - off, WINDOW_BLOCK_SIZE);
+                f->process(buf, &sbuf[off], n);
+            }
+        }
+
+        // Apply filter to the input buffer
+        float *dbuf = t->dst->channel(i, first);
+        f->process(dbuf, dbuf, last - first);
+
+        return STATUS_OK;
+    }
+
+    status_t apply_weight(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, TaskPool *pool, ScratchArena *arena)
+    {
+        status_t res;
+        ScratchArena tmp;
+        size_t segments = channel_segments(pool, src->channels(), src->length(), SEGMENT_MIN_LENGTH);
+        if ((res = use_arena(&arena, &tmp, src->channels() * segments)) != STATUS_OK)
+            return res;
 
         // Process input data with the weighting filter and compute RMS
         dspu::Sample out;
@@ -185,14 +539,15 @@ namespace spike_bender
             return STATUS_NO_MEM;
         }
 
-        for (size_t i=0, n=out.channels(); i<n; ++i)
-        {
-            float *dbuf = out.channel(i);
-
-            // Apply filter to the input buffer
-            f.clear();
-            f.process(dbuf, dbuf, out.length());
-        }
+        weight_task_t t;
+        t.dst       = &out;
+        t.src       = src;
+        t.weight    = weight;
+        t.segments  = segments;
+        t.warmup    = size_t(SEGMENT_WARMUP * src->sample_rate());
+        t.arena     = arena;
+        if ((res = run_tasks(pool, out.channels() * segments, apply_weight_segment, &t)) != STATUS_OK)
+            return res;
 
         // Return the value
         out.set_sample_rate(src->sample_rate());
@@ -201,91 +556,144 @@ namespace spike_bender
         return STATUS_OK;
     }
 
-    status_t estimate_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period)
+    typedef struct rms_task_t
     {
-        dspu::Filter f;
+        dspu::Sample       *dst;
+        ControlBuffer      *ctl;
+        float              *peaks;
+        const dspu::Sample *src;
+        weighting_t         weight;
+        size_t              period;
+        size_t              decimation;
+        size_t              segments;
+        size_t              warmup;
+        ScratchArena       *arena;
+    } rms_task_t;
+
+    static status_t estimate_control_rms_channel(void *arg, size_t i)
+    {
+        status_t res;
+        rms_task_t *t       = static_cast<rms_task_t *>(arg);
+        scratch_t *sc       = t->arena->slot(i);
+        ControlMeter *m     = &sc->sControl;
 
-        // Initialize weighting filter
-        if (!f.init(NULL))
-        {
-            fprintf(stderr, "  error initializing filter\n");
+        // Initialize the meter
+        if ((res = m->init(t->src->sample_rate(), t->weight, t->period, t->decimation)) != STATUS_OK)
+            return res;
+
+        // The meter emits at most one value per input sample
+        sc->vValues.clear();
+        float *buf          = sc->vValues.append_n(WINDOW_BLOCK_SIZE);
+        if (buf == NULL)
             return STATUS_NO_MEM;
-        }
 
-        dspu::filter_params_t fp;
-        switch (weight)
+        size_t slength      = t->src->length();
+        size_t dlength      = slength + t->period;
+        size_t clength      = t->ctl->length();
+        const float *sbuf   = t->src->channel(i);
+
+        // Filter the input buffer and compute the RMS value at the control rate,
+        // the values are converted to the storage format while they are in the cache
+        size_t k            = 0;
+        float last          = 0.0f;
+        for (size_t off=0, n; off<dlength; off += n)
         {
-            case A_WEIGHT:
-                fp.nType        = dspu::FLT_A_WEIGHTED;
-                break;
-            case B_WEIGHT:
-                fp.nType        = dspu::FLT_B_WEIGHTED;
-                break;
-            case C_WEIGHT:
-                fp.nType        = dspu::FLT_C_WEIGHTED;
-                break;
-            case D_WEIGHT:
-                fp.nType        = dspu::FLT_D_WEIGHTED;
-                break;
-            case K_WEIGHT:
-                fp.nType        = dspu::FLT_K_WEIGHTED;
-                break;
-            default:
-                fp.nType        = dspu::FLT_NONE;
-                break;
+            const float *sp     = window_block(&n, sbuf, off, slength, dlength);
+            size_t count        = m->process(buf, sp, n);
+            if (count <= 0)
+                continue;
+
+            t->ctl->store(i, k, buf, count);
+            last                = buf[count - 1];
+            k                  += count;
         }
 
-        fp.fFreq        = 1.0f;
-        fp.fFreq2       = 1.0f;
-        fp.fGain        = 1.0f;
-        fp.fQuality     = 0.0f;
-        fp.nSlope       = 1.0f;
+        // The last incomplete block is not emitted by the meter
+        if (k < clength)
+            t->ctl->fill(i, k, last, clength - k);
 
-        f.update(src->sample_rate(), &fp);
+        return STATUS_OK;
+    }
 
-        // Process input data with the weighting filter and compute RMS
-        dspu::Sample tmp, out;
-        size_t slength  = src->length();
-        size_t dlength  = slength + period;
-        if (!tmp.init(src->channels(), dlength, dlength))
+    static status_t estimate_rms_segment(void *arg, size_t index)
+    {
+        status_t res;
+        rms_task_t *t       = static_cast<rms_task_t *>(arg);
+        size_t i            = index / t->segments;
+        size_t s            = index % t->segments;
+        scratch_t *sc       = t->arena->slot(index);
+        RMSMeter *m         = &sc->sMeter;
+
+        // Initialize the meter
+        if ((res = m->init(t->src->sample_rate(), t->weight, t->period)) != STATUS_OK)
+            return res;
+
+        size_t slength      = t->src->length();
+        size_t dlength      = slength + t->period;
+        size_t first        = segment_offset(dlength, s, t->segments);
+        size_t last         = segment_offset(dlength, s + 1, t->segments);
+        const float *sbuf   = t->src->channel(i);
+        float *dbuf         = t->dst->channel(i);
+
+        // Let the meter settle on the signal before the segment, the output is discarded
+        size_t off          = first - lsp_min(first, t->warmup);
+        if (off < first)
         {
-            fprintf(stderr, "  not enough memory\n");
-            return STATUS_NO_MEM;
+            sc->vValues.clear();
+            float *buf          = sc->vValues.append_n(WINDOW_BLOCK_SIZE);
+            if (buf == NULL)
+                return STATUS_NO_MEM;
+            for (size_t n; off<first; off += n)
+            {
+                const float *sp     = window_block(&n, sbuf, off, slength, first);
+                m->process(buf, sp, n);
+            }
         }
-        if (!out.init(src->channels(), dlength, dlength))
+
+        // Filter the input buffer and compute the RMS value block by block
+        for (size_t n; off<last; off += n)
         {
-            fprintf(stderr, "  not enough memory\n");
-            return STATUS_NO_MEM;
+            const float *sp     = window_block(&n, sbuf, off, slength, last);
+            m->process(&dbuf[off], sp, n);
         }
 
-        float kperiod = 1.0f / period;
+        return STATUS_OK;
+    }
 
-        for (size_t i=0, n=src->channels(); i<n; ++i)
-        {
-            const float *sbuf = src->channel(i);
-            float *dbuf = tmp.channel(i);
+    status_t estimate_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period,
+        TaskPool *pool, ScratchArena *arena)
+    {
+        status_t res;
+        ScratchArena tmp;
 
-            // Apply filter to the input buffer
-            f.clear();
-            f.process(dbuf, sbuf, slength);
-            dsp::fill_zero(&dbuf[slength], period);
-            f.process(&dbuf[slength], &dbuf[slength], period);
+        size_t slength  = src->length();
+        size_t segments = channel_segments(pool, src->channels(), slength + period, SEGMENT_MIN_LENGTH);
+        if ((res = use_arena(&arena, &tmp, src->channels() * segments)) != STATUS_OK)
+            return res;
 
-            // Compute the RMS value among the buffer
-            float rms   = 0.0f;
-            sbuf        = dbuf;
-            dbuf        = out.channel(i);
-            for (size_t j=0; j<dlength; ++j)
-            {
-                // Subtract the old value
-                ssize_t off = j - period;
-                if (off >= 0)
-                    rms    -= sbuf[off] * sbuf[off];
-                rms    += sbuf[j] * sbuf[j];
-                dbuf[j]     = sqrtf(lsp_max(rms, 0.0f) * kperiod);
-            }
+        // Process input data with the weighting filter and compute RMS
+        dspu::Sample out;
+        size_t dlength  = slength + period;
+        if (!out.init(src->channels(), dlength, dlength))
+        {
+            fprintf(stderr, "  not enough memory\n");
+            return STATUS_NO_MEM;
         }
 
+        rms_task_t t;
+        t.dst       = &out;
+        t.ctl       = NULL;
+        t.peaks     = NULL;
+        t.src       = src;
+        t.weight    = weight;
+        t.period    = period;
+        t.decimation= 1;
+        t.segments  = segments;
+        t.warmup    = period + size_t(SEGMENT_WARMUP * src->sample_rate());
+        t.arena     = arena;
+        if ((res = run_tasks(pool, src->channels() * segments, estimate_rms_segment, &t)) != STATUS_OK)
+            return res;
+
         // Return the value
         out.set_sample_rate(src->sample_rate());
         out.swap(dst);
@@ -293,57 +701,147 @@ namespace spike_bender
         return STATUS_OK;
     }
 
-    status_t estimate_rms_balance(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period)
+    static status_t estimate_rms_peak_segment(void *arg, size_t index)
     {
-        dspu::Filter f;
+        status_t res;
+        rms_task_t *t       = static_cast<rms_task_t *>(arg);
+        size_t i            = index / t->segments;
+        size_t s            = index % t->segments;
+        scratch_t *sc       = t->arena->slot(index);
+        LevelMeter *m       = &sc->sLevel;
+
+        // Initialize the meter
+        if ((res = m->init(t->src->sample_rate(), t->weight, t->period, t->decimation)) != STATUS_OK)
+            return res;
 
-        // Initialize weighting filter
-        if (!f.init(NULL))
+        // Segments and the warm-up are aligned to decimation blocks, so the window
+        // slides over the same blocks as if the channel was not split
+        size_t slength      = t->src->length();
+        size_t dlength      = slength + t->period;
+        size_t first        = segment_offset(dlength, s, t->segments, t->decimation);
+        size_t last         = segment_offset(dlength, s + 1, t->segments, t->decimation);
+        size_t off          = first - lsp_min(first, t->warmup);
+        off                -= off % t->decimation;
+        const float *sbuf   = t->src->channel(i);
+
+        // Let the meter settle on the signal before the segment
+        for (size_t n; off<first; off += n)
         {
-            fprintf(stderr, "  error initializing filter\n");
-            return STATUS_NO_MEM;
+            const float *sp     = window_block(&n, sbuf, off, slength, first);
+            m->process(sp, n);
         }
+        m->clear_level();
 
-        dspu::filter_params_t fp;
-        switch (weight)
+        // Filter the input buffer and track the maximum RMS value block by block
+        for (size_t n; off<last; off += n)
         {
-            case A_WEIGHT:
-                fp.nType        = dspu::FLT_A_WEIGHTED;
-                break;
-            case B_WEIGHT:
-                fp.nType        = dspu::FLT_B_WEIGHTED;
-                break;
-            case C_WEIGHT:
-                fp.nType        = dspu::FLT_C_WEIGHTED;
-                break;
-            case D_WEIGHT:
-                fp.nType        = dspu::FLT_D_WEIGHTED;
-                break;
-            case K_WEIGHT:
-                fp.nType        = dspu::FLT_K_WEIGHTED;
-                break;
-            default:
-                fp.nType        = dspu::FLT_NONE;
-                break;
+            const float *sp     = window_block(&n, sbuf, off, slength, last);
+            m->process(sp, n);
+        }
+        t->peaks[index]     = m->level();
+
+        return STATUS_OK;
+    }
+
+    status_t estimate_rms_peak(float *dst, const dspu::Sample *src, weighting_t weight, size_t period,
+        size_t decimation, TaskPool *pool, ScratchArena *arena)
+    {
+        status_t res;
+        ScratchArena tmp;
+
+        size_t channels = src->channels();
+        size_t slength  = src->length();
+        size_t segments = channel_segments(pool, channels, slength + period, SEGMENT_MIN_LENGTH);
+        if ((res = use_arena(&arena, &tmp, channels * segments)) != STATUS_OK)
+            return res;
+
+        // Only the maximum of each segment is stored
+        float *peaks    = new float[channels * segments];
+        if (peaks == NULL)
+        {
+            fprintf(stderr, "  not enough memory\n");
+            return STATUS_NO_MEM;
         }
+        lsp_finally { delete [] peaks; };
+
+        rms_task_t t;
+        t.dst       = NULL;
+        t.ctl       = NULL;
+        t.peaks     = peaks;
+        t.src       = src;
+        t.weight    = weight;
+        t.period    = period;
+        t.decimation= lsp_max(decimation, size_t(1));
+        t.segments  = segments;
+        t.warmup    = period + size_t(SEGMENT_WARMUP * src->sample_rate());
+        t.arena     = arena;
+        if ((res = run_tasks(pool, channels * segments, estimate_rms_peak_segment, &t)) != STATUS_OK)
+            return res;
 
-        fp.fFreq        = 1.0f;
-        fp.fFreq2       = 1.0f;
-        fp.fGain        = 1.0f;
-        fp.fQuality     = 0.0f;
-        fp.nSlope       = 1.0f;
+        for (size_t i=0; i<channels; ++i)
+        {
+            const float *p  = &peaks[i * segments];
+            dst[i]          = 0.0f;
+            for (size_t s=0; s<segments; ++s)
+                dst[i]          = lsp_max(dst[i], p[s]);
+        }
 
-        f.update(src->sample_rate(), &fp);
+        return STATUS_OK;
+    }
 
-        // Process input data with the weighting filter and compute RMS
-        dspu::Sample tmp, out;
-        size_t slength  = src->length();
-        size_t dlength  = slength + period;
-        if (!tmp.init(src->channels(), dlength, dlength))
+    status_t estimate_control_rms(ControlBuffer *dst, const dspu::Sample *src, weighting_t weight, size_t period,
+        size_t decimation, control_format_t format, TaskPool *pool, ScratchArena *arena)
+    {
+        status_t res;
+        ScratchArena tmp;
+
+        // The control meter emits values at the reduced rate, so channels are not split into segments
+        decimation      = lsp_max(decimation, size_t(1));
+        if ((res = use_arena(&arena, &tmp, src->channels())) != STATUS_OK)
+            return res;
+
+        // Process input data with the weighting filter and compute RMS at the control rate
+        ControlBuffer out;
+        size_t clength  = (src->length() + period + decimation - 1) / decimation;
+        if ((res = out.init(src->channels(), clength, format)) != STATUS_OK)
         {
             fprintf(stderr, "  not enough memory\n");
-            return STATUS_NO_MEM;
+            return res;
         }
+
+        rms_task_t t;
+        t.dst       = NULL;
+        t.ctl       = &out;
+        t.peaks     = NULL;
+        t.src       = src;
+        t.weight    = weight;
+        t.period    = period;
+        t.decimation= decimation;
+        t.segments  = 1;
+        t.warmup    = 0;
+        t.arena     = arena;
+        if ((res = run_tasks(pool, src->channels(), estimate_control_rms_channel, &t)) != STATUS_OK)
+            return res;
+
+        // Return the value
+        out.set_sample_rate(src->sample_rate());
+        out.swap(dst);
+
+        return STATUS_OK;
+    }
+
+    status_t estimate_rms_balance(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, ScratchArena *arena)
+    {
+        status_t res;
+        ScratchArena tmp;
+        if ((res = use_arena(&arena, &tmp, 1)) != STATUS_OK)
+            return res;
+        SlidingWindow &w    = arena->slot(0)->sWindow;
+
+        // Process input data with the weighting filter and compute RMS
+        dspu::Sample out;
+        size_t slength  = src->length();
+        size_t dlength  = slength + period;
         if (!out.init(src->channels() * 5, dlength, dlength))
         {
             fprintf(stderr, "  not enough memory\n");
@@ -355,48 +853,53 @@ namespace spike_bender
 
         for (size_t i=0, n=src->channels(); i<n; ++i)
         {
-            const float *sbuf = src->channel(i);
-            float *dbuf = tmp.channel(i);
-
-            // Apply filter to the input buffer
-            f.clear();
-            f.process(dbuf, sbuf, slength);
-            dsp::fill_zero(&dbuf[slength], period);
-            f.process(&dbuf[slength], &dbuf[slength], period);
+            // Initialize the window
+            if ((res = w.init(src->sample_rate(), weight, period)) != STATUS_OK)
+                return res;
 
             // Compute the RMS value among the buffer
-            float prms      = 0.0f;
-            float nrms      = 0.0f;
-            sbuf            = dbuf;
+            const float *sbuf = src->channel(i);
+            double prms     = 0.0;
+            double nrms     = 0.0;
             float *out_prms = out.channel(channel_id++);
             float *out_nrms = out.channel(channel_id++);
             float *out_ravg = out.channel(channel_id++);
             float *out_pgain= out.channel(channel_id++);
             float *out_ngain= out.channel(channel_id++);
 
-            for (size_t j=0; j<dlength; ++j)
+            for (size_t off=0, count; off<dlength; off += count)
             {
-                // Subtract the old value
-                ssize_t off = j - period;
-                if (off >= 0)
+                // Apply filter to the input buffer
+                const float *sp = window_block(&count, sbuf, off, slength, dlength);
+                w.filter(&out_prms[off], sp, count);
+
+                for (size_t j=off, m=off+count; j<m; ++j)
                 {
-                    float sp= sbuf[off];
-                    if (sp < 0.0f)
-                        nrms       -= sp*sp;
+                    // Subtract the old value
+                    float sc    = out_prms[j];
+                    float so    = w.push(sc);
+                    if (so < 0.0f)
+                        nrms       -= so*so;
+                    else
+                        prms       -= so*so;
+                    if (sc < 0.0f)
+                        nrms       += sc*sc;
                     else
-                        prms       -= sp*sp;
+                        prms       += sc*sc;
+
+                    out_prms[j]  = float(prms);
+                    out_nrms[j]  = float(nrms);
                 }
-                float sc    = sbuf[j];
-                if (sc < 0.0f)
-                    nrms       += sc*sc;
-                else
-                    prms       += sc*sc;
 
-                out_prms[j]  = sqrtf(lsp_max(prms, 0.0f) * kperiod);
-                out_nrms[j]  = sqrtf(lsp_max(nrms, 0.0f) * kperiod);
-                out_ravg[j]  = sqrtf(out_prms[j] * out_nrms[j]);
-                out_pgain[j] = out_ravg[j] / out_prms[j];
-                out_ngain[j] = out_ravg[j] / out_nrms[j];
+                // Compute the RMS values and gains
+                dsp::mul_k2(&out_prms[off], kperiod, count);
+                dsp::mul_k2(&out_nrms[off], kperiod, count);
+                dsp::ssqrt1(&out_prms[off], count);
+                dsp::ssqrt1(&out_nrms[off], count);
+                dsp::mul3(&out_ravg[off], &out_prms[off], &out_nrms[off], count);
+                dsp::ssqrt1(&out_ravg[off], count);
+                dsp::div3(&out_pgain[off], &out_ravg[off], &out_prms[off], count);
+                dsp::div3(&out_ngain[off], &out_ravg[off], &out_nrms[off], count);
             }
         }
 
@@ -427,47 +930,13 @@ namespace spike_bender
             dsp::smooth_cubic_linear(&dst[ppeak], src[ppeak], src[count - 1], count - ppeak - 1);
     }
 
-    status_t estimate_envelope(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period)
+    status_t estimate_envelope(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, ScratchArena *arena)
     {
-        dspu::Filter f;
-
-        // Initialize weighting filter
-        if (!f.init(NULL))
-        {
-            fprintf(stderr, "  error initializing filter\n");
-            return STATUS_NO_MEM;
-        }
-
-        dspu::filter_params_t fp;
-        switch (weight)
-        {
-            case A_WEIGHT:
-                fp.nType        = dspu::FLT_A_WEIGHTED;
-                break;
-            case B_WEIGHT:
-                fp.nType        = dspu::FLT_B_WEIGHTED;
-                break;
-            case C_WEIGHT:
-                fp.nType        = dspu::FLT_C_WEIGHTED;
-                break;
-            case D_WEIGHT:
-                fp.nType        = dspu::FLT_D_WEIGHTED;
-                break;
-            case K_WEIGHT:
-                fp.nType        = dspu::FLT_K_WEIGHTED;
-                break;
-            default:
-                fp.nType        = dspu::FLT_NONE;
-                break;
-        }
-
-        fp.fFreq        = 1.0f;
-        fp.fFreq2       = 1.0f;
-        fp.fGain        = 1.0f;
-        fp.fQuality     = 0.0f;
-        fp.nSlope       = 1.0f;
-
-        f.update(src->sample_rate(), &fp);
+        status_t res;
+        ScratchArena local;
+        if ((res = use_arena(&arena, &local, 1)) != STATUS_OK)
+            return res;
+        WeightingFilter *f  = &arena->slot(0)->sFilter;
 
         // Process input data with the weighting filter and compute RMS
         dspu::Sample tmp, out;
@@ -492,10 +961,10 @@ namespace spike_bender
             float *tbuf         = tmp.channel(i);
 
             // Apply filter to the input buffer
-            f.clear();
-            f.process(tbuf, sbuf, slength);
-            dsp::fill_zero(&tbuf[slength], dlength - slength);
-            f.process(&tbuf[slength], &tbuf[slength], dlength - slength);
+            if ((res = f->init(weight, src->sample_rate())) != STATUS_OK)
+                return res;
+            f->process(tbuf, sbuf, slength);
+            f->process(&tbuf[slength], NULL, dlength - slength);
 
             // Find the maximum and minimum envelope values
             float *out_ppeak    = out.channel(channel_id++);
@@ -571,57 +1040,18 @@ namespace spike_bender
         return STATUS_OK;
     }
 
-    status_t estimate_partial_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, bool positive)
+    status_t estimate_partial_rms(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, bool positive, ScratchArena *arena)
     {
-        dspu::Filter f;
-
-        // Initialize weighting filter
-        if (!f.init(NULL))
-        {
-            fprintf(stderr, "  error initializing filter\n");
-            return STATUS_NO_MEM;
-        }
-
-        dspu::filter_params_t fp;
-        switch (weight)
-        {
-            case A_WEIGHT:
-                fp.nType        = dspu::FLT_A_WEIGHTED;
-                break;
-            case B_WEIGHT:
-                fp.nType        = dspu::FLT_B_WEIGHTED;
-                break;
-            case C_WEIGHT:
-                fp.nType        = dspu::FLT_C_WEIGHTED;
-                break;
-            case D_WEIGHT:
-                fp.nType        = dspu::FLT_D_WEIGHTED;
-                break;
-            case K_WEIGHT:
-                fp.nType        = dspu::FLT_K_WEIGHTED;
-                break;
-            default:
-                fp.nType        = dspu::FLT_NONE;
-                break;
-        }
-
-        fp.fFreq        = 1.0f;
-        fp.fFreq2       = 1.0f;
-        fp.fGain        = 1.0f;
-        fp.fQuality     = 0.0f;
-        fp.nSlope       = 1.0f;
-
-        f.update(src->sample_rate(), &fp);
+        status_t res;
+        ScratchArena tmp;
+        if ((res = use_arena(&arena, &tmp, 1)) != STATUS_OK)
+            return res;
+        SlidingWindow &w    = arena->slot(0)->sWindow;
 
         // Process input data with the weighting filter and compute RMS
-        dspu::Sample tmp, out;
+        dspu::Sample out;
         size_t slength  = src->length();
         size_t dlength  = slength + period;
-        if (!tmp.init(src->channels(), dlength, dlength))
-        {
-            fprintf(stderr, "  not enough memory\n");
-            return STATUS_NO_MEM;
-        }
         if (!out.init(src->channels(), dlength, dlength))
         {
             fprintf(stderr, "  not enough memory\n");
@@ -632,31 +1062,35 @@ namespace spike_bender
 
         for (size_t i=0, n=src->channels(); i<n; ++i)
         {
-            const float *sbuf = src->channel(i);
-            float *dbuf = tmp.channel(i);
-
-            // Apply filter to the input buffer
-            f.clear();
-            f.process(dbuf, sbuf, slength);
-            dsp::fill_zero(&dbuf[slength], period);
-            f.process(&dbuf[slength], &dbuf[slength], period);
+            // Initialize the window
+            if ((res = w.init(src->sample_rate(), weight, period)) != STATUS_OK)
+                return res;
 
             // Compute the RMS value among the buffer
-            float rms   = 0.0f;
-            sbuf        = dbuf;
-            dbuf        = out.channel(i);
-            for (size_t j=0; j<dlength; ++j)
+            const float *sbuf = src->channel(i);
+            float *dbuf = out.channel(i);
+            double rms  = 0.0;
+
+            for (size_t off=0, count; off<dlength; off += count)
             {
-                // Subtract the old value
-                ssize_t off = j - period;
-                if (off >= 0)
+                // Apply filter to the input buffer
+                const float *sp = window_block(&count, sbuf, off, slength, dlength);
+                w.filter(&dbuf[off], sp, count);
+
+                for (size_t j=off, m=off+count; j<m; ++j)
                 {
-                    float sp= (positive) ? lsp_max(sbuf[off], 0.0f) : -lsp_min(sbuf[off], 0.0f);
-                    rms    -= sp * sp;
+                    // Subtract the old value
+                    float so    = w.push(dbuf[j]);
+                    float sd    = (positive) ? lsp_max(so, 0.0f) : -lsp_min(so, 0.0f);
+                    rms        -= sd * sd;
+                    float sc    = (positive) ? lsp_max(dbuf[j], 0.0f) : -lsp_min(dbuf[j], 0.0f);
+                    rms        += sc * sc;
+                    dbuf[j]     = float(rms);
                 }
-                float sc    = (positive) ? lsp_max(sbuf[j], 0.0f) : -lsp_min(sbuf[j], 0.0f);
-                rms        += sc * sc;
-                dbuf[j]     = sqrtf(lsp_max(rms, 0.0f) * kperiod);
+
+                // Compute the RMS value
+                dsp::mul_k2(&dbuf[off], kperiod, count);
+                dsp::ssqrt1(&dbuf[off], count);
             }
         }
 
@@ -667,57 +1101,18 @@ namespace spike_bender
         return STATUS_OK;
     }
 
-    status_t estimate_average(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period)
+    status_t estimate_average(dspu::Sample *dst, const dspu::Sample *src, weighting_t weight, size_t period, ScratchArena *arena)
     {
-        dspu::Filter f;
-
-        // Initialize weighting filter
-        if (!f.init(NULL))
-        {
-            fprintf(stderr, "  error initializing filter\n");
-            return STATUS_NO_MEM;
-        }
-
-        dspu::filter_params_t fp;
-        switch (weight)
-        {
-            case A_WEIGHT:
-                fp.nType        = dspu::FLT_A_WEIGHTED;
-                break;
-            case B_WEIGHT:
-                fp.nType        = dspu::FLT_B_WEIGHTED;
-                break;
-            case C_WEIGHT:
-                fp.nType        = dspu::FLT_C_WEIGHTED;
-                break;
-            case D_WEIGHT:
-                fp.nType        = dspu::FLT_D_WEIGHTED;
-                break;
-            case K_WEIGHT:
-                fp.nType        = dspu::FLT_K_WEIGHTED;
-                break;
-            default:
-                fp.nType        = dspu::FLT_NONE;
-                break;
-        }
-
-        fp.fFreq        = 1.0f;
-        fp.fFreq2       = 1.0f;
-        fp.fGain        = 1.0f;
-        fp.fQuality     = 0.0f;
-        fp.nSlope       = 1.0f;
-
-        f.update(src->sample_rate(), &fp);
+        status_t res;
+        ScratchArena tmp;
+        if ((res = use_arena(&arena, &tmp, 1)) != STATUS_OK)
+            return res;
+        SlidingWindow &w    = arena->slot(0)->sWindow;
 
         // Process input data with the weighting filter and compute RMS
-        dspu::Sample tmp, out;
+        dspu::Sample out;
         size_t slength  = src->length();
         size_t dlength  = slength + period;
-        if (!tmp.init(src->channels(), dlength, dlength))
-        {
-            fprintf(stderr, "  not enough memory\n");
-            return STATUS_NO_MEM;
-        }
         if (!out.init(src->channels(), dlength, dlength))
         {
             fprintf(stderr, "  not enough memory\n");
@@ -728,27 +1123,28 @@ namespace spike_bender
 
         for (size_t i=0, n=src->channels(); i<n; ++i)
         {
-            const float *sbuf = src->channel(i);
-            float *dbuf = tmp.channel(i);
+            // Initialize the window
+            if ((res = w.init(src->sample_rate(), weight, period)) != STATUS_OK)
+                return res;
 
-            // Apply filter to the input buffer
-            f.clear();
-            f.process(dbuf, sbuf, slength);
-            dsp::fill_zero(&dbuf[slength], period);
-            f.process(&dbuf[slength], &dbuf[slength], period);
+            // Compute the average value among the buffer
+            const float *sbuf = src->channel(i);
+            float *dbuf = out.channel(i);
+            double avg  = 0.0;
 
-            // Compute the RMS value among the buffer
-            float avg   = 0.0f;
-            sbuf        = dbuf;
-            dbuf        = out.channel(i);
-            for (size_t j=0; j<dlength; ++j)
+            for (size_t off=0, count; off<dlength; off += count)
             {
-                // Subtract the old value
-                ssize_t off = j - period;
-                if (off >= 0)
-                    avg    -= sbuf[off];
-                avg        += sbuf[j];
-                dbuf[j]     = avg * kperiod;
+                // Apply filter to the input buffer
+                const float *sp = window_block(&count, sbuf, off, slength, dlength);
+                w.filter(&dbuf[off], sp, count);
+
+                for (size_t j=off, m=off+count; j<m; ++j)
+                {
+                    // Subtract the old value
+                    avg        -= w.push(dbuf[j]);
+                    avg        += dbuf[j];
+                    dbuf[j]     = float(avg) * kperiod;
+                }
             }
         }
 
@@ -970,25 +1366,183 @@ namespace spike_bender
         // Return result
         out.swap(ranges);
 
-        return STATUS_OK;
-    }
+        return STATUS_OK;
+    }
+
+    status_t apply_gain(float *buf, lltl::darray<range_t> *ranges, float threshold)
+    {
+        for (size_t i=0, n=ranges->size(); i<n; ++i)
+        {
+            range_t *r  = ranges->uget(i);
+            if (r->gain < threshold)
+                continue;
+
+//            lsp_trace("-----");
+//            for (size_t i=r->first; i<r->last; ++i)
+//                lsp_trace("buf[%d] = %.6f", int(i), buf[i]);
+
+            float gain  = dsp::abs_max(&buf[r->first], r->last - r->first);
+
+            dsp::mul_k2(&buf[r->first], 1.0f / gain, r->last - r->first);
+        }
+
+        return STATUS_OK;
+    }
+
+    typedef struct gain_task_t
+    {
+        dspu::Sample       *dst;
+        dspu::Sample       *gain;
+        const dspu::Sample *src;
+        const dspu::Sample *env;
+        const ControlBuffer*ctl;
+        const float        *thresh;
+        float               range_db;
+        float               knee_db;
+        gain_curve_t        curve;
+        size_t              offset;
+        size_t              count;
+        size_t              decimation;
+        ScratchArena       *arena;
+        float              *peaks;
+    } gain_task_t;
+
+    static inline void track_peak(float *peak, const float *buf, ssize_t first, ssize_t last, size_t count)
+    {
+        // Clip the range to the sample
+        ssize_t head        = lsp_max(first, ssize_t(0));
+        ssize_t tail        = lsp_min(last, ssize_t(count));
+        if (head < tail)
+            *peak               = lsp_max(*peak, dsp::abs_max(&buf[head], tail - head));
+    }
+
+    static void apply_gain_segment(float *dst, const float *src,
+        ssize_t first, ssize_t last, float g1, float g2, size_t count)
+    {
+        // Clip the segment to the range of the sample
+        ssize_t head        = lsp_max(first, ssize_t(0));
+        ssize_t tail        = lsp_min(last, ssize_t(count));
+        if (head >= tail)
+            return;
+
+        // Compute the gain at the bounds of the clipped segment
+        float k             = (g2 - g1) / float(last - first);
+        float a             = g1 + k * float(head - first);
+        float b             = g1 + k * float(tail - first);
+
+        dsp::lramp3(&dst[head], &src[head], a, b, tail - head);
+    }
+
+    static status_t adjust_control_gain_channel(void *arg, size_t i)
+    {
+        status_t res;
+        gain_task_t *t      = static_cast<gain_task_t *>(arg);
+        GainComputer *gc    = &t->arena->slot(i)->sGain;
+        const size_t decim  = t->decimation;
+
+        // Configure the gain computer to run at the control rate
+        res = gc->init(lsp_max(t->src->sample_rate() / decim, size_t(1)), t->thresh[i], t->range_db, t->knee_db, t->curve);
+        if (res != STATUS_OK)
+            return res;
+
+        const float *vsrc   = t->src->channel(i);
+        float *vdst         = t->dst->channel(i);
+        float *peak         = (t->peaks != NULL) ? &t->peaks[i] : NULL;
+        size_t clength      = t->ctl->length();
+        if (peak != NULL)
+            *peak               = 0.0f;
+        if (clength <= 0)
+            return STATUS_OK;
+
+        // The envelope is converted from the storage format block by block
+        float *cgain        = new float[WINDOW_BLOCK_SIZE * 2];
+        if (cgain == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] cgain; };
+        float *cenv         = &cgain[WINDOW_BLOCK_SIZE];
+
+        // The control value k corresponds to the sample (k + 1) * decimation - 1 - offset,
+        // the gain is linearly interpolated between control values when applied
+        ssize_t pos         = ssize_t(decim) - 1 - ssize_t(t->offset);
+        ssize_t done        = 0;
+        float prev          = 0.0f;
+        for (size_t off=0; (off < clength) && (pos < ssize_t(t->count)); )
+        {
+            size_t n            = lsp_min(clength - off, WINDOW_BLOCK_SIZE);
+            t->ctl->load(cenv, i, off, n);
+            gc->process(cgain, cenv, n);
+
+            for (size_t k=0; k<n; ++k, pos += decim)
+            {
+                float g             = cgain[k];
+                if ((off + k) > 0)
+                    apply_gain_segment(vdst, vsrc, pos - decim, pos, prev, g, t->count);
+                else
+                    apply_gain_segment(vdst, vsrc, 0, pos, g, g, t->count);
+                prev                = g;
+            }
+
+            // Track the peak of the block while it is still in the cache
+            if (peak != NULL)
+            {
+                track_peak(peak, vdst, done, pos - decim, t->count);
+                done                = pos - decim;
+            }
+
+            off                += n;
+        }
+
+        // Apply the last gain value to the tail
+        apply_gain_segment(vdst, vsrc, pos - decim, t->count, prev, prev, t->count);
+        if (peak != NULL)
+            track_peak(peak, vdst, done, t->count, t->count);
+
+        return STATUS_OK;
+    }
+
+    static status_t adjust_gain_channel(void *arg, size_t i)
+    {
+        status_t res;
+        gain_task_t *t      = static_cast<gain_task_t *>(arg);
+        GainComputer *gc    = &t->arena->slot(i)->sGain;
+
+        // Configure the gain computer
+        if ((res = gc->init(t->src->sample_rate(), t->thresh[i], t->range_db, t->knee_db, t->curve)) != STATUS_OK)
+            return res;
+
+        // Perform the processing
+        const float *vsrc   = t->src->channel(i);
+        const float *venv   = &t->env->channel(i)[t->offset];
+        float *vdst         = t->dst->channel(i);
 
-    status_t apply_gain(float *buf, lltl::darray<range_t> *ranges, float threshold)
-    {
-        for (size_t i=0, n=ranges->size(); i<n; ++i)
+        if (t->gain != NULL)
         {
-            range_t *r  = ranges->uget(i);
-            if (r->gain < threshold)
-                continue;
-
-//            lsp_trace("-----");
-//            for (size_t i=r->first; i<r->last; ++i)
-//                lsp_trace("buf[%d] = %.6f", int(i), buf[i]);
+            float *vgain        = t->gain->channel(i);
+            gc->process(vgain, venv, t->count);
+            dsp::mul3(vdst, vgain, vsrc, t->count);
+            if (t->peaks != NULL)
+                t->peaks[i]         = dsp::abs_max(vdst, t->count);
+            return STATUS_OK;
+        }
 
-            float gain  = dsp::abs_max(&buf[r->first], r->last - r->first);
+        // The gain is not required, compute it block by block, this also allows in-place processing
+        float *vgain        = new float[WINDOW_BLOCK_SIZE];
+        if (vgain == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] vgain; };
 
-            dsp::mul_k2(&buf[r->first], 1.0f / gain, r->last - r->first);
+        float peak          = 0.0f;
+        for (size_t off=0; off<t->count; )
+        {
+            size_t n            = lsp_min(t->count - off, WINDOW_BLOCK_SIZE);
+            gc->process(vgain, &venv[off], n);
+            dsp::mul3(&vdst[off], vgain, &vsrc[off], n);
+            if (t->peaks != NULL)
+                peak                = lsp_max(peak, dsp::abs_max(&vdst[off], n));
+            off                += n;
         }
+        if (t->peaks != NULL)
+            t->peaks[i]         = peak;
 
         return STATUS_OK;
     }
@@ -998,12 +1552,18 @@ namespace spike_bender
         dspu::Sample *gain,
         const dspu::Sample *src,
         const dspu::Sample *env,
+        size_t offset,
         const float *thresh,
         float range_db,
-        float knee_db)
+        float knee_db,
+        gain_curve_t curve,
+        TaskPool *pool,
+        ScratchArena *arena,
+        float *peaks)
     {
+        status_t res;
         dspu::Sample out, g;
-        dspu::DynamicProcessor dp;
+        ScratchArena tmp;
 
         // Check arguments
         if (src->channels() != env->channels())
@@ -1012,225 +1572,330 @@ namespace spike_bender
             return STATUS_BAD_ARGUMENTS;
         }
 
-        // Initialize the output samples
-        size_t count = lsp_min(env->length(), src->length());
-        if (!out.init(src->channels(), count, count))
+        if ((res = use_arena(&arena, &tmp, src->channels())) != STATUS_OK)
+            return res;
+
+        // Initialize the output samples, process in place if possible
+        size_t elength  = (env->length() > offset) ? env->length() - offset : 0;
+        size_t count    = lsp_min(elength, src->length());
+        bool inplace    = (dst == src) && (count == src->length());
+        if ((!inplace) && (!out.init(src->channels(), count, count)))
         {
             fprintf(stderr, "  not enough memory\n");
             return STATUS_NO_MEM;
         }
-        if (!g.init(src->channels(), count, count))
+        if ((gain != NULL) && (!g.init(src->channels(), count, count)))
         {
             fprintf(stderr, "  not enough memory\n");
             return STATUS_NO_MEM;
         }
 
-//        constexpr int N = 201;
-//        float curve_in[N], curve_out[N];
-//        float curve_in_db[N], curve_out_db[N];
-
         // Process each channel
-        for (size_t i=0; i<src->channels(); ++i)
-        {
-            // Configure the dynamic processor
-            dp.construct();
-            lsp_finally { dp.destroy(); };
-            dp.set_sample_rate(src->sample_rate());
-
-            dspu::dyndot_t dot;
-            dot.fOutput = thresh[i];
-            dot.fKnee   = dspu::db_to_gain(-fabs(knee_db));
-
-            dot.fInput  = thresh[i] * dspu::db_to_gain(range_db - 3.0f);
-            dp.set_dot(0, &dot);
-
-//            lsp_trace("dot[0] x=%f, y=%f", dspu::gain_to_db(dot.fInput), dspu::gain_to_db(dot.fOutput));
-
-            dot.fInput  = thresh[i] * dspu::db_to_gain(-range_db - 3.0f);
-            dp.set_dot(1, &dot);
-
-//            lsp_trace("dot[1] x=%f, y=%f", dspu::gain_to_db(dot.fInput), dspu::gain_to_db(dot.fOutput));
-
-            dot.fInput  = -1.0f;
-            dp.set_dot(2, &dot);
-            dp.set_dot(3, &dot);
-
-            dp.set_attack_time(0, 0.0f);
-            dp.set_attack_level(0, thresh[i] * dspu::db_to_gain(-6.0f));
-
-//            lsp_trace("attack[0] = %f", dspu::gain_to_db(dp.get_attack_level(0)));
-            dp.set_attack_time(1, 5.0f);
-            dp.set_attack_level(1, -1.0f);
-            dp.set_attack_level(2, -1.0f);
-            dp.set_attack_level(3, -1.0f);
-
-            dp.set_release_time(0, 5.0f);
-            dp.set_release_level(0, thresh[i] * dspu::db_to_gain(-6.0f));
-//            lsp_trace("release[0] = %f", dspu::gain_to_db(dp.get_release_level(0)));
-            dp.set_release_time(1, 2.0f);
-            dp.set_release_level(1, -1.0f);
-            dp.set_release_level(2, -1.0f);
-            dp.set_release_level(3, -1.0f);
-
-            dp.set_in_ratio(1.0f);
-            dp.set_out_ratio(1.0f);
-
-            dp.update_settings();
-
-//            printf("in;out;\n");
-//            for (ssize_t k=0; k<N; ++k)
-//            {
-//                curve_in_db[k]  = k*0.5f - 100.0f;
-//                curve_in[k]     = dspu::db_to_gain(curve_in_db[k]);
-//            }
-//            dp.curve(curve_out, curve_in, N);
-//            for (ssize_t k=0; k<N; ++k)
-//            {
-//                curve_out_db[k] = dspu::gain_to_db(curve_out[k]);
-//                printf("%.2f;%.2f;\n", curve_in_db[k], curve_out_db[k]);
-//            }
-
-            // Perform the processing
-            const float *vsrc   = src->channel(i);
-            const float *venv   = env->channel(i);
-            float *vgain        = g.channel(i);
-            float *vdst         = out.channel(i);
-
-            dp.process(vgain, NULL, venv, count);
-            dsp::mul3(vdst, vgain, vsrc, count);
-        }
+        gain_task_t t;
+        t.dst       = (inplace) ? dst : &out;
+        t.gain      = (gain != NULL) ? &g : NULL;
+        t.src       = src;
+        t.env       = env;
+        t.ctl       = NULL;
+        t.thresh    = thresh;
+        t.range_db  = range_db;
+        t.knee_db   = knee_db;
+        t.curve     = curve;
+        t.offset    = offset;
+        t.count     = count;
+        t.decimation= 1;
+        t.arena     = arena;
+        t.peaks     = peaks;
+        if ((res = run_tasks(pool, src->channels(), adjust_gain_channel, &t)) != STATUS_OK)
+            return res;
 
         // Return result
-        out.set_sample_rate(src->sample_rate());
-        g.set_sample_rate(src->sample_rate());
-
-
-        if (dst != NULL)
+        if ((!inplace) && (dst != NULL))
+        {
+            out.set_sample_rate(src->sample_rate());
             out.swap(dst);
+        }
         if (gain != NULL)
+        {
+            g.set_sample_rate(src->sample_rate());
             g.swap(gain);
+        }
 
         return STATUS_OK;
     }
 
-    status_t normalize(dspu::Sample *dst, float gain, normalize_t mode)
+    status_t adjust_control_gain(
+        dspu::Sample *dst,
+        const dspu::Sample *src,
+        const ControlBuffer *env,
+        size_t offset,
+        size_t decimation,
+        const float *thresh,
+        float range_db,
+        float knee_db,
+        gain_curve_t curve,
+        TaskPool *pool,
+        ScratchArena *arena,
+        float *peaks)
     {
-        if (mode == NORM_NONE)
-            return STATUS_OK;
+        status_t res;
+        dspu::Sample out;
+        ScratchArena tmp;
 
-        float peak  = 0.0f;
-        for (size_t i=0, n=dst->channels(); i<n; ++i)
+        // Check arguments
+        if (src->channels() != env->channels())
+        {
+            fprintf(stderr, "  input samples do not match by number of channels\n");
+            return STATUS_BAD_ARGUMENTS;
+        }
+
+        if ((res = use_arena(&arena, &tmp, src->channels())) != STATUS_OK)
+            return res;
+
+        // Initialize the output samples, process in place if possible
+        size_t count    = src->length();
+        bool inplace    = (dst == src);
+        if ((!inplace) && (!out.init(src->channels(), count, count)))
+        {
+            fprintf(stderr, "  not enough memory\n");
+            return STATUS_NO_MEM;
+        }
+
+        // Process each channel
+        gain_task_t t;
+        t.dst       = (inplace) ? dst : &out;
+        t.gain      = NULL;
+        t.src       = src;
+        t.env       = NULL;
+        t.ctl       = env;
+        t.thresh    = thresh;
+        t.range_db  = range_db;
+        t.knee_db   = knee_db;
+        t.curve     = curve;
+        t.offset    = offset;
+        t.count     = count;
+        t.decimation= lsp_max(decimation, size_t(1));
+        t.arena     = arena;
+        t.peaks     = peaks;
+        if ((res = run_tasks(pool, src->channels(), adjust_control_gain_channel, &t)) != STATUS_OK)
+            return res;
+
+        // Return result
+        if (!inplace)
         {
-            float cpeak = dsp::abs_max(dst->channel(i), dst->length());
-            peak        = lsp_max(peak, cpeak);
+            out.set_sample_rate(src->sample_rate());
+            out.swap(dst);
         }
 
+        return STATUS_OK;
+    }
+
+    float normalize_gain(float peak, float gain, normalize_t mode)
+    {
+        if (mode == NORM_NONE)
+            return 1.0f;
+
         // No peak detected?
         if (peak < 1e-6)
-            return STATUS_OK;
+            return 1.0f;
 
         switch (mode)
         {
             case NORM_BELOW:
                 if (peak >= gain)
-                    return STATUS_OK;
+                    return 1.0f;
                 break;
             case NORM_ABOVE:
                 if (peak <= gain)
-                    return STATUS_OK;
+                    return 1.0f;
                 break;
             default:
                 break;
         }
 
-        // Adjust gain
-        float k = gain / peak;
-        for (size_t i=0, n=dst->channels(); i<n; ++i)
-            dsp::mul_k2(dst->channel(i), k, dst->length());
+        return gain / peak;
+    }
+
+    typedef struct norm_task_t
+    {
+        dspu::Sample       *dst;
+        const dspu::Sample *src;
+        float              *peaks;
+        float               k;
+    } norm_task_t;
 
+    static status_t estimate_peak_channel(void *arg, size_t i)
+    {
+        norm_task_t *t      = static_cast<norm_task_t *>(arg);
+        t->peaks[i]         = dsp::abs_max(t->src->channel(i), t->src->length());
         return STATUS_OK;
     }
 
-    static inline ssize_t compare_range(const void *a, const void *b, size_t size)
+    status_t estimate_peaks(const dspu::Sample *src, float *peaks, TaskPool *pool)
     {
-        const range_t *fa = static_cast<const range_t *>(a);
-        const range_t *fb = static_cast<const range_t *>(b);
-        if (fa->gain < fb->gain)
-            return -1;
-        return (fa->gain > fb->gain) ? 1 : 0.0f;
+        norm_task_t t;
+        t.dst           = NULL;
+        t.src           = src;
+        t.peaks         = peaks;
+        t.k             = 1.0f;
+
+        return run_tasks(pool, src->channels(), estimate_peak_channel, &t);
     }
 
-    static inline bool median_value(float *res, const lltl::darray<range_t> *list)
+    static status_t apply_norm_channel(void *arg, size_t i)
     {
-        lltl::parray<range_t> me;
+        norm_task_t *t      = static_cast<norm_task_t *>(arg);
+        dsp::mul_k2(t->dst->channel(i), t->k, t->dst->length());
+        return STATUS_OK;
+    }
 
-        if (!me.reserve(list->size()))
-            return false;
+    status_t normalize(dspu::Sample *dst, float gain, normalize_t mode, TaskPool *pool)
+    {
+        if (mode == NORM_NONE)
+            return STATUS_OK;
 
-        for (size_t i=0, n=list->size(); i<n; ++i)
-        {
-            if (!me.add(const_cast<range_t *>(list->uget(i))))
-                return false;
-        }
+        status_t res;
+        size_t channels = dst->channels();
+        float *peaks    = new float[lsp_max(channels, size_t(1))];
+        if (peaks == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] peaks; };
 
-        me.qsort(compare_range);
+        if ((res = estimate_peaks(dst, peaks, pool)) != STATUS_OK)
+            return res;
 
-        size_t size = list->size();
-        if (size < 2)
-        {
-            *res = (size > 0) ? me.uget(0)->gain : 0.0f;
-            return true;
-        }
-        if (size & 1)
-        {
-            *res = 0.5f * (me.uget(size >> 1)->gain + me.uget((size >> 1) + 1)->gain);
-            return true;
-        }
+        float peak  = 0.0f;
+        for (size_t i=0; i<channels; ++i)
+            peak        = lsp_max(peak, peaks[i]);
 
-        *res = me.uget(size >> 1)->gain;
-        return true;
+        // Adjust gain
+        norm_task_t t;
+        t.dst           = dst;
+        t.src           = dst;
+        t.peaks         = peaks;
+        t.k             = normalize_gain(peak, gain, mode);
+        if (t.k == 1.0f)
+            return STATUS_OK;
+
+        return run_tasks(pool, channels, apply_norm_channel, &t);
     }
 
-    static inline ssize_t compare_peak(const void *a, const void *b, size_t size)
+    static inline void swap_values(float *a, float *b)
     {
-        const peak_t *fa = static_cast<const peak_t *>(a);
-        const peak_t *fb = static_cast<const peak_t *>(b);
-        if (fa->gain < fb->gain)
-            return -1;
-        return (fa->gain > fb->gain) ? 1 : 0.0f;
+        float tmp   = *a;
+        *a          = *b;
+        *b          = tmp;
     }
 
-    static inline bool median_value(float *res, const lltl::darray<peak_t> *list)
+    /**
+     * Partially reorder the array so that the k-th element takes the place it would have
+     * in the sorted array, all elements before it are not greater and all elements after it
+     * are not less than it (quickselect with median-of-three pivot, linear on average)
+     * @param v array of values
+     * @param n number of values, should be positive
+     * @param k index of the element to select
+     */
+    static void select_nth(float *v, size_t n, size_t k)
     {
-        lltl::parray<peak_t> me;
-
-        if (!me.reserve(list->size()))
-            return false;
+        ssize_t lo  = 0;
+        ssize_t hi  = n - 1;
+        ssize_t kk  = k;
+
+        while (lo < hi)
+        {
+            // Median of three
+            ssize_t mid = lo + ((hi - lo) >> 1);
+            if (v[mid] < v[lo])
+                swap_values(&v[mid], &v[lo]);
+            if (v[hi] < v[lo])
+                swap_values(&v[hi], &v[lo]);
+            if (v[hi] < v[mid])
+                swap_values(&v[hi], &v[mid]);
+            const float pivot = v[mid];
+
+            // Partition
+            ssize_t i   = lo;
+            ssize_t j   = hi;
+            while (i <= j)
+            {
+                while (v[i] < pivot)
+                    ++i;
+                while (pivot < v[j])
+                    --j;
+                if (i <= j)
+                    swap_values(&v[i++], &v[j--]);
+            }
 
-        for (size_t i=0, n=list->size(); i<n; ++i)
-        {
-            if (!me.add(const_cast<peak_t *>(list->uget(i))))
-                return false;
+            // Continue with the part that contains the k-th element
+            if (kk <= j)
+                hi          = j;
+            else if (kk >= i)
+                lo          = i;
+            else
+                break;
         }
+    }
+
+    /**
+     * Compute the median value of the array, the array is reordered
+     * @param v array of values
+     * @param size number of values
+     * @return median value
+     */
+    static float median_of(float *v, size_t size)
+    {
+        if (size < 2)
+            return (size > 0) ? v[0] : 0.0f;
+
+        const size_t k  = size >> 1;
+        select_nth(v, size, k);
+        if (!(size & 1))
+            return v[k];
 
-        me.qsort(compare_peak);
+        // Elements after the k-th one are not less than it, the next element in the sorted order is their minimum
+        float next      = v[k + 1];
+        for (size_t i=k + 2; i<size; ++i)
+            next            = lsp_min(next, v[i]);
 
-        size_t size = list->size();
+        return 0.5f * (v[k] + next);
+    }
+
+    template <class T>
+    static bool median_gain(float *res, const lltl::darray<T> *list, lltl::darray<float> *buf)
+    {
+        const size_t size   = list->size();
         if (size < 2)
         {
-            *res = (size > 0) ? me.uget(0)->gain : 0.0f;
-            return true;
-        }
-        if (size & 1)
-        {
-            *res = 0.5f * (me.uget(size >> 1)->gain + me.uget((size >> 1) + 1)->gain);
+            *res = (size > 0) ? list->uget(0)->gain : 0.0f;
             return true;
         }
 
-        *res = me.uget(size >> 1)->gain;
+        // Use the scratch buffer if it is provided
+        lltl::darray<float> tmp;
+        if (buf == NULL)
+            buf                 = &tmp;
+        buf->clear();
+        float *v            = buf->append_n(size);
+        if (v == NULL)
+            return false;
+
+        for (size_t i=0; i<size; ++i)
+            v[i]                = list->uget(i)->gain;
+
+        *res                = median_of(v, size);
         return true;
     }
 
+    static inline bool median_value(float *res, const lltl::darray<range_t> *list)
+    {
+        return median_gain(res, list, static_cast<lltl::darray<float> *>(NULL));
+    }
+
+    bool median_value(float *res, const lltl::darray<peak_t> *list, lltl::darray<float> *buf)
+    {
+        return median_gain(res, list, buf);
+    }
+
     static inline bool check_threshold(const range_t *r, float pos, float neg)
     {
         if (r->gain > 0.0f)
@@ -1238,18 +1903,60 @@ namespace spike_bender
         return r->gain <= neg;
     }
 
-    typedef struct g_point_t
-    {
-        size_t  pos;
-        float   gain;
-    } g_point_t;
-
     static inline float interpolate(float a, float b, float x)
     {
         float d = b - a;
         return a + d * x * x * (3.0f - 2.0f * x);
     }
 
+    float peak_gain(float peak, float p_avg, float n_avg, float threshold)
+    {
+        float avg       = (peak > 0.0f) ? p_avg : n_avg;
+        return (fabsf(peak) > threshold * fabsf(avg)) ? avg*threshold / peak : 1.0f;
+    }
+
+    void apply_peak_ramp(float *dst, float gain, float egain, size_t count)
+    {
+        if (count <= 0)
+            return;
+
+        // Most of the signal is not affected by smashing
+        if (gain == egain)
+        {
+            if (gain != 1.0f)
+                dsp::mul_k2(dst, gain, count);
+            return;
+        }
+
+        // Form the smoothstep ramp gain + (egain - gain) * x^2 * (3 - 2*x), x = k/count,
+        // block by block and apply it
+        float x[WINDOW_BLOCK_SIZE];
+        float g[WINDOW_BLOCK_SIZE];
+        float delta     = egain - gain;
+        float kx        = 1.0f / count;
+
+        for (size_t off=0; off < count; )
+        {
+            size_t n        = lsp_min(count - off, WINDOW_BLOCK_SIZE);
+            dsp::lramp_set1(x, off * kx, (off + n) * kx, n);
+            dsp::mul_k3(g, x, -2.0f, n);
+            dsp::add_k2(g, 3.0f, n);
+            dsp::mul2(g, x, n);
+            dsp::mul2(g, x, n);
+            dsp::mul_k2(g, delta, n);
+            dsp::add_k2(g, gain, n);
+            dsp::mul2(&dst[off], g, n);
+
+            off            += n;
+        }
+    }
+
+    typedef struct g_point_t
+    {
+        size_t  pos;
+        float   gain;
+    } g_point_t;
+
     static status_t smash_range(float *v, lltl::darray<range_t> & ranges, size_t & index, float p_avg, float n_avg)
     {
         lltl::darray<g_point_t> points;
@@ -1517,122 +2224,235 @@ namespace spike_bender
         return STATUS_OK;
     }
 
-    status_t smash_amplitude(dspu::Sample *dst, const dspu::Sample *src, float threshold)
+    typedef struct smash_task_t
+    {
+        dspu::Sample       *dst;
+        scratch_t         **slots;          // Slots of the arena, one per segment of each channel
+        float               threshold;
+        size_t              step;
+        size_t              segments;
+        float              *medians;        // Median positive and negative peaks of each channel
+        float              *peaks;          // Absolute peak of each segment after smashing, may be NULL
+        peak_t             *starts;         // The last peak before each segment and its gain
+    } smash_task_t;
+
+    static status_t detect_peaks_segment(void *arg, size_t index)
     {
-        lltl::darray<peak_t> peaks, p_peaks, n_peaks;
         status_t res;
-        dspu::Sample out;
-        peak_t pos, neg, pk;
-
-        if ((res = out.copy(src)) != STATUS_OK)
+        smash_task_t *t = static_cast<smash_task_t *>(arg);
+        dspu::Sample *out = t->dst;
+        size_t i        = index / t->segments;
+        size_t s        = index % t->segments;
+
+        // Each segment of the channel uses its own slot of the arena
+        scratch_t *sc   = t->slots[index];
+
+        // Find local peaks and quantize peak values, segments are aligned to the quantization step
+        size_t length   = out->length();
+        size_t first    = segment_offset(length, s, t->segments, t->step);
+        size_t last     = segment_offset(length, s + 1, t->segments, t->step);
+        const float *in = out->channel(i);
+        PeakDetector &pd = sc->sDetector;
+        if ((res = pd.init(t->step)) != STATUS_OK)
+            return res;
+        if (first > 0)
+            pd.seek(first, in[first - 1]);
+        if ((res = pd.process(&sc->vPeaks, &sc->vPosPeaks, &sc->vNegPeaks, &in[first], last - first)) != STATUS_OK)
             return res;
-        out.set_sample_rate(src->sample_rate());
 
-        size_t step = src->sample_rate() / 100;
+        return (last < length) ?
+            pd.finish_segment(&sc->vPeaks, &sc->vPosPeaks, &sc->vNegPeaks, in[last]) :
+            pd.finish(&sc->vPeaks, &sc->vPosPeaks, &sc->vNegPeaks);
+    }
 
-        for (size_t i=0, n=src->channels(); i<n; ++i)
-        {
-            // Pass 1: quantize peak values
-            float *in       = out.channel(i);
+    static status_t estimate_peaks_channel(void *arg, size_t i)
+    {
+        smash_task_t *t = static_cast<smash_task_t *>(arg);
+        size_t base     = i * t->segments;
+        scratch_t *sc   = t->slots[base];
+        lltl::darray<peak_t> & p_peaks  = sc->vPosPeaks;
+        lltl::darray<peak_t> & n_peaks  = sc->vNegPeaks;
 
-            pos.index       = 0;
-            pos.gain        = -1.0f;
-            neg.index       = 0;
-            neg.gain        = 1.0f;
+        // Merge the quantized peaks of all segments, they follow in order
+        for (size_t s=1; s<t->segments; ++s)
+        {
+            const scratch_t *ss = t->slots[base + s];
+            if ((ss->vPosPeaks.size() > 0) && (!p_peaks.append_n(ss->vPosPeaks.size(), ss->vPosPeaks.array())))
+                return STATUS_NO_MEM;
+            if ((ss->vNegPeaks.size() > 0) && (!n_peaks.append_n(ss->vNegPeaks.size(), ss->vNegPeaks.array())))
+                return STATUS_NO_MEM;
+        }
 
-            p_peaks.clear();
-            n_peaks.clear();
-            peaks.clear();
+        // Estimate median values
+        float *avg      = &t->medians[i * 2];
+        avg[0]          = 0.0f;
+        avg[1]          = 0.0f;
+        if (!median_value(&avg[0], &p_peaks, &sc->vValues))
+            return STATUS_NO_MEM;
+        if (!median_value(&avg[1], &n_peaks, &sc->vValues))
+            return STATUS_NO_MEM;
 
-            for (size_t j=0, m=out.samples(); j<m; ++j)
+        // Each segment continues the ramp from the last peak of previous segments
+        peak_t *start   = &t->starts[base];
+        start->index    = 0;
+        start->gain     = 1.0f;
+        for (size_t s=1; s<t->segments; ++s)
+        {
+            const lltl::darray<peak_t> & peaks = t->slots[base + s - 1]->vPeaks;
+            start[s]        = start[s - 1];
+            if (peaks.size() > 0)
             {
-                // Add quantized point
-                if ((j % step) == 0)
-                {
-                    if (pos.gain >= 0.0f)
-                    {
-                        if (!p_peaks.append(&pos))
-                            return STATUS_NO_MEM;
-                    }
-                    if (neg.gain <= 0.0f)
-                    {
-                        if (!n_peaks.append(&neg))
-                            return STATUS_NO_MEM;
-                    }
+                const peak_t *p = peaks.uget(peaks.size() - 1);
+                start[s].index  = p->index;
+                start[s].gain   = peak_gain(p->gain, avg[0], avg[1], t->threshold);
+            }
+        }
 
-                    pos.index       = 0;
-                    pos.gain        = -1.0f;
-                    neg.index       = 0;
-                    neg.gain        = 1.0f;
-                }
+        return STATUS_OK;
+    }
 
-                // Find another local peak
-                float s         = in[j];
-                float s_prev    = (j > 0) ? in[j-1] : 0.0f;
-                float s_next    = (j < m) ? in[j+1] : 0.0f;
-                float ds_prev   = s - s_prev;
-                float ds_next   = s_next - s;
-                if ((ds_next < 0.0f) && (ds_prev >= 0.0f) && (s > 0.0f))
-                {
-                    pk.index        = j;
-                    pk.gain         = s;
-                    if (!peaks.add(&pk))
-                        return STATUS_NO_MEM;
+    static status_t smash_peaks_segment(void *arg, size_t index)
+    {
+        peak_t pk;
+        smash_task_t *t = static_cast<smash_task_t *>(arg);
+        dspu::Sample *out = t->dst;
+        size_t i        = index / t->segments;
+        size_t s        = index % t->segments;
+        scratch_t *sc   = t->slots[index];
+        lltl::darray<peak_t> & peaks    = sc->vPeaks;
+        const float *avg = &t->medians[i * 2];
+
+        // Add last peak at the end of file
+        if (s + 1 >= t->segments)
+        {
+            pk.index        = out->length();
+            pk.gain         = 1.0f;
+            if (!peaks.add(&pk))
+                return STATUS_NO_MEM;
+        }
 
-                    // We've just passed positive peak at the previous step
-                    if (pos.gain < pk.gain)
-                        pos             = pk;
-                }
-                else if ((ds_next > 0.0f) && (ds_prev <= 0.0f) && (s < 0.0f))
-                {
-                    pk.index        = j;
-                    pk.gain         = s;
-                    if (!peaks.add(&pk))
-                        return STATUS_NO_MEM;
+        // Walk through the peaks and tune them. Invert the sign of output signal.
+        // Ramps of segments do not overlap, so segments are processed independently
+        float *in       = out->channel(i);
+        size_t idx      = t->starts[index].index;
+        float gain      = t->starts[index].gain;
+        size_t mark     = idx;
+        float peak      = 0.0f;
 
-                    // We've just passed negative peak at the previous step
-                    if (neg.gain > pk.gain)
-                        neg             = pk;
-                }
+        for (size_t j=0, m=peaks.size(); j<m; ++j)
+        {
+            const peak_t *p = peaks.uget(j);
 
-                s_prev          = s;
+            // Long ranges without peaks are split at the samples between them, the same
+            // way as in streaming mode that holds the signal between peaks
+            while (p->index - idx > PEAK_RAMP_MAX)
+            {
+                float egain     = peak_gain(in[idx + PEAK_RAMP_MAX], avg[0], avg[1], t->threshold);
+                apply_peak_ramp(&in[idx], gain, egain, PEAK_RAMP_MAX);
+                idx            += PEAK_RAMP_MAX;
+                gain            = egain;
             }
 
-            // Pass 2: Estimate median values
-            float p_avg     = 0.0f;
-            float n_avg     = 0.0f;
-            if (!median_value(&p_avg, &p_peaks))
-                return STATUS_NO_MEM;
-            if (!median_value(&n_avg, &n_peaks))
-                return STATUS_NO_MEM;
+            float egain     = peak_gain(p->gain, avg[0], avg[1], t->threshold);
+            apply_peak_ramp(&in[idx], gain, egain, p->index - idx);
 
-            // Add last peak at the end of file
-            pk.index        = out.length();
-            pk.gain         = 1.0f;
-            if (!peaks.add(&pk))
+            idx             = p->index;
+            gain            = egain;
+
+            // Track the peak of the output block by block while it is still in the cache
+            if ((t->peaks != NULL) && ((idx - mark) >= PEAK_BLOCK_SIZE))
+            {
+                peak            = lsp_max(peak, dsp::abs_max(&in[mark], idx - mark));
+                mark            = idx;
+            }
+        }
+
+        if (t->peaks != NULL)
+        {
+            if (idx > mark)
+                peak            = lsp_max(peak, dsp::abs_max(&in[mark], idx - mark));
+            t->peaks[index] = peak;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t smash_amplitude(dspu::Sample *dst, const dspu::Sample *src, float threshold, TaskPool *pool,
+        ScratchArena *arena, float *peaks)
+    {
+        status_t res;
+        dspu::Sample out;
+
+        // Use the scratch buffers of the arena if it is provided
+        size_t channels = src->channels();
+        size_t segments = channel_segments(pool, channels, src->length(), SEGMENT_MIN_LENGTH);
+        ScratchArena tmp;
+        if (arena == NULL)
+            arena           = &tmp;
+        if ((res = arena->reserve(channels * segments)) != STATUS_OK)
+            return res;
+
+        // The slots keep the peaks between processing steps, so they are cleared only once
+        scratch_t **slots   = new scratch_t *[channels * segments];
+        if (slots == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] slots; };
+        for (size_t i=0, n=channels * segments; i<n; ++i)
+        {
+            if ((slots[i] = arena->slot(i)) == NULL)
                 return STATUS_NO_MEM;
+        }
 
-            // Pass 3: Walk through the peaks and tune them. Invert the sign of output signal
-            size_t idx      = 0;
-            float gain      = 1.0f;
+        // Medians of channels are followed by peaks of segments
+        float *medians  = new float[channels * (segments + 2)];
+        if (medians == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] medians; };
+        peak_t *starts  = new peak_t[channels * segments];
+        if (starts == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] starts; };
 
-            for (size_t j=0, m=peaks.size(); j<m; ++j)
-            {
-                const peak_t *p = peaks.uget(j);
-                float avg       = (p->gain > 0.0f) ? p_avg : n_avg;
-                float egain     = (fabsf(p->gain) > threshold * fabsf(avg)) ? avg*threshold / p->gain : 1.0f;
-                float delta     = 1.0f / float(p->index - idx);
+        // Process in place if possible
+        bool inplace    = (dst == src);
+        if (!inplace)
+        {
+            if ((res = out.copy(src)) != STATUS_OK)
+                return res;
+            out.set_sample_rate(src->sample_rate());
+        }
 
-                for (size_t k=idx; k<p->index; ++k)
-                    in[k]          *= interpolate(gain, egain, (k - idx) * delta);
+        smash_task_t t;
+        t.dst           = (inplace) ? dst : &out;
+        t.slots         = slots;
+        t.threshold     = threshold;
+        t.step          = lsp_max(src->sample_rate() / 100, size_t(1));
+        t.segments      = segments;
+        t.medians       = medians;
+        t.peaks         = (peaks != NULL) ? &medians[channels * 2] : NULL;
+        t.starts        = starts;
 
-                idx             = p->index;
-                gain            = egain;
+        // The peaks of all segments should be found before the medians are estimated and the signal is changed
+        if ((res = run_tasks(pool, channels * segments, detect_peaks_segment, &t)) != STATUS_OK)
+            return res;
+        if ((res = run_tasks(pool, channels, estimate_peaks_channel, &t)) != STATUS_OK)
+            return res;
+        if ((res = run_tasks(pool, channels * segments, smash_peaks_segment, &t)) != STATUS_OK)
+            return res;
+
+        if (peaks != NULL)
+        {
+            for (size_t i=0; i<channels; ++i)
+            {
+                peaks[i]        = 0.0f;
+                for (size_t s=0; s<segments; ++s)
+                    peaks[i]        = lsp_max(peaks[i], t.peaks[i * segments + s]);
             }
         }
 
         // Commit the result
-        out.swap(dst);
+        if (!inplace)
+            out.swap(dst);
 
         return STATUS_OK;
     }
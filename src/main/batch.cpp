@@ -0,0 +1,396 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/io/Dir.h>
+#include <lsp-plug.in/io/InSequence.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#include <private/batch.h>
+#include <private/pool.h>
+#include <private/tool.h>
+
+namespace spike_bender
+{
+    typedef struct batch_t
+    {
+        const config_t         *pConfig;        // Configuration
+        lltl::parray<job_t>    *pJobs;          // List of jobs
+        ipc::Mutex              sMutex;         // Mutex to synchronize the job queue
+        size_t                  nNext;          // Next job to process
+    } batch_t;
+
+    void destroy_jobs(lltl::parray<job_t> *list)
+    {
+        for (size_t i=0, n=list->size(); i<n; ++i)
+        {
+            job_t *job = list->uget(i);
+            if (job != NULL)
+                delete job;
+        }
+        list->flush();
+    }
+
+    static status_t make_out_file(LSPString *dst, const config_t *cfg, const LSPString *in_file)
+    {
+        status_t res;
+        io::Path path;
+        LSPString name, key, value;
+
+        if (cfg->sOutDir.is_empty())
+        {
+            fprintf(stderr, "Output directory required for file '%s'\n", in_file->get_native());
+            return STATUS_BAD_ARGUMENTS;
+        }
+
+        // Format the output file name
+        if ((res = path.set(in_file)) != STATUS_OK)
+            return res;
+        if ((res = path.get_last_noext(&value)) != STATUS_OK)
+            return res;
+        if (!key.set_ascii("{name}"))
+            return STATUS_NO_MEM;
+        if (cfg->sOutName.is_empty())
+        {
+            if (!name.set_ascii("{name}.wav"))
+                return STATUS_NO_MEM;
+        }
+        else if (!name.set(&cfg->sOutName))
+            return STATUS_NO_MEM;
+        if (!name.replace_all(&key, &value))
+            return STATUS_NO_MEM;
+
+        // Form the output path
+        if ((res = path.set(&cfg->sOutDir, &name)) != STATUS_OK)
+            return res;
+
+        return (dst->set(path.as_string())) ? STATUS_OK : STATUS_NO_MEM;
+    }
+
+    static status_t add_job(lltl::parray<job_t> *list, const LSPString *in_file, const LSPString *out_file)
+    {
+        job_t *job      = new job_t;
+        if (job == NULL)
+            return STATUS_NO_MEM;
+
+        job->nResult    = STATUS_OK;
+        if ((!job->sInFile.set(in_file)) || (!job->sOutFile.set(out_file)) || (!list->add(job)))
+        {
+            delete job;
+            return STATUS_NO_MEM;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t read_batch_file(lltl::parray<job_t> *list, const config_t *cfg)
+    {
+        status_t res;
+        io::InSequence is;
+        LSPString line, in_file, out_file;
+
+        if ((res = is.open(&cfg->sBatchFile)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not open batch file '%s', error code: %d\n", cfg->sBatchFile.get_native(), int(res));
+            return res;
+        }
+        lsp_finally { is.close(); };
+
+        // Each line contains the input file name and optional output file name separated by tab
+        for (size_t lnum = 1; ; ++lnum)
+        {
+            if ((res = is.read_line(&line, true)) != STATUS_OK)
+            {
+                if (res == STATUS_EOF)
+                    break;
+                fprintf(stderr, "Error reading batch file '%s', error code: %d\n", cfg->sBatchFile.get_native(), int(res));
+                return res;
+            }
+
+            // Skip empty lines and comments
+            line.trim();
+            if ((line.is_empty()) || (line.first() == '#'))
+                continue;
+
+            ssize_t idx = line.index_of('\t');
+            if (idx >= 0)
+            {
+                if ((!in_file.set(&line, 0, idx)) || (!out_file.set(&line, idx + 1)))
+                    return STATUS_NO_MEM;
+                in_file.trim();
+                out_file.trim();
+            }
+            else
+            {
+                if (!in_file.set(&line))
+                    return STATUS_NO_MEM;
+                out_file.clear();
+            }
+
+            if (out_file.is_empty())
+            {
+                if ((res = make_out_file(&out_file, cfg, &in_file)) != STATUS_OK)
+                {
+                    fprintf(stderr, "  at line %d of batch file '%s'\n", int(lnum), cfg->sBatchFile.get_native());
+                    return res;
+                }
+            }
+
+            if ((res = add_job(list, &in_file, &out_file)) != STATUS_OK)
+                return res;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t read_directory(lltl::parray<job_t> *list, const config_t *cfg)
+    {
+        status_t res;
+        io::Dir dir;
+        io::Path path, item;
+        io::fattr_t attr;
+        LSPString name, out_file;
+
+        if ((res = path.set(&cfg->sInDir)) != STATUS_OK)
+            return res;
+        if ((res = dir.open(&path)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not open directory '%s', error code: %d\n", cfg->sInDir.get_native(), int(res));
+            return res;
+        }
+        lsp_finally { dir.close(); };
+
+        while (true)
+        {
+            if ((res = dir.reads(&item, &attr, true)) != STATUS_OK)
+            {
+                if (res == STATUS_EOF)
+                    break;
+                fprintf(stderr, "Error reading directory '%s', error code: %d\n", cfg->sInDir.get_native(), int(res));
+                return res;
+            }
+
+            // Process only regular files, skip hidden files
+            if (attr.type != io::fattr_t::FT_REGULAR)
+                continue;
+            if ((res = item.get_last(&name)) != STATUS_OK)
+                return res;
+            if (name.first() == '.')
+                continue;
+
+            if ((res = make_out_file(&out_file, cfg, item.as_string())) != STATUS_OK)
+                return res;
+            if ((res = add_job(list, item.as_string(), &out_file)) != STATUS_OK)
+                return res;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t check_outputs(lltl::parray<job_t> *list)
+    {
+        status_t res;
+        size_t count    = list->size();
+        if (count <= 0)
+            return STATUS_OK;
+
+        // Paths are compared in the canonical form, input and output paths follow one by one
+        io::Path *paths = new io::Path[count * 2];
+        if (paths == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] paths; };
+
+        for (size_t i=0; i<count; ++i)
+        {
+            const job_t *job    = list->uget(i);
+            if ((res = paths[i*2].set(&job->sInFile)) != STATUS_OK)
+                return res;
+            if ((res = paths[i*2].canonicalize()) != STATUS_OK)
+                return res;
+            if ((res = paths[i*2 + 1].set(&job->sOutFile)) != STATUS_OK)
+                return res;
+            if ((res = paths[i*2 + 1].canonicalize()) != STATUS_OK)
+                return res;
+        }
+
+        // The output file should not replace any input file and should not be written by
+        // several jobs, such jobs are failed before processing instead of losing the data
+        for (size_t i=0; i<count; ++i)
+        {
+            job_t *job          = list->uget(i);
+            const io::Path *out = &paths[i*2 + 1];
+            for (size_t j=0; j<count; ++j)
+            {
+                if (!out->equals(&paths[j*2]))
+                    continue;
+                fprintf(stderr, "Output file '%s' of '%s' overwrites the input file '%s'\n",
+                    job->sOutFile.get_native(), job->sInFile.get_native(), list->uget(j)->sInFile.get_native());
+                job->nResult        = STATUS_ALREADY_EXISTS;
+                break;
+            }
+            for (size_t j=i+1; j<count; ++j)
+            {
+                job_t *other        = list->uget(j);
+                if (!out->equals(&paths[j*2 + 1]))
+                    continue;
+                fprintf(stderr, "Output file '%s' is the same for '%s' and '%s'\n",
+                    job->sOutFile.get_native(), job->sInFile.get_native(), other->sInFile.get_native());
+                job->nResult        = STATUS_ALREADY_EXISTS;
+                other->nResult      = STATUS_ALREADY_EXISTS;
+            }
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t build_jobs(lltl::parray<job_t> *list, const config_t *cfg)
+    {
+        status_t res    = STATUS_OK;
+        if (!cfg->sBatchFile.is_empty())
+            res             = read_batch_file(list, cfg);
+        else if (!cfg->sInDir.is_empty())
+            res             = read_directory(list, cfg);
+        if (res != STATUS_OK)
+            return res;
+
+        return check_outputs(list);
+    }
+
+    static job_t *next_job(batch_t *b)
+    {
+        job_t *job      = NULL;
+
+        b->sMutex.lock();
+        if (b->nNext < b->pJobs->size())
+            job             = b->pJobs->uget(b->nNext++);
+        b->sMutex.unlock();
+
+        return job;
+    }
+
+    static void process_job(batch_t *b, job_t *job, Context *ctx)
+    {
+        // The jobs with conflicting output files are failed when the list is built
+        if (job->nResult == STATUS_OK)
+        {
+            // Ensure that the output directory exists
+            io::Path path;
+            if ((job->nResult = path.set(&job->sOutFile)) == STATUS_OK)
+                job->nResult    = path.mkparent(true);
+
+            if (job->nResult == STATUS_OK)
+                job->nResult    = process_file(b->pConfig, &job->sInFile, &job->sOutFile, ctx);
+            ctx->stats()->swap(&job->sStats);
+        }
+
+        if (job->nResult == STATUS_OK)
+            fprintf(stdout, "[  OK  ] '%s' -> '%s'\n", job->sInFile.get_native(), job->sOutFile.get_native());
+        else
+            fprintf(stdout, "[FAILED] '%s', error code: %d\n", job->sInFile.get_native(), int(job->nResult));
+        fflush(stdout);
+    }
+
+    static status_t batch_worker(void *arg, size_t)
+    {
+        batch_t *b      = static_cast<batch_t *>(arg);
+
+        // The context is shared between all files processed by the worker, so the
+        // filters, dynamic processors and scratch buffers are set up only once
+        Context ctx(b->pConfig);
+        for (job_t *job = next_job(b); job != NULL; job = next_job(b))
+            process_job(b, job, &ctx);
+
+        // Do not abort processing of other files
+        return STATUS_OK;
+    }
+
+    static status_t write_batch_stats(const config_t *cfg, lltl::parray<job_t> *jobs)
+    {
+        lltl::darray<file_stats_t> list;
+        file_stats_t *fs    = list.add_n(jobs->size());
+        if (fs == NULL)
+            return STATUS_NO_MEM;
+
+        for (size_t i=0, n=jobs->size(); i<n; ++i, ++fs)
+        {
+            const job_t *job    = jobs->uget(i);
+            fs->pInFile         = &job->sInFile;
+            fs->pOutFile        = &job->sOutFile;
+            fs->nResult         = job->nResult;
+            fs->pStats          = &job->sStats;
+        }
+
+        return write_stats(&cfg->sStatsFile, list.array(), list.size());
+    }
+
+    status_t process_batch(const config_t *cfg)
+    {
+        status_t res;
+        lltl::parray<job_t> jobs;
+        lsp_finally { destroy_jobs(&jobs); };
+
+        // Build list of jobs
+        if ((res = build_jobs(&jobs, cfg)) != STATUS_OK)
+            return res;
+        if (jobs.is_empty())
+        {
+            fprintf(stderr, "No files to process\n");
+            return STATUS_NO_DATA;
+        }
+
+        // Process jobs
+        TaskPool pool(cfg->nJobs);
+        batch_t b;
+        b.pConfig       = cfg;
+        b.pJobs         = &jobs;
+        b.nNext         = 0;
+        if ((res = run_tasks(&pool, lsp_min(pool.threads(), jobs.size()), batch_worker, &b)) != STATUS_OK)
+            return res;
+
+        // Output the summary
+        size_t failed   = 0;
+        res             = STATUS_OK;
+        for (size_t i=0, n=jobs.size(); i<n; ++i)
+        {
+            const job_t *job = jobs.uget(i);
+            if (job->nResult == STATUS_OK)
+                continue;
+            if (res == STATUS_OK)
+                res             = job->nResult;
+            ++failed;
+        }
+
+        fprintf(stdout, "Processed %d files, %d succeeded, %d failed\n",
+            int(jobs.size()), int(jobs.size() - failed), int(failed));
+
+        // Write the statistics if required
+        if (!cfg->sStatsFile.is_empty())
+        {
+            status_t sres   = write_batch_stats(cfg, &jobs);
+            if (res == STATUS_OK)
+                res             = sres;
+        }
+
+        return res;
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <spike-bender/processor.h>
+
+#include <private/config.h>
+#include <private/processor.h>
+
+namespace spike_bender
+{
+    void init_block_params(block_params_t *params)
+    {
+        config_t cfg;
+
+        params->nPasses         = cfg.nPasses;
+        params->fReactivity     = cfg.fReactivity;
+        params->fRange          = cfg.fRange;
+        params->fKnee           = cfg.fKnee;
+        params->enWeighting     = BLOCK_WEIGHT_NONE;
+        params->enCurve         = BLOCK_CURVE_EXACT;
+        params->nBlockSize      = cfg.nBlockSize;
+        params->nThreads        = cfg.nThreads;
+        params->bLive           = cfg.bLive;
+    }
+
+    static weighting_t block_weighting(block_weighting_t weight)
+    {
+        switch (weight)
+        {
+            case BLOCK_WEIGHT_A:    return A_WEIGHT;
+            case BLOCK_WEIGHT_B:    return B_WEIGHT;
+            case BLOCK_WEIGHT_C:    return C_WEIGHT;
+            case BLOCK_WEIGHT_D:    return D_WEIGHT;
+            case BLOCK_WEIGHT_K:    return K_WEIGHT;
+            default:                break;
+        }
+        return NO_WEIGHT;
+    }
+
+    static block_status_t block_status(status_t res)
+    {
+        switch (res)
+        {
+            case STATUS_OK:             return SB_OK;
+            case STATUS_NO_MEM:         return SB_NO_MEM;
+            case STATUS_BAD_ARGUMENTS:
+            case STATUS_INVALID_VALUE:  return SB_BAD_ARGUMENTS;
+            case STATUS_BAD_STATE:      return SB_BAD_STATE;
+            default:                    break;
+        }
+        return SB_UNKNOWN_ERROR;
+    }
+
+    BlockProcessor::BlockProcessor()
+    {
+        pProcessor      = NULL;
+    }
+
+    BlockProcessor::~BlockProcessor()
+    {
+        destroy();
+    }
+
+    block_status_t BlockProcessor::init(const block_params_t *params, size_t channels, size_t sample_rate)
+    {
+        destroy();
+        if (params == NULL)
+            return SB_BAD_ARGUMENTS;
+
+        config_t cfg;
+        cfg.nPasses     = params->nPasses;
+        cfg.fReactivity = params->fReactivity;
+        cfg.fRange      = params->fRange;
+        cfg.fKnee       = params->fKnee;
+        cfg.enWeighting = block_weighting(params->enWeighting);
+        cfg.enGainCurve = (params->enCurve == BLOCK_CURVE_TABLE) ? GAIN_CURVE_TABLE : GAIN_CURVE_EXACT;
+        cfg.nBlockSize  = params->nBlockSize;
+        cfg.nThreads    = params->nThreads;
+        cfg.bLive       = params->bLive;
+
+        pProcessor      = new Processor();
+        if (pProcessor == NULL)
+            return SB_NO_MEM;
+
+        status_t res    = pProcessor->init(&cfg, channels, sample_rate);
+        if (res != STATUS_OK)
+            destroy();
+
+        return block_status(res);
+    }
+
+    void BlockProcessor::destroy()
+    {
+        if (pProcessor != NULL)
+        {
+            delete pProcessor;
+            pProcessor      = NULL;
+        }
+    }
+
+    size_t BlockProcessor::channels() const
+    {
+        return (pProcessor != NULL) ? pProcessor->channels() : 0;
+    }
+
+    size_t BlockProcessor::sample_rate() const
+    {
+        return (pProcessor != NULL) ? pProcessor->sample_rate() : 0;
+    }
+
+    bool BlockProcessor::live() const
+    {
+        return (pProcessor != NULL) ? pProcessor->live() : false;
+    }
+
+    size_t BlockProcessor::latency() const
+    {
+        return (pProcessor != NULL) ? pProcessor->latency() : 0;
+    }
+
+    block_status_t BlockProcessor::reset()
+    {
+        return (pProcessor != NULL) ? block_status(pProcessor->reset()) : SB_BAD_STATE;
+    }
+
+    block_status_t BlockProcessor::set_level(size_t channel, float level)
+    {
+        return (pProcessor != NULL) ? block_status(pProcessor->set_level(channel, level)) : SB_BAD_STATE;
+    }
+
+    float BlockProcessor::level(size_t channel) const
+    {
+        return (pProcessor != NULL) ? pProcessor->level(channel) : 0.0f;
+    }
+
+    block_status_t BlockProcessor::analyze(const float * const *src, size_t count)
+    {
+        return (pProcessor != NULL) ? block_status(pProcessor->analyze(src, count)) : SB_BAD_STATE;
+    }
+
+    block_status_t BlockProcessor::process(float * const *dst, const float * const *src, size_t count, size_t *written)
+    {
+        return (pProcessor != NULL) ? block_status(pProcessor->process(dst, src, count, written)) : SB_BAD_STATE;
+    }
+
+    block_status_t BlockProcessor::flush(float * const *dst, size_t count, size_t *written)
+    {
+        return (pProcessor != NULL) ? block_status(pProcessor->flush(dst, count, written)) : SB_BAD_STATE;
+    }
+
+} /* namespace spike_bender */
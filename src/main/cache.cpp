@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/cache.h>
+
+namespace spike_bender
+{
+    static constexpr uint32_t CACHE_VERSION         = 2;                    // Version of the cache file format
+    static constexpr size_t CACHE_ALIGN             = 0x40;                 // Alignment of the sample data
+    static constexpr uint64_t FNV_OFFSET            = 0xcbf29ce484222325ULL;
+    static constexpr uint64_t FNV_PRIME             = 0x00000100000001b3ULL;
+
+    static const char cache_magic[]                 = "SBACACHE";
+
+    typedef struct cache_header_t
+    {
+        char                    vMagic[8];      // Signature of the file
+        uint32_t                nVersion;       // Version of the format
+        uint32_t                nChannels;      // Number of channels
+        uint64_t                nLength;        // Length of each channel in samples
+        uint64_t                nSampleRate;    // Sample rate
+        cache_key_t             sKey;           // Key of the analysis
+    } cache_header_t;
+
+    static uint64_t hash_data(uint64_t hash, const uint8_t *data, wsize_t size)
+    {
+        // FNV-1a applied to 64-bit words, the tail is processed byte by byte
+        uint64_t w;
+        for ( ; size >= sizeof(uint64_t); size -= sizeof(uint64_t), data += sizeof(uint64_t))
+        {
+            memcpy(&w, data, sizeof(uint64_t));
+            hash        = (hash ^ w) * FNV_PRIME;
+        }
+        for ( ; size > 0; --size, ++data)
+            hash        = (hash ^ *data) * FNV_PRIME;
+
+        return hash;
+    }
+
+    static inline wsize_t data_offset(size_t channels)
+    {
+        wsize_t size    = sizeof(cache_header_t) + channels * sizeof(float);
+        return (size + CACHE_ALIGN - 1) & ~wsize_t(CACHE_ALIGN - 1);
+    }
+
+    static inline bool key_equals(const cache_key_t *a, const cache_key_t *b)
+    {
+        return (a->nHash == b->nHash) &&
+            (a->nSize == b->nSize) &&
+            (a->nSampleRate == b->nSampleRate) &&
+            (a->nResample == b->nResample) &&
+            (a->nWeighting == b->nWeighting) &&
+            (a->nScanDecimation == b->nScanDecimation);
+    }
+
+    status_t make_cache_key(cache_key_t *key, const LSPString *in_file, const config_t *cfg)
+    {
+        MappedFile f;
+        status_t res    = f.open(in_file);
+        if (res != STATUS_OK)
+            return res;
+
+        key->nHash          = hash_data(FNV_OFFSET, f.data(), f.size());
+        key->nSize          = f.size();
+        key->nSampleRate    = (cfg->nSampleRate > 0) ? cfg->nSampleRate : 0;
+        key->nResample      = uint32_t(cfg->enResample);
+        key->nWeighting     = uint32_t(cfg->enWeighting);
+        key->nScanDecimation= uint64_t(cfg->nScanDecimation);
+
+        return f.close();
+    }
+
+    status_t make_cache_path(LSPString *dst, const LSPString *dir, const cache_key_t *key)
+    {
+        status_t res;
+        io::Path path;
+        LSPString name;
+
+        uint64_t hash   = hash_data(FNV_OFFSET, reinterpret_cast<const uint8_t *>(key), sizeof(cache_key_t));
+        if (!name.fmt_ascii("%016llx.sbac", (unsigned long long)hash))
+            return STATUS_NO_MEM;
+        if ((res = path.set(dir, &name)) != STATUS_OK)
+            return res;
+
+        return (dst->set(path.as_string())) ? STATUS_OK : STATUS_NO_MEM;
+    }
+
+    //-------------------------------------------------------------------------
+    // AnalysisCache
+    AnalysisCache::AnalysisCache()
+    {
+        vLevels     = NULL;
+        vData       = NULL;
+        nChannels   = 0;
+        nLength     = 0;
+        nSampleRate = 0;
+    }
+
+    AnalysisCache::~AnalysisCache()
+    {
+        close();
+    }
+
+    status_t AnalysisCache::open(const LSPString *path, const cache_key_t *key)
+    {
+        close();
+
+        io::Path fpath;
+        status_t res    = fpath.set(path);
+        if (res != STATUS_OK)
+            return res;
+        if (!fpath.is_reg())
+            return STATUS_NOT_FOUND;
+        if ((res = sFile.open(path)) != STATUS_OK)
+            return res;
+
+        // Validate the header and the size of the file
+        const cache_header_t *hdr   = reinterpret_cast<const cache_header_t *>(sFile.data());
+        if ((sFile.size() < sizeof(cache_header_t)) ||
+            (memcmp(hdr->vMagic, cache_magic, sizeof(hdr->vMagic)) != 0) ||
+            (hdr->nVersion != CACHE_VERSION) ||
+            (hdr->nChannels <= 0) ||
+            (!key_equals(&hdr->sKey, key)))
+        {
+            sFile.close();
+            return STATUS_BAD_FORMAT;
+        }
+
+        wsize_t offset  = data_offset(hdr->nChannels);
+        if (sFile.size() != offset + wsize_t(hdr->nChannels) * hdr->nLength * sizeof(float))
+        {
+            sFile.close();
+            return STATUS_BAD_FORMAT;
+        }
+
+        vLevels         = reinterpret_cast<const float *>(&sFile.data()[sizeof(cache_header_t)]);
+        vData           = reinterpret_cast<const float *>(&sFile.data()[offset]);
+        nChannels       = hdr->nChannels;
+        nLength         = hdr->nLength;
+        nSampleRate     = hdr->nSampleRate;
+
+        return STATUS_OK;
+    }
+
+    status_t AnalysisCache::close()
+    {
+        vLevels         = NULL;
+        vData           = NULL;
+        nChannels       = 0;
+        nLength         = 0;
+        nSampleRate     = 0;
+
+        return sFile.close();
+    }
+
+    status_t AnalysisCache::load(dspu::Sample *dst) const
+    {
+        if (vData == NULL)
+            return STATUS_BAD_STATE;
+
+        dspu::Sample temp;
+        if (!temp.init(nChannels, nLength, nLength))
+            return STATUS_NO_MEM;
+        temp.set_sample_rate(nSampleRate);
+
+        for (size_t i=0; i<nChannels; ++i)
+            dsp::copy(temp.channel(i), &vData[i * nLength], nLength);
+
+        temp.swap(dst);
+
+        return STATUS_OK;
+    }
+
+    status_t AnalysisCache::save(const LSPString *path, const cache_key_t *key,
+        const dspu::Sample *src, const float *levels)
+    {
+        status_t res;
+        io::Path fpath;
+        MappedFile f;
+
+        size_t channels = src->channels();
+        size_t length   = src->length();
+        wsize_t offset  = data_offset(channels);
+
+        if ((res = fpath.set(path)) != STATUS_OK)
+            return res;
+        if ((res = fpath.mkparent(true)) != STATUS_OK)
+            return res;
+        // The data is written to the temporary file that replaces the cache file at once,
+        // so the processes that have mapped the previous file keep reading its data
+        if ((res = f.create_temp(path, offset + wsize_t(channels) * length * sizeof(float))) != STATUS_OK)
+            return res;
+
+        uint8_t *data   = f.data();
+        memset(data, 0, offset);
+        memcpy(&data[sizeof(cache_header_t)], levels, channels * sizeof(float));
+        float *dst      = reinterpret_cast<float *>(&data[offset]);
+        for (size_t i=0; i<channels; ++i)
+            dsp::copy(&dst[i * length], src->channel(i), length);
+
+        // The header is written last, so the incomplete file is never accepted
+        cache_header_t *hdr = reinterpret_cast<cache_header_t *>(data);
+        hdr->nVersion       = CACHE_VERSION;
+        hdr->nChannels      = uint32_t(channels);
+        hdr->nLength        = length;
+        hdr->nSampleRate    = src->sample_rate();
+        hdr->sKey           = *key;
+        memcpy(hdr->vMagic, cache_magic, sizeof(hdr->vMagic));
+
+        return f.commit();
+    }
+
+} /* namespace spike_bender */
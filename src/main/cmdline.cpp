@@ -28,6 +28,7 @@
 
 #include <private/config.h>
 #include <private/cmdline.h>
+#include <private/live.h>
 
 namespace spike_bender
 {
@@ -49,17 +50,35 @@ namespace spike_bender
 
     static const option_t options[] =
     {
+        { "-ac",  "--analysis-cache",       false,     "The path to the directory to cache the decoded signal and its long-time RMS between runs" },
+        { "-bf",  "--batch-file",           false,     "The path to the batch file with the list of input (and optionally output) files"      },
+        { "-bs",  "--block-size",           false,     "Block size for the streaming and live modes (in samples, 65536 and 256 by default)"    },
+        { "-cf",  "--control-format",       false,     "Storage format of the decimated control signal (f32, f16, log16, f32 by default)"     },
+        { "-ch",  "--channels",             false,     "Number of channels of the live stream, 2 by default"                                    },
+        { "-dc",  "--decimation",           false,     "Decimation factor of the control signal for RMS and gain computation (1 by default)"   },
         { "-dr",  "--dynamic-range",        false,     "Dynamic range of the compressor (in dB, 6 dB by default)"                               },
         { "-ep",  "--eliminate-peaks",      true,      "Enable additional peak elimination algorithm" },
+        { "-gc",  "--gain-curve",           false,     "Evaluation of the compressor curve (exact, table, exact by default)"                    },
+        { "-id",  "--in-dir",               false,     "The path to the directory with input files for batch processing"                       },
         { "-if",  "--in-file",              false,     "The path to the input file"                                                             },
+        { "-j",   "--jobs",                 false,     "Number of files in batch mode or variants of parameter sweep processed simultaneously (0 for the number of CPU cores, 1 by default)" },
         { "-k",   "--knee",                 false,     "Knee of the compressor (in dB, 3 dB by default)"                                        },
+        { "-lv",  "--live",                 true,      "Process raw 32-bit float interleaved samples from standard input to standard output with low latency" },
         { "-n",   "--normalize",            false,     "Set normalization mode (none, above, below, always, none by default)"                   },
         { "-ng",  "--norm-gain",            false,     "Set normalization peak gain (in dB, 0 dB by default)"                                   },
         { "-np",  "--num-passes",           false,     "Number of passes, 1 by default"                                                         },
+        { "-od",  "--out-dir",              false,     "The path to the output directory for batch processing"                                  },
         { "-of",  "--out-file",             false,     "The path to the output file"                                                            },
+        { "-on",  "--out-name",             false,     "Output file name template for batch processing, {name} is the input file name without extension, {name}.wav by default" },
         { "-pt",  "--peak-threshold",       false,     "The threshold of peaks above the median peak value to elminate (in dB, 1 dB by default)"},
         { "-r",   "--reactivity",           false,     "Reactivity of the compressor (in ms, 40 ms by default)"                                 },
+        { "-rq",  "--resample-quality",     false,     "Quality of the sample rate conversion (fast, normal, best, normal by default)"         },
+        { "-sd",  "--scan-decimation",      false,     "Decimation factor of the coarse pre-scan of the long-time RMS (1 by default for the exact estimation)" },
+        { "-sm",  "--streaming",            true,      "Process the file block by block without loading it into memory"                         },
         { "-sr",  "--srate",                false,     "Sample rate of output (processed) file, optional"                                       },
+        { "-st",  "--stats",                false,     "Write process-wide timing and memory statistics of processing stages in JSON format to the file" },
+        { "-sw",  "--sweep",                false,     "The path to the sweep file with the list of output files and dynamics parameters for the single input file" },
+        { "-th",  "--threads",              false,     "Number of threads to process channels and segments of long channels (0 for the number of CPU cores, 1 by default)"    },
         { "-wf",  "--weighting",            false,     "Frequency weighting function (none, a, b, c, d, k, none by default)"                    },
 
         { NULL, NULL, false, NULL }
@@ -85,6 +104,29 @@ namespace spike_bender
         { NULL,     0           }
     };
 
+    const cfg_flag_t resample_flags[] =
+    {
+        { "fast",   RESAMPLE_FAST   },
+        { "normal", RESAMPLE_NORMAL },
+        { "best",   RESAMPLE_BEST   },
+        { NULL,     0               }
+    };
+
+    const cfg_flag_t control_flags[] =
+    {
+        { "f32",    CONTROL_F32     },
+        { "f16",    CONTROL_F16     },
+        { "log16",  CONTROL_LOG16   },
+        { NULL,     0               }
+    };
+
+    const cfg_flag_t curve_flags[] =
+    {
+        { "exact",  GAIN_CURVE_EXACT    },
+        { "table",  GAIN_CURVE_TABLE    },
+        { NULL,     0                   }
+    };
+
     status_t print_usage(const char *name, bool fail)
     {
         LSPString buf, fmt;
@@ -242,6 +284,11 @@ namespace spike_bender
         return STATUS_INVALID_VALUE;
     }
 
+    status_t parse_cmdline_normalize(normalize_t *dst, const char *val, const char *parameter)
+    {
+        return parse_cmdline_enum(dst, val, parameter, normalize_flags);
+    }
+
     status_t parse_cmdline(config_t *cfg, int argc, const char **argv)
     {
         status_t res;
@@ -310,21 +357,113 @@ namespace spike_bender
             }
         }
 
-        // Mandatory parameters
-        if ((val = options.get("--in-file")) != NULL)
-            cfg->sInFile.set_native(val);
-        else
+        // Batch processing parameters
+        if ((val = options.get("--batch-file")) != NULL)
+            cfg->sBatchFile.set_native(val);
+        if ((val = options.get("--in-dir")) != NULL)
+            cfg->sInDir.set_native(val);
+        if ((val = options.get("--out-dir")) != NULL)
+            cfg->sOutDir.set_native(val);
+        if ((val = options.get("--out-name")) != NULL)
+            cfg->sOutName.set_native(val);
+        if ((val = options.get("--stats")) != NULL)
+            cfg->sStatsFile.set_native(val);
+        if ((val = options.get("--analysis-cache")) != NULL)
+            cfg->sCacheDir.set_native(val);
+        if ((val = options.get("--sweep")) != NULL)
+            cfg->sSweepFile.set_native(val);
+        if ((val = options.get("--jobs")) != NULL)
         {
-            fprintf(stderr, "Input file name required\n");
-            return STATUS_BAD_ARGUMENTS;
+            if ((res = parse_cmdline_int(&cfg->nJobs, val, "number of jobs")) != STATUS_OK)
+                return res;
+            if (cfg->nJobs < 0)
+            {
+                fprintf(stderr, "Invalid number of jobs, should be non-negative\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
         }
 
-        if ((val = options.get("--out-file")) != NULL)
-            cfg->sOutFile.set_native(val);
+        if (options.contains("--live"))
+            cfg->bLive              = true;
+
+        if (cfg->is_batch())
+        {
+            if (cfg->bLive)
+            {
+                fprintf(stderr, "Live mode can not be used for batch processing\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if (cfg->is_sweep())
+            {
+                fprintf(stderr, "Parameter sweep can not be used for batch processing\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if ((!cfg->sBatchFile.is_empty()) && (!cfg->sInDir.is_empty()))
+            {
+                fprintf(stderr, "Batch file and input directory can not be specified simultaneously\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if ((options.contains("--in-file")) || (options.contains("--out-file")))
+            {
+                fprintf(stderr, "Input and output files can not be specified in batch mode\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if ((!cfg->sInDir.is_empty()) && (cfg->sOutDir.is_empty()))
+            {
+                fprintf(stderr, "Output directory required\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
+        else if (cfg->bLive)
+        {
+            if ((options.contains("--in-file")) || (options.contains("--out-file")))
+            {
+                fprintf(stderr, "Input and output files can not be specified in live mode\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if (options.contains("--streaming"))
+            {
+                fprintf(stderr, "Streaming mode can not be used in live mode\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if (!cfg->sCacheDir.is_empty())
+            {
+                fprintf(stderr, "Analysis cache can not be used in live mode\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if (cfg->is_sweep())
+            {
+                fprintf(stderr, "Parameter sweep can not be used in live mode\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
         else
         {
-            fprintf(stderr, "Output file name required\n");
-            return STATUS_BAD_ARGUMENTS;
+            // Mandatory parameters
+            if ((val = options.get("--in-file")) != NULL)
+                cfg->sInFile.set_native(val);
+            else
+            {
+                fprintf(stderr, "Input file name required\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+
+            // Output files of the parameter sweep are listed in the sweep file
+            if (cfg->is_sweep())
+            {
+                if (options.contains("--out-file"))
+                {
+                    fprintf(stderr, "Output file can not be specified for parameter sweep\n");
+                    return STATUS_BAD_ARGUMENTS;
+                }
+            }
+            else if ((val = options.get("--out-file")) != NULL)
+                cfg->sOutFile.set_native(val);
+            else
+            {
+                fprintf(stderr, "Output file name required\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
         }
 
         // Parse other parameters
@@ -363,6 +502,36 @@ namespace spike_bender
                 return STATUS_BAD_ARGUMENTS;
             }
         }
+        if ((val = options.get("--decimation")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nDecimation, val, "decimation")) != STATUS_OK)
+                return res;
+            if (cfg->nDecimation <= 0)
+            {
+                fprintf(stderr, "Invalid decimation factor, should be positive\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
+        if ((val = options.get("--scan-decimation")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nScanDecimation, val, "scan decimation")) != STATUS_OK)
+                return res;
+            if (cfg->nScanDecimation <= 0)
+            {
+                fprintf(stderr, "Invalid scan decimation factor, should be positive\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
+        if ((val = options.get("--control-format")) != NULL)
+        {
+            if ((res = parse_cmdline_enum(&cfg->enControlFormat, val, "control format", control_flags)) != STATUS_OK)
+                return res;
+        }
+        if ((val = options.get("--gain-curve")) != NULL)
+        {
+            if ((res = parse_cmdline_enum(&cfg->enGainCurve, val, "gain curve", curve_flags)) != STATUS_OK)
+                return res;
+        }
         if ((val = options.get("--reactivity")) != NULL)
         {
             if ((res = parse_cmdline_float(&cfg->fReactivity, val, "reactivity")) != STATUS_OK)
@@ -383,6 +552,11 @@ namespace spike_bender
             if ((res = parse_cmdline_enum(&cfg->enNormalize, val, "normalize", normalize_flags)) != STATUS_OK)
                 return res;
         }
+        if ((val = options.get("--resample-quality")) != NULL)
+        {
+            if ((res = parse_cmdline_enum(&cfg->enResample, val, "resample quality", resample_flags)) != STATUS_OK)
+                return res;
+        }
         if ((val = options.get("--norm-gain")) != NULL)
         {
             if ((res = parse_cmdline_float(&cfg->fNormGain, val, "norm-gain")) != STATUS_OK)
@@ -398,6 +572,52 @@ namespace spike_bender
                 return res;
             cfg->fPeakThresh  = dspu::db_to_gain(cfg->fPeakThresh);
         }
+        if (options.contains("--streaming"))
+        {
+            cfg->bStreaming         = true;
+            if (!cfg->sCacheDir.is_empty())
+            {
+                fprintf(stderr, "Analysis cache can not be used in streaming mode\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+            if (cfg->is_sweep())
+            {
+                fprintf(stderr, "Parameter sweep can not be used in streaming mode\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
+        if ((val = options.get("--block-size")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nBlockSize, val, "block size")) != STATUS_OK)
+                return res;
+            if (cfg->nBlockSize <= 0)
+            {
+                fprintf(stderr, "Invalid block size, should be positive\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
+        else if (cfg->bLive)
+            cfg->nBlockSize         = LIVE_BLOCK_SIZE;
+        if ((val = options.get("--channels")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nChannels, val, "number of channels")) != STATUS_OK)
+                return res;
+            if (cfg->nChannels <= 0)
+            {
+                fprintf(stderr, "Invalid number of channels, should be positive\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
+        if ((val = options.get("--threads")) != NULL)
+        {
+            if ((res = parse_cmdline_int(&cfg->nThreads, val, "number of threads")) != STATUS_OK)
+                return res;
+            if (cfg->nThreads < 0)
+            {
+                fprintf(stderr, "Invalid number of threads, should be non-negative\n");
+                return STATUS_BAD_ARGUMENTS;
+            }
+        }
 
         return STATUS_OK;
     }
@@ -28,15 +28,26 @@ namespace spike_bender
     config_t::config_t()
     {
         nSampleRate         = -1;
+        enResample          = RESAMPLE_NORMAL;
         nPasses             = 1;
         fReactivity         = 40.0f;
         fRange              = 6.0f;
         fKnee               = 3.0f;
+        nDecimation         = 1;
+        enControlFormat     = CONTROL_F32;
+        nScanDecimation     = 1;
+        enGainCurve         = GAIN_CURVE_EXACT;
         enWeighting         = NO_WEIGHT;
         enNormalize         = NORM_NONE;
         fNormGain           = 0.0f;
         fPeakThresh         = dspu::db_to_gain(1.0f);
         bEliminatePeaks     = true;
+        bStreaming          = false;
+        nBlockSize          = 0x10000;
+        nThreads            = 1;
+        bLive               = false;
+        nChannels           = 2;
+        nJobs               = 1;
     }
 
     config_t::~config_t()
@@ -47,18 +58,45 @@ namespace spike_bender
     void config_t::clear()
     {
         nSampleRate         = -1;
+        enResample          = RESAMPLE_NORMAL;
         nPasses             = 1;
         fReactivity         = 40.0f;
         fRange              = 6.0f;
         fKnee               = 3.0f;
+        nDecimation         = 1;
+        enControlFormat     = CONTROL_F32;
+        nScanDecimation     = 1;
+        enGainCurve         = GAIN_CURVE_EXACT;
         enWeighting         = NO_WEIGHT;
         enNormalize         = NORM_NONE;
         fNormGain           = 0.0f;
         fPeakThresh         = dspu::db_to_gain(1.0f);
         bEliminatePeaks     = true;
+        bStreaming          = false;
+        nBlockSize          = 0x10000;
+        nThreads            = 1;
+        bLive               = false;
+        nChannels           = 2;
+        nJobs               = 1;
 
         sInFile.clear();
         sOutFile.clear();
+        sBatchFile.clear();
+        sInDir.clear();
+        sOutDir.clear();
+        sOutName.clear();
+        sStatsFile.clear();
+        sCacheDir.clear();
+        sSweepFile.clear();
+    }
+
+    void config_t::get_dynamics(dynamics_t *dst) const
+    {
+        dst->nPasses        = nPasses;
+        dst->fRange         = fRange;
+        dst->fKnee          = fKnee;
+        dst->fPeakThresh    = fPeakThresh;
+        dst->enNormalize    = enNormalize;
     }
 
 
@@ -0,0 +1,217 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/control.h>
+
+namespace spike_bender
+{
+    static constexpr uint32_t LOG16_SHIFT       = 23 - 11;
+    static constexpr uint32_t LOG16_LOW         = uint32_t(CONTROL_LOG16_MIN_EXP + 127) << 23;
+    static constexpr uint32_t LOG16_HIGH        = LOG16_LOW + (uint32_t(0xffff) << LOG16_SHIFT);
+
+    static inline uint32_t float_bits(float v)
+    {
+        uint32_t x;
+        memcpy(&x, &v, sizeof(float));
+        return x;
+    }
+
+    static inline float bits_float(uint32_t x)
+    {
+        float v;
+        memcpy(&v, &x, sizeof(float));
+        return v;
+    }
+
+    static inline uint32_t select(bool cond, uint32_t a, uint32_t b)
+    {
+        // The mask keeps the loop free of branches, so it can be vectorized
+        uint32_t m          = -uint32_t(cond);
+        return (a & m) | (b & ~m);
+    }
+
+    void encode_f16(uint16_t *dst, const float *src, size_t count)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            uint32_t x          = float_bits(src[i]);
+            uint32_t a          = x & 0x7fffffff;
+            uint32_t sign       = (x >> 16) & 0x8000;
+
+            // Normal values: rebias the exponent and round the mantissa to nearest even
+            uint32_t n          = (a + 0xc8000fff + ((a >> 13) & 1)) >> 13;
+            // Subnormal values: the addition aligns the mantissa at the required position
+            uint32_t s          = float_bits(bits_float(a) + 0.5f) - 0x3f000000;
+            // Overflow saturates to infinity, NaN is kept
+            uint32_t o          = select(a > 0x7f800000, 0x7e00, 0x7c00);
+
+            uint32_t h          = select(a < 0x38800000, s, n);
+            h                   = select(a >= 0x47800000, o, h);
+            dst[i]              = uint16_t(h | sign);
+        }
+    }
+
+    void decode_f16(float *dst, const uint16_t *src, size_t count)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            uint32_t h          = src[i];
+            uint32_t o          = (h & 0x7fff) << 13;
+            uint32_t e          = o & 0x0f800000;
+
+            // Rebias the exponent, the infinity and NaN get the maximum exponent,
+            // subnormal values are normalized by the subtraction
+            uint32_t n          = o + 0x38000000;
+            uint32_t inf        = n + 0x38000000;
+            uint32_t s          = float_bits(bits_float(o + 0x38800000) - bits_float(0x38800000));
+
+            uint32_t x          = select(e == 0x0f800000, inf, n);
+            x                   = select(e == 0, s, x);
+            dst[i]              = bits_float(x | ((h & 0x8000) << 16));
+        }
+    }
+
+    void encode_log16(uint16_t *dst, const float *src, size_t count)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            // The float representation is the piecewise-linear logarithm of the value,
+            // the code is rounded to the nearest one, negative values become zero
+            uint32_t x          = float_bits(lsp_max(src[i], 0.0f));
+            x                   = lsp_min(x, LOG16_HIGH);
+            uint32_t c          = (x - LOG16_LOW + (uint32_t(1) << (LOG16_SHIFT - 1))) >> LOG16_SHIFT;
+            dst[i]              = uint16_t(select(x > LOG16_LOW, c, 0));
+        }
+    }
+
+    void decode_log16(float *dst, const uint16_t *src, size_t count)
+    {
+        for (size_t i=0; i<count; ++i)
+        {
+            uint32_t c          = src[i];
+            uint32_t x          = LOG16_LOW + (c << LOG16_SHIFT);
+            dst[i]              = bits_float(select(c > 0, x, 0));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // ControlBuffer
+    ControlBuffer::ControlBuffer()
+    {
+        vData       = NULL;
+        nChannels   = 0;
+        nLength     = 0;
+        nSampleRate = 0;
+        enFormat    = CONTROL_F32;
+    }
+
+    ControlBuffer::~ControlBuffer()
+    {
+        destroy();
+    }
+
+    status_t ControlBuffer::init(size_t channels, size_t length, control_format_t format)
+    {
+        destroy();
+
+        enFormat    = format;
+        size_t size = lsp_max(channels * length * value_size(), size_t(1));
+        vData       = new uint8_t[size];
+        if (vData == NULL)
+            return STATUS_NO_MEM;
+
+        nChannels   = channels;
+        nLength     = length;
+
+        return STATUS_OK;
+    }
+
+    void ControlBuffer::destroy()
+    {
+        if (vData != NULL)
+        {
+            delete [] vData;
+            vData       = NULL;
+        }
+        nChannels   = 0;
+        nLength     = 0;
+    }
+
+    void ControlBuffer::swap(ControlBuffer *dst)
+    {
+        lsp::swap(vData, dst->vData);
+        lsp::swap(nChannels, dst->nChannels);
+        lsp::swap(nLength, dst->nLength);
+        lsp::swap(nSampleRate, dst->nSampleRate);
+        lsp::swap(enFormat, dst->enFormat);
+    }
+
+    void ControlBuffer::store(size_t channel, size_t offset, const float *src, size_t count)
+    {
+        uint8_t *p      = data(channel, offset);
+        switch (enFormat)
+        {
+            case CONTROL_F16:
+                encode_f16(reinterpret_cast<uint16_t *>(p), src, count);
+                break;
+            case CONTROL_LOG16:
+                encode_log16(reinterpret_cast<uint16_t *>(p), src, count);
+                break;
+            default:
+                dsp::copy(reinterpret_cast<float *>(p), src, count);
+                break;
+        }
+    }
+
+    void ControlBuffer::fill(size_t channel, size_t offset, float value, size_t count)
+    {
+        float buf[CONTROL_BLOCK_SIZE];
+        dsp::fill(buf, value, lsp_min(count, CONTROL_BLOCK_SIZE));
+
+        for (size_t n; count > 0; count -= n, offset += n)
+        {
+            n               = lsp_min(count, CONTROL_BLOCK_SIZE);
+            store(channel, offset, buf, n);
+        }
+    }
+
+    void ControlBuffer::load(float *dst, size_t channel, size_t offset, size_t count) const
+    {
+        const uint8_t *p    = data(channel, offset);
+        switch (enFormat)
+        {
+            case CONTROL_F16:
+                decode_f16(dst, reinterpret_cast<const uint16_t *>(p), count);
+                break;
+            case CONTROL_LOG16:
+                decode_log16(dst, reinterpret_cast<const uint16_t *>(p), count);
+                break;
+            default:
+                dsp::copy(dst, reinterpret_cast<const float *>(p), count);
+                break;
+        }
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,262 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/dynamics/DynamicProcessor.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/audio.h>
+#include <private/gain.h>
+#include <private/window.h>
+
+namespace spike_bender
+{
+    static constexpr size_t GAIN_TABLE_SHIFT    = 23 - GAIN_TABLE_BITS;
+    static constexpr size_t GAIN_TABLE_SIZE     = size_t(GAIN_TABLE_MAX_EXP - GAIN_TABLE_MIN_EXP) << GAIN_TABLE_BITS;
+    static constexpr uint32_t GAIN_TABLE_LOW    = uint32_t(GAIN_TABLE_MIN_EXP + 127) << 23;
+    static constexpr uint32_t GAIN_TABLE_HIGH   = (uint32_t(GAIN_TABLE_MAX_EXP + 127) << 23) - 1;
+    static constexpr uint32_t GAIN_TABLE_MASK   = (uint32_t(1) << GAIN_TABLE_SHIFT) - 1;
+    static constexpr float GAIN_TABLE_KFRAC     = 1.0f / float(uint32_t(1) << GAIN_TABLE_SHIFT);
+
+    static inline float reaction_tau(size_t sample_rate, float time)
+    {
+        // The envelope reaches 1 - 1/sqrt(2) of the change after the reaction time,
+        // the same as the reaction of the dynamic processor, zero time gives the immediate reaction
+        float samples       = dspu::millis_to_samples(sample_rate, time);
+        return 1.0f - expf(logf(1.0f - M_SQRT1_2) / samples);
+    }
+
+    GainComputer::GainComputer()
+    {
+        vTable      = NULL;
+        for (size_t i=0; i<4; ++i)
+            vTau[i]     = 1.0f;
+        fEnvelope   = 0.0f;
+        fThresh     = 1.0f;
+        fKThresh    = 1.0f;
+        fLevel      = 0.0f;
+        fRange      = 0.0f;
+        fKnee       = 0.0f;
+        fTableRange = 0.0f;
+        fTableKnee  = 0.0f;
+        nSampleRate = 0;
+        enCurve     = GAIN_CURVE_EXACT;
+    }
+
+    GainComputer::~GainComputer()
+    {
+        destroy();
+    }
+
+    status_t GainComputer::init_table(size_t sample_rate, float range_db, float knee_db)
+    {
+        // The table depends only on the shape of the curve
+        if ((vTable != NULL) && (fTableRange == range_db) && (fTableKnee == knee_db))
+            return STATUS_OK;
+
+        if (vTable == NULL)
+        {
+            vTable      = new float[GAIN_TABLE_SIZE + 1];
+            if (vTable == NULL)
+                return STATUS_NO_MEM;
+        }
+
+        float *in       = new float[GAIN_TABLE_SIZE + 1];
+        if (in == NULL)
+            return STATUS_NO_MEM;
+        lsp_finally { delete [] in; };
+
+        // Entries follow with the same step of the float representation
+        for (size_t i=0; i<=GAIN_TABLE_SIZE; ++i)
+        {
+            uint32_t v          = GAIN_TABLE_LOW + (uint32_t(i) << GAIN_TABLE_SHIFT);
+            memcpy(&in[i], &v, sizeof(float));
+        }
+
+        // Sample the curve of the dynamic processor for the unit threshold
+        dspu::DynamicProcessor dp;
+        dp.construct();
+        configure_dynamics(&dp, sample_rate, 1.0f, range_db, knee_db);
+        dp.curve(vTable, in, GAIN_TABLE_SIZE + 1);
+        dp.destroy();
+
+        for (size_t i=0; i<=GAIN_TABLE_SIZE; ++i)
+            vTable[i]          /= in[i];
+
+        fTableRange     = range_db;
+        fTableKnee      = knee_db;
+
+        return STATUS_OK;
+    }
+
+    status_t GainComputer::init(size_t sample_rate, float thresh, float range_db, float knee_db, gain_curve_t curve)
+    {
+        status_t res;
+        if (sample_rate <= 0)
+            return STATUS_BAD_ARGUMENTS;
+
+        if (curve == GAIN_CURVE_TABLE)
+        {
+            if ((res = init_table(sample_rate, range_db, knee_db)) != STATUS_OK)
+                return res;
+        }
+        else
+        {
+            // The processor does not provide the method to reset the envelope,
+            // so it is re-constructed, the configuration is set by set_threshold()
+            sProc.destroy();
+            sProc.construct();
+        }
+
+        // The attack below the reaction level is immediate
+        vTau[0]     = reaction_tau(sample_rate, GAIN_RELEASE_LOW_TIME);
+        vTau[1]     = reaction_tau(sample_rate, GAIN_RELEASE_TIME);
+        vTau[2]     = 1.0f;
+        vTau[3]     = reaction_tau(sample_rate, GAIN_ATTACK_TIME);
+
+        nSampleRate = sample_rate;
+        fRange      = range_db;
+        fKnee       = knee_db;
+        fEnvelope   = 0.0f;
+        enCurve     = curve;
+        set_threshold(thresh);
+
+        return STATUS_OK;
+    }
+
+    void GainComputer::destroy()
+    {
+        sProc.destroy();
+        if (vTable != NULL)
+        {
+            delete [] vTable;
+            vTable      = NULL;
+        }
+    }
+
+    void GainComputer::set_threshold(float thresh)
+    {
+        fThresh     = thresh;
+        fKThresh    = (thresh > 0.0f) ? 1.0f / thresh : 1.0f;
+        fLevel      = thresh * dspu::db_to_gain(GAIN_REACTION_LEVEL);
+
+        // The settings of the dynamic processor are updated without resetting the envelope
+        if (enCurve == GAIN_CURVE_EXACT)
+            configure_dynamics(&sProc, nSampleRate, thresh, fRange, fKnee);
+    }
+
+    template <size_t L>
+    void GainComputer::follow_envelopes(GainComputer * const *gc, float * const *dst, const float * const *src, size_t count)
+    {
+        // The reaction is selected by the direction and the level, the reactions are kept
+        // in registers so the selection compiles to conditional moves
+        float r_low[L], r_high[L], a_low[L], a_high[L], level[L], e[L];
+        float *d[L];
+        const float *s[L];
+        for (size_t l=0; l<L; ++l)
+        {
+            const GainComputer *c   = gc[l];
+            r_low[l]            = c->vTau[0];
+            r_high[l]           = c->vTau[1];
+            a_low[l]            = c->vTau[2];
+            a_high[l]           = c->vTau[3];
+            level[l]            = c->fLevel;
+            e[l]                = c->fEnvelope;
+            d[l]                = dst[l];
+            s[l]                = src[l];
+        }
+
+        for (size_t i=0; i<count; ++i)
+        {
+            for (size_t l=0; l<L; ++l)
+            {
+                float x             = s[l][i];
+                bool high           = e[l] >= level[l];
+                float tau           = (x > e[l]) ? ((high) ? a_high[l] : a_low[l]) : ((high) ? r_high[l] : r_low[l]);
+                e[l]               += (x - e[l]) * tau;
+                d[l][i]             = e[l];
+            }
+        }
+
+        for (size_t l=0; l<L; ++l)
+            gc[l]->fEnvelope    = e[l];
+    }
+
+    void GainComputer::lookup(float *dst, size_t count)
+    {
+        // Look up the gain: the exponent and the upper mantissa bits of the envelope
+        // form the index, the rest of mantissa bits is the interpolation factor
+        const float *table  = vTable;
+        const float kthresh = fKThresh;
+        for (size_t i=0; i<count; ++i)
+        {
+            float x             = lsp_max(dst[i] * kthresh, 0.0f);
+            uint32_t v;
+            memcpy(&v, &x, sizeof(float));
+            v                   = lsp_limit(v, GAIN_TABLE_LOW, GAIN_TABLE_HIGH) - GAIN_TABLE_LOW;
+
+            const float *g      = &table[v >> GAIN_TABLE_SHIFT];
+            float k             = float(v & GAIN_TABLE_MASK) * GAIN_TABLE_KFRAC;
+            dst[i]              = g[0] + (g[1] - g[0]) * k;
+        }
+    }
+
+    void GainComputer::process(float *dst, const float *src, size_t count)
+    {
+        if (enCurve == GAIN_CURVE_EXACT)
+        {
+            sProc.process(dst, NULL, src, count);
+            return;
+        }
+
+        GainComputer *self  = this;
+        follow_envelopes<1>(&self, &dst, &src, count);
+        lookup(dst, count);
+    }
+
+    void GainComputer::process(GainComputer * const *gc, float * const *dst,
+        const float * const *src, size_t lanes, size_t count)
+    {
+        if ((lanes > 0) && (gc[0]->enCurve == GAIN_CURVE_EXACT))
+        {
+            for (size_t l=0; l<lanes; ++l)
+                gc[l]->sProc.process(dst[l], NULL, src[l], count);
+            return;
+        }
+
+        for (size_t l=0, k; l<lanes; l += k)
+        {
+            k                   = lockstep_width(lanes - l);
+            if (k == 4)
+                follow_envelopes<4>(&gc[l], &dst[l], &src[l], count);
+            else if (k == 2)
+                follow_envelopes<2>(&gc[l], &dst[l], &src[l], count);
+            else
+                follow_envelopes<1>(&gc[l], &dst[l], &src[l], count);
+        }
+
+        for (size_t l=0; l<lanes; ++l)
+            gc[l]->lookup(dst[l], count);
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#include <private/live.h>
+#include <private/processor.h>
+
+#if defined(PLATFORM_WINDOWS)
+    #include <fcntl.h>
+    #include <io.h>
+#endif /* PLATFORM_WINDOWS */
+
+namespace spike_bender
+{
+    typedef struct live_t
+    {
+        float                  *vFrames;        // Interleaved data
+        float                  *vBuffers;       // Buffers for channels
+        float                 **vChannels;      // Pointers to buffers of channels
+        size_t                  nChannels;      // Number of channels
+        size_t                  nBlockSize;     // Block size
+    } live_t;
+
+    static void destroy_live(live_t *l)
+    {
+        if (l->vFrames != NULL)
+        {
+            delete [] l->vFrames;
+            l->vFrames      = NULL;
+        }
+        if (l->vBuffers != NULL)
+        {
+            delete [] l->vBuffers;
+            l->vBuffers     = NULL;
+        }
+        if (l->vChannels != NULL)
+        {
+            delete [] l->vChannels;
+            l->vChannels    = NULL;
+        }
+    }
+
+    static status_t write_frames(live_t *l, size_t count)
+    {
+        // Interleave the data
+        for (size_t i=0; i<l->nChannels; ++i)
+        {
+            const float *src    = l->vChannels[i];
+            float *dst          = &l->vFrames[i];
+            for (size_t j=0; j<count; ++j, dst += l->nChannels)
+                *dst                = src[j];
+        }
+
+        // Write the data and pass it further immediately
+        if (fwrite(l->vFrames, sizeof(float) * l->nChannels, count, stdout) != count)
+        {
+            fprintf(stderr, "  could not write to the standard output\n");
+            return STATUS_IO_ERROR;
+        }
+        fflush(stdout);
+
+        return STATUS_OK;
+    }
+
+    status_t process_live(const config_t *cfg, Stats *stats)
+    {
+        status_t res;
+        live_t l;
+        Processor p;
+        probe_t pr;
+        wsize_t samples = 0;
+
+        l.nChannels     = cfg->nChannels;
+        l.nBlockSize    = cfg->nBlockSize;
+        l.vFrames       = new float[l.nBlockSize * l.nChannels];
+        l.vBuffers      = new float[l.nBlockSize * l.nChannels];
+        l.vChannels     = new float *[l.nChannels];
+        lsp_finally { destroy_live(&l); };
+        if ((l.vFrames == NULL) || (l.vBuffers == NULL) || (l.vChannels == NULL))
+        {
+            fprintf(stderr, "  not enough memory\n");
+            return STATUS_NO_MEM;
+        }
+        for (size_t i=0; i<l.nChannels; ++i)
+            l.vChannels[i]  = &l.vBuffers[i * l.nBlockSize];
+
+        size_t srate    = (cfg->nSampleRate > 0) ? cfg->nSampleRate : LIVE_SAMPLE_RATE;
+        if ((res = p.init(cfg, l.nChannels, srate)) != STATUS_OK)
+        {
+            fprintf(stderr, "  could not initialize the processor, error code: %d\n", int(res));
+            return res;
+        }
+
+        // The standard output carries the data, so all messages go to the standard error
+        const size_t latency    = p.latency() + l.nBlockSize;
+        fprintf(stderr, "  live stream: channels: %d, sample rate: %d, block size: %d, latency: %d samples\n",
+            int(l.nChannels), int(srate), int(l.nBlockSize), int(latency));
+        if (latency * 1000 > LIVE_LATENCY_MAX * srate)
+            fprintf(stderr, "  warning: latency %.1f ms exceeds %d ms, decrease the block size, reactivity or number of passes\n",
+                latency * 1000.0 / srate, int(LIVE_LATENCY_MAX));
+
+    #if defined(PLATFORM_WINDOWS)
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+    #endif /* PLATFORM_WINDOWS */
+
+        Stats::start(&pr);
+        while (true)
+        {
+            // Read the block of data
+            size_t count    = fread(l.vFrames, sizeof(float) * l.nChannels, l.nBlockSize, stdin);
+            if (count <= 0)
+            {
+                if (ferror(stdin))
+                {
+                    fprintf(stderr, "  could not read from the standard input\n");
+                    return STATUS_IO_ERROR;
+                }
+                break;
+            }
+            samples        += count * l.nChannels;
+
+            // De-interleave the data
+            for (size_t i=0; i<l.nChannels; ++i)
+            {
+                const float *src    = &l.vFrames[i];
+                float *dst          = l.vChannels[i];
+                for (size_t j=0; j<count; ++j, src += l.nChannels)
+                    dst[j]              = *src;
+            }
+
+            // Process the data in place
+            if ((res = p.process(l.vChannels, l.vChannels, count, &count)) != STATUS_OK)
+            {
+                fprintf(stderr, "Error adjusting gain, code=%d\n", int(res));
+                return res;
+            }
+            if ((res = write_frames(&l, count)) != STATUS_OK)
+                return res;
+        }
+
+        // Flush the latency tail at the end of the stream
+        for (size_t count = l.nBlockSize; count >= l.nBlockSize; )
+        {
+            if ((res = p.flush(l.vChannels, l.nBlockSize, &count)) != STATUS_OK)
+            {
+                fprintf(stderr, "Error adjusting gain, code=%d\n", int(res));
+                return res;
+            }
+            if ((res = write_frames(&l, count)) != STATUS_OK)
+                return res;
+        }
+
+        if (stats != NULL)
+            return stats->commit(&pr, "live", -1, samples);
+
+        return STATUS_OK;
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,242 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/peaks.h>
+
+namespace spike_bender
+{
+    PeakDetector::PeakDetector()
+    {
+        vFlags      = NULL;
+        sPos.index  = 0;
+        sPos.gain   = -1.0f;
+        sNeg.index  = 0;
+        sNeg.gain   = 1.0f;
+        nStep       = 1;
+        nBoundary   = 1;
+        nOffset     = 0;
+        fPrev       = 0.0f;
+        fCurr       = 0.0f;
+        bPending    = false;
+    }
+
+    PeakDetector::~PeakDetector()
+    {
+        destroy();
+    }
+
+    status_t PeakDetector::init(size_t step)
+    {
+        if (vFlags == NULL)
+        {
+            vFlags      = new uint8_t[PEAK_BLOCK_SIZE];
+            if (vFlags == NULL)
+                return STATUS_NO_MEM;
+        }
+
+        sPos.index  = 0;
+        sPos.gain   = -1.0f;
+        sNeg.index  = 0;
+        sNeg.gain   = 1.0f;
+        nStep       = lsp_max(step, size_t(1));
+        nBoundary   = nStep;
+        nOffset     = 0;
+        fPrev       = 0.0f;
+        fCurr       = 0.0f;
+        bPending    = false;
+
+        return STATUS_OK;
+    }
+
+    void PeakDetector::seek(size_t offset, float prev)
+    {
+        nBoundary   = (offset / nStep + 1) * nStep;
+        nOffset     = offset;
+        fPrev       = 0.0f;
+        fCurr       = prev;
+        bPending    = false;
+    }
+
+    void PeakDetector::destroy()
+    {
+        if (vFlags != NULL)
+        {
+            delete [] vFlags;
+            vFlags      = NULL;
+        }
+    }
+
+    bool PeakDetector::commit(lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg)
+    {
+        if ((pos != NULL) && (sPos.gain >= 0.0f))
+        {
+            if (!pos->append(&sPos))
+                return false;
+        }
+        if ((neg != NULL) && (sNeg.gain <= 0.0f))
+        {
+            if (!neg->append(&sNeg))
+                return false;
+        }
+
+        sPos.index  = 0;
+        sPos.gain   = -1.0f;
+        sNeg.index  = 0;
+        sNeg.gain   = 1.0f;
+
+        return true;
+    }
+
+    bool PeakDetector::add(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+        size_t index, float value)
+    {
+        // Commit the quantized peaks if the extremum belongs to another step
+        if (index >= nBoundary)
+        {
+            if (!commit(pos, neg))
+                return false;
+            nBoundary   = (index / nStep + 1) * nStep;
+        }
+
+        peak_t pk;
+        pk.index    = index;
+        pk.gain     = value;
+        if ((peaks != NULL) && (!peaks->add(&pk)))
+            return false;
+
+        if (value > 0.0f)
+        {
+            if (sPos.gain < value)
+                sPos        = pk;
+        }
+        else if (sNeg.gain > value)
+            sNeg        = pk;
+
+        return true;
+    }
+
+    status_t PeakDetector::process(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+        const float *src, size_t count)
+    {
+        for (size_t n; count > 0; count -= n, src += n)
+        {
+            n                   = lsp_min(count, PEAK_BLOCK_SIZE);
+
+            // Examine the last sample of the previous block
+            if (!examine(peaks, pos, neg, src[0]))
+                return STATUS_NO_MEM;
+
+            // Mark extremums of the block except the last sample, the loop has no branches
+            size_t m            = n - 1;
+            if (m > 0)
+            {
+                float s             = src[0];
+                float dp            = s - fCurr;
+                float dn            = src[1] - s;
+                vFlags[0]           =
+                    uint8_t((dn < 0.0f) & (dp >= 0.0f) & (s > 0.0f)) |
+                    uint8_t((dn > 0.0f) & (dp <= 0.0f) & (s < 0.0f));
+            }
+            for (size_t j=1; j<m; ++j)
+            {
+                float s             = src[j];
+                float dp            = s - src[j-1];
+                float dn            = src[j+1] - s;
+                vFlags[j]           =
+                    uint8_t((dn < 0.0f) & (dp >= 0.0f) & (s > 0.0f)) |
+                    uint8_t((dn > 0.0f) & (dp <= 0.0f) & (s < 0.0f));
+            }
+
+            // Scan the marks, skip words without extremums
+            for (size_t j=0; j<m; )
+            {
+                if ((j + sizeof(uint64_t)) <= m)
+                {
+                    uint64_t w;
+                    memcpy(&w, &vFlags[j], sizeof(uint64_t));
+                    if (w == 0)
+                    {
+                        j                  += sizeof(uint64_t);
+                        continue;
+                    }
+                }
+
+                if ((vFlags[j]) && (!add(peaks, pos, neg, nOffset + j, src[j])))
+                    return STATUS_NO_MEM;
+                ++j;
+            }
+
+            fPrev               = (m > 0) ? src[m - 1] : fCurr;
+            fCurr               = src[m];
+            nOffset            += n;
+            bPending            = true;
+        }
+
+        return STATUS_OK;
+    }
+
+    bool PeakDetector::examine(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+        float next)
+    {
+        if (!bPending)
+            return true;
+
+        float s             = fCurr;
+        float dp            = s - fPrev;
+        float dn            = next - s;
+        bool found          =
+            ((dn < 0.0f) && (dp >= 0.0f) && (s > 0.0f)) ||
+            ((dn > 0.0f) && (dp <= 0.0f) && (s < 0.0f));
+        bPending            = false;
+
+        return (found) ? add(peaks, pos, neg, nOffset - 1, s) : true;
+    }
+
+    status_t PeakDetector::finish(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg)
+    {
+        // Examine the last sample, the signal is zero after it
+        if (!examine(peaks, pos, neg, 0.0f))
+            return STATUS_NO_MEM;
+
+        // The step is committed only if it is followed by another sample
+        if (nBoundary < nOffset)
+        {
+            if (!commit(pos, neg))
+                return STATUS_NO_MEM;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t PeakDetector::finish_segment(lltl::darray<peak_t> *peaks, lltl::darray<peak_t> *pos, lltl::darray<peak_t> *neg,
+        float next)
+    {
+        // Examine the last sample with the first sample of the next segment
+        if (!examine(peaks, pos, neg, next))
+            return STATUS_NO_MEM;
+
+        // The next segment starts with another step
+        return (commit(pos, neg)) ? STATUS_OK : STATUS_NO_MEM;
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,209 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <private/pool.h>
+
+namespace spike_bender
+{
+    TaskPool::TaskPool(size_t threads)
+    {
+        pBatch      = NULL;
+        nBatch      = 0;
+        bShutdown   = false;
+
+        if (threads <= 0)
+            threads     = ipc::Thread::system_cores();
+        threads     = lsp_max(threads, size_t(1));
+
+        // Start additional workers, the calling thread takes part in the processing.
+        // If a worker can not be started, the pool works with less threads
+        for (size_t i=1; i<threads; ++i)
+        {
+            ipc::Thread *t  = new ipc::Thread(worker_main, this);
+            if (t == NULL)
+                break;
+            if (!vWorkers.add(t))
+            {
+                delete t;
+                break;
+            }
+            if (t->start() != STATUS_OK)
+            {
+                vWorkers.pop(&t);
+                delete t;
+                break;
+            }
+        }
+
+        nThreads    = vWorkers.size() + 1;
+    }
+
+    TaskPool::~TaskPool()
+    {
+        shutdown();
+    }
+
+    void TaskPool::shutdown()
+    {
+        sCond.lock();
+        bShutdown   = true;
+        sCond.broadcast();
+        sCond.unlock();
+
+        for (size_t i=0, n=vWorkers.size(); i<n; ++i)
+        {
+            ipc::Thread *t  = vWorkers.uget(i);
+            t->join();
+            delete t;
+        }
+        vWorkers.flush();
+    }
+
+    void TaskPool::execute(batch_t *b)
+    {
+        // Should be called with the lock acquired
+        while ((b->nNext < b->nCount) && (b->nResult == STATUS_OK))
+        {
+            size_t index    = b->nNext++;
+
+            // Execute the task and store the first error
+            sCond.unlock();
+            status_t res    = b->pTask(b->pArg, index);
+            sCond.lock();
+
+            if ((res != STATUS_OK) && (b->nResult == STATUS_OK))
+                b->nResult      = res;
+        }
+    }
+
+    status_t TaskPool::worker_main(void *arg)
+    {
+        TaskPool *pool  = static_cast<TaskPool *>(arg);
+        size_t seen     = 0;
+
+        pool->sCond.lock();
+        while (true)
+        {
+            // Wait for the next batch
+            while ((!pool->bShutdown) && ((pool->pBatch == NULL) || (pool->nBatch == seen)))
+                pool->sCond.wait();
+            if (pool->bShutdown)
+                break;
+
+            // Join the batch, the caller waits until all joined workers leave it
+            batch_t *b      = pool->pBatch;
+            seen            = pool->nBatch;
+            ++b->nActive;
+            pool->execute(b);
+            if ((--b->nActive) == 0)
+                pool->sCond.broadcast();
+        }
+        pool->sCond.unlock();
+
+        return STATUS_OK;
+    }
+
+    status_t TaskPool::run(size_t count, task_t task, void *arg)
+    {
+        batch_t b;
+        b.pTask         = task;
+        b.pArg          = arg;
+        b.nCount        = count;
+        b.nNext         = 0;
+        b.nActive       = 0;
+        b.nResult       = STATUS_OK;
+
+        sCond.lock();
+
+        // Another batch is running, execute serially
+        if (pBatch != NULL)
+        {
+            sCond.unlock();
+            for (size_t i=0; i<count; ++i)
+            {
+                status_t res    = task(arg, i);
+                if (res != STATUS_OK)
+                    return res;
+            }
+            return STATUS_OK;
+        }
+
+        // Wake up workers and take part in the processing
+        pBatch          = &b;
+        ++nBatch;
+        sCond.broadcast();
+        execute(&b);
+
+        // Detach the batch, so no more workers join it, and wait for the completion
+        pBatch          = NULL;
+        while (b.nActive > 0)
+            sCond.wait();
+
+        sCond.unlock();
+
+        return b.nResult;
+    }
+
+    status_t run_tasks(TaskPool *pool, size_t count, task_t task, void *arg)
+    {
+        if ((pool != NULL) && (pool->threads() > 1) && (count > 1))
+            return pool->run(count, task, arg);
+
+        // Execute serially
+        for (size_t i=0; i<count; ++i)
+        {
+            status_t res    = task(arg, i);
+            if (res != STATUS_OK)
+                return res;
+        }
+
+        return STATUS_OK;
+    }
+
+    size_t channel_segments(const TaskPool *pool, size_t channels, size_t length, size_t min_length)
+    {
+        if ((pool == NULL) || (channels <= 0) || (pool->threads() <= channels))
+            return 1;
+
+        size_t segments = (pool->threads() + channels - 1) / channels;
+        return lsp_max(lsp_min(segments, length / lsp_max(min_length, size_t(1))), size_t(1));
+    }
+
+    size_t channel_lanes(const TaskPool *pool, size_t channels, size_t max_lanes)
+    {
+        size_t threads  = (pool != NULL) ? pool->threads() : 1;
+        if (threads >= channels)
+            return 1;
+
+        size_t lanes    = (channels + threads - 1) / threads;
+        return lsp_max(lsp_min(lanes, max_lanes), size_t(1));
+    }
+
+    size_t segment_offset(size_t length, size_t index, size_t segments, size_t align)
+    {
+        if (index >= segments)
+            return length;
+
+        size_t offset   = size_t((wsize_t(length) * index) / segments);
+        return offset - (offset % lsp_max(align, size_t(1)));
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,420 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/processor.h>
+
+namespace spike_bender
+{
+    Processor::Processor()
+    {
+        pPool       = NULL;
+        vChannels   = NULL;
+        vBuffers    = NULL;
+        nChannels   = 0;
+        nLanes      = 1;
+        nGroups     = 0;
+        nSampleRate = 0;
+        nBlockSize  = 0;
+        nPasses     = 0;
+        nPeriod     = 0;
+        enWeighting = NO_WEIGHT;
+        fRange      = 0.0f;
+        enCurve     = GAIN_CURVE_EXACT;
+        fKnee       = 0.0f;
+        fRelease    = 0.0f;
+        bLive       = false;
+        nCount      = 0;
+        enState     = ST_ANALYZE;
+    }
+
+    Processor::~Processor()
+    {
+        destroy();
+    }
+
+    status_t Processor::init(const config_t *cfg, size_t channels, size_t sample_rate)
+    {
+        destroy();
+        if ((channels <= 0) || (sample_rate <= 0) || (cfg->nBlockSize <= 0) || (cfg->nPasses < 0))
+            return STATUS_BAD_ARGUMENTS;
+
+        nChannels   = channels;
+        nSampleRate = sample_rate;
+        nBlockSize  = cfg->nBlockSize;
+        nPasses     = cfg->nPasses;
+        nPeriod     = size_t(dspu::millis_to_samples(sample_rate, cfg->fReactivity)) | 1;
+        enWeighting = cfg->enWeighting;
+        fRange      = cfg->fRange;
+        enCurve     = cfg->enGainCurve;
+        fKnee       = cfg->fKnee;
+        fRelease    = LIVE_LEVEL_RELEASE * sample_rate;
+        bLive       = cfg->bLive;
+
+        // The workers are started once and are woken for each block, there are no more
+        // tasks than channels, so extra workers would be woken for nothing
+        size_t threads  = (cfg->nThreads > 0) ? cfg->nThreads : ipc::Thread::system_cores();
+        pPool       = new TaskPool(lsp_min(threads, nChannels));
+        vChannels   = new channel_t[nChannels];
+        vBuffers    = new float[nBlockSize * nChannels];
+        if ((pPool == NULL) || (vChannels == NULL) || (vBuffers == NULL))
+        {
+            destroy();
+            return STATUS_NO_MEM;
+        }
+        nLanes      = channel_lanes(pPool, nChannels, LOCKSTEP_LANES);
+        nGroups     = (nChannels + nLanes - 1) / nLanes;
+
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            channel_t *c    = &vChannels[i];
+            c->vStages      = NULL;
+            c->vBuf         = &vBuffers[i * nBlockSize];
+            c->vOut         = NULL;
+            c->vIn          = NULL;
+            c->nOut         = 0;
+        }
+
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            channel_t *c    = &vChannels[i];
+            if ((nPasses > 0) && ((c->vStages = new GainStage[nPasses]) == NULL))
+            {
+                destroy();
+                return STATUS_NO_MEM;
+            }
+        }
+
+        status_t res    = reset();
+        if (res != STATUS_OK)
+            destroy();
+
+        return res;
+    }
+
+    void Processor::destroy()
+    {
+        if (vChannels != NULL)
+        {
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                channel_t *c    = &vChannels[i];
+                if (c->vStages != NULL)
+                {
+                    delete [] c->vStages;
+                    c->vStages      = NULL;
+                }
+            }
+            delete [] vChannels;
+            vChannels   = NULL;
+        }
+        if (vBuffers != NULL)
+        {
+            delete [] vBuffers;
+            vBuffers    = NULL;
+        }
+        if (pPool != NULL)
+        {
+            delete pPool;
+            pPool       = NULL;
+        }
+
+        nChannels   = 0;
+        nGroups     = 0;
+        enState     = ST_ANALYZE;
+    }
+
+    size_t Processor::latency() const
+    {
+        return nPasses * (nPeriod / 2);
+    }
+
+    status_t Processor::reset()
+    {
+        status_t res;
+        size_t period   = size_t(dspu::millis_to_samples(nSampleRate, 400.0f)) | 1;
+
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            channel_t *c    = &vChannels[i];
+            c->fLevel       = (bLive) ? LIVE_LEVEL_MIN : 0.0f;
+            c->bAnalyzed    = false;
+            if ((res = c->sMeter.init(nSampleRate, enWeighting, period)) != STATUS_OK)
+                return res;
+        }
+
+        enState         = ST_ANALYZE;
+
+        return STATUS_OK;
+    }
+
+    status_t Processor::set_level(size_t channel, float level)
+    {
+        if (channel >= nChannels)
+            return STATUS_INVALID_VALUE;
+        if (enState != ST_ANALYZE)
+            return STATUS_BAD_STATE;
+
+        channel_t *c    = &vChannels[channel];
+        c->fLevel       = (bLive) ? lsp_max(level, LIVE_LEVEL_MIN) : level;
+        c->bAnalyzed    = false;
+
+        return STATUS_OK;
+    }
+
+    float Processor::level(size_t channel) const
+    {
+        return (channel < nChannels) ? vChannels[channel].fLevel : 0.0f;
+    }
+
+    status_t Processor::analyze_channel(void *arg, size_t index)
+    {
+        Processor *self     = static_cast<Processor *>(arg);
+        channel_t *c        = &self->vChannels[index];
+
+        c->sMeter.process(c->vBuf, c->vIn, self->nCount);
+        c->fLevel           = lsp_max(c->fLevel, dsp::abs_max(c->vBuf, self->nCount));
+        c->bAnalyzed        = true;
+
+        return STATUS_OK;
+    }
+
+    void Processor::update_level(channel_t *c, size_t count)
+    {
+        // Estimate the long-time RMS of the block and let the running level decay
+        c->sMeter.process(c->vBuf, c->vIn, count);
+        float peak          = dsp::abs_max(c->vBuf, count);
+        float level         = c->fLevel * expf(-float(count) / fRelease);
+        c->fLevel           = lsp_max(lsp_max(level, peak), LIVE_LEVEL_MIN);
+
+        // The threshold is updated once per block, so the cost does not depend on the signal
+        for (size_t i=0; i<nPasses; ++i)
+            c->vStages[i].set_threshold(c->fLevel);
+    }
+
+    status_t Processor::process_group(void *arg, size_t index)
+    {
+        Processor *self     = static_cast<Processor *>(arg);
+        size_t first        = index * self->nLanes;
+        size_t lanes        = lsp_min(self->nLanes, self->nChannels - first);
+        channel_t *vc       = &self->vChannels[first];
+        size_t count        = self->nCount;
+
+        GainStage *stages[LOCKSTEP_LANES];
+        float *dst[LOCKSTEP_LANES];
+        const float *src[LOCKSTEP_LANES];
+        for (size_t l=0; l<lanes; ++l)
+        {
+            // Track the long-time RMS level in live mode
+            if (self->bLive)
+                self->update_level(&vc[l], count);
+
+            dst[l]              = vc[l].vBuf;
+            src[l]              = vc[l].vIn;
+        }
+
+        // Apply all gain adjustment passes, the stages of the same pass are processed in lockstep
+        for (size_t i=0; i<self->nPasses; ++i)
+        {
+            for (size_t l=0; l<lanes; ++l)
+                stages[l]           = &vc[l].vStages[i];
+            count               = GainStage::process(stages, dst, src, lanes, count);
+            for (size_t l=0; l<lanes; ++l)
+                src[l]              = dst[l];
+        }
+
+        // The output lags behind the input, so it can be written in place
+        for (size_t l=0; l<lanes; ++l)
+        {
+            dsp::move(vc[l].vOut, src[l], count);
+            vc[l].nOut          = count;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t Processor::flush_group(void *arg, size_t index)
+    {
+        Processor *self     = static_cast<Processor *>(arg);
+        size_t first        = index * self->nLanes;
+        size_t lanes        = lsp_min(self->nLanes, self->nChannels - first);
+        channel_t *vc       = &self->vChannels[first];
+
+        GainStage *stages[LOCKSTEP_LANES];
+        float *buf[LOCKSTEP_LANES];
+        for (size_t l=0; l<lanes; ++l)
+        {
+            buf[l]              = vc[l].vBuf;
+            vc[l].nOut          = 0;
+        }
+
+        // Stages are flushed in order, the output of the stage is passed through the rest of stages
+        for (size_t i=0; i<self->nPasses; ++i)
+        {
+            if (vc[0].vStages[i].tail() <= 0)
+                continue;
+
+            for (size_t l=0; l<lanes; ++l)
+                stages[l]           = &vc[l].vStages[i];
+            size_t count        = GainStage::flush(stages, buf, lanes, self->nCount);
+            for (size_t j=i+1; j<self->nPasses; ++j)
+            {
+                for (size_t l=0; l<lanes; ++l)
+                    stages[l]           = &vc[l].vStages[j];
+                count               = GainStage::process(stages, buf, buf, lanes, count);
+            }
+
+            for (size_t l=0; l<lanes; ++l)
+            {
+                dsp::copy(vc[l].vOut, buf[l], count);
+                vc[l].nOut          = count;
+            }
+            break;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t Processor::start()
+    {
+        status_t res;
+
+        for (size_t i=0; i<nChannels; ++i)
+        {
+            channel_t *c    = &vChannels[i];
+
+            // Process the tail of the long-time RMS
+            if (c->bAnalyzed)
+            {
+                for (size_t tail = c->sMeter.period(); tail > 0; )
+                {
+                    size_t count        = lsp_min(tail, nBlockSize);
+                    c->sMeter.process(c->vBuf, NULL, count);
+                    c->fLevel           = lsp_max(c->fLevel, dsp::abs_max(c->vBuf, count));
+                    tail               -= count;
+                }
+            }
+
+            for (size_t j=0; j<nPasses; ++j)
+            {
+                res = c->vStages[j].init(nSampleRate, nBlockSize, enWeighting, nPeriod,
+                    c->fLevel, fRange, fKnee, enCurve);
+                if (res != STATUS_OK)
+                    return res;
+            }
+        }
+
+        enState         = ST_PROCESS;
+
+        return STATUS_OK;
+    }
+
+    status_t Processor::analyze(const float * const *src, size_t count)
+    {
+        status_t res;
+        if (vChannels == NULL)
+            return STATUS_BAD_STATE;
+        if ((enState != ST_ANALYZE) || (bLive))
+            return STATUS_BAD_STATE;
+
+        for (size_t off=0; off < count; off += nCount)
+        {
+            nCount          = lsp_min(count - off, nBlockSize);
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].vIn    = &src[i][off];
+
+            if ((res = run_tasks(pPool, nChannels, analyze_channel, this)) != STATUS_OK)
+                return res;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t Processor::process(float * const *dst, const float * const *src, size_t count, size_t *written)
+    {
+        status_t res;
+        if (vChannels == NULL)
+            return STATUS_BAD_STATE;
+        if (enState == ST_ANALYZE)
+        {
+            if ((res = start()) != STATUS_OK)
+                return res;
+        }
+        else if (enState != ST_PROCESS)
+            return STATUS_BAD_STATE;
+
+        size_t wr       = 0;
+        for (size_t rd=0; rd < count; rd += nCount)
+        {
+            nCount          = lsp_min(count - rd, nBlockSize);
+            for (size_t i=0; i<nChannels; ++i)
+            {
+                channel_t *c    = &vChannels[i];
+                c->vIn          = &src[i][rd];
+                c->vOut         = &dst[i][wr];
+            }
+
+            if ((res = run_tasks(pPool, nGroups, process_group, this)) != STATUS_OK)
+                return res;
+            wr             += vChannels[0].nOut;
+        }
+
+        if (written != NULL)
+            *written        = wr;
+
+        return STATUS_OK;
+    }
+
+    status_t Processor::flush(float * const *dst, size_t count, size_t *written)
+    {
+        status_t res;
+        if (vChannels == NULL)
+            return STATUS_BAD_STATE;
+        if (enState == ST_ANALYZE)
+        {
+            if ((res = start()) != STATUS_OK)
+                return res;
+        }
+        enState         = ST_FLUSH;
+
+        // The stages are flushed in order, so the tail of the last stage is flushed last
+        size_t wr       = 0;
+        while ((wr < count) && (nPasses > 0) && (vChannels[0].vStages[nPasses - 1].tail() > 0))
+        {
+            nCount          = lsp_min(count - wr, nBlockSize);
+            for (size_t i=0; i<nChannels; ++i)
+                vChannels[i].vOut   = &dst[i][wr];
+
+            if ((res = run_tasks(pPool, nGroups, flush_group, this)) != STATUS_OK)
+                return res;
+            wr             += vChannels[0].nOut;
+        }
+
+        if (written != NULL)
+            *written        = wr;
+
+        return STATUS_OK;
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/resampler.h>
+
+namespace spike_bender
+{
+    typedef struct preset_t
+    {
+        size_t      half;       // Half-length of the filter for interpolation
+        double      beta;       // Kaiser window parameter
+        double      rolloff;    // Cutoff frequency relative to the Nyquist frequency
+    } preset_t;
+
+    static const preset_t presets[] =
+    {
+        {  8,   6.0,    0.85 },     // RESAMPLE_FAST
+        { 16,   8.0,    0.90 },     // RESAMPLE_NORMAL
+        { 32,   10.0,   0.95 }      // RESAMPLE_BEST
+    };
+
+    static size_t gcd(size_t a, size_t b)
+    {
+        while (b > 0)
+        {
+            size_t t    = a % b;
+            a           = b;
+            b           = t;
+        }
+        return a;
+    }
+
+    static double bessel_i0(double x)
+    {
+        double sum  = 1.0;
+        double term = 1.0;
+        double q    = 0.25 * x * x;
+
+        for (size_t k=1; term > 1e-12 * sum; ++k)
+        {
+            term       *= q / double(k * k);
+            sum        += term;
+        }
+
+        return sum;
+    }
+
+    Resampler::Resampler()
+    {
+        vCoeffs     = NULL;
+        vBuffer     = NULL;
+        nL          = 1;
+        nM          = 1;
+        nHalf       = 0;
+        nTaps       = 0;
+        nCapacity   = 0;
+        nFill       = 0;
+        nPos        = 0;
+        nPhase      = 0;
+        nIn         = 0;
+        nOut        = 0;
+    }
+
+    Resampler::~Resampler()
+    {
+        destroy();
+    }
+
+    bool Resampler::supported(size_t src_rate, size_t dst_rate)
+    {
+        if ((src_rate <= 0) || (dst_rate <= 0))
+            return false;
+        return (dst_rate / gcd(src_rate, dst_rate)) <= RESAMPLER_MAX_PHASES;
+    }
+
+    status_t Resampler::init(size_t src_rate, size_t dst_rate, resample_t quality)
+    {
+        destroy();
+
+        if (!supported(src_rate, dst_rate))
+            return STATUS_NOT_SUPPORTED;
+
+        const preset_t *p   = &presets[quality];
+        size_t g            = gcd(src_rate, dst_rate);
+        nL                  = dst_rate / g;
+        nM                  = src_rate / g;
+
+        // Compute the length of the filter: the filter becomes longer when decimating
+        double fc           = p->rolloff * lsp_min(1.0, double(nL) / double(nM));
+        nHalf               = (nM > nL) ? (p->half * nM + nL - 1) / nL : p->half;
+        nTaps               = nHalf * 2;
+        nCapacity           = nTaps + RESAMPLER_BLOCK_SIZE;
+
+        vCoeffs             = new float[nL * nTaps];
+        if (vCoeffs == NULL)
+            return STATUS_NO_MEM;
+        vBuffer             = new float[nCapacity];
+        if (vBuffer == NULL)
+        {
+            destroy();
+            return STATUS_NO_MEM;
+        }
+
+        // Build the filter bank: windowed sinc shifted by the fraction of the sample for each phase
+        const double kw     = 1.0 / bessel_i0(p->beta);
+        for (size_t ph=0; ph<nL; ++ph)
+        {
+            float *c            = &vCoeffs[ph * nTaps];
+            double sum          = 0.0;
+
+            for (size_t i=0; i<nTaps; ++i)
+            {
+                double d            = double(i) - double(nHalf - 1) - double(ph) / double(nL);
+                double x            = d / double(nHalf);
+                double w            = (fabs(x) < 1.0) ? bessel_i0(p->beta * sqrt(1.0 - x * x)) * kw : 0.0;
+                double a            = M_PI * fc * d;
+                double s            = (fabs(a) > 1e-9) ? sin(a) / a : 1.0;
+                double k            = fc * s * w;
+
+                c[i]                = float(k);
+                sum                += k;
+            }
+
+            // Normalize the gain of each phase
+            dsp::mul_k2(c, float(1.0 / sum), nTaps);
+        }
+
+        reset();
+
+        return STATUS_OK;
+    }
+
+    void Resampler::destroy()
+    {
+        if (vCoeffs != NULL)
+        {
+            delete [] vCoeffs;
+            vCoeffs     = NULL;
+        }
+        if (vBuffer != NULL)
+        {
+            delete [] vBuffer;
+            vBuffer     = NULL;
+        }
+    }
+
+    void Resampler::reset()
+    {
+        // Prepend the history with zeros to compensate the latency of the filter
+        dsp::fill_zero(vBuffer, nHalf - 1);
+        nFill       = nHalf - 1;
+        nPos        = nHalf - 1;
+        nPhase      = 0;
+        nIn         = 0;
+        nOut        = 0;
+    }
+
+    size_t Resampler::produce(float *dst, size_t count)
+    {
+        size_t n    = 0;
+
+        if (nL == 1)
+        {
+            // Integer decimation: single set of coefficients, fixed step
+            while ((n < count) && (nPos + nHalf < nFill))
+            {
+                dst[n++]    = dsp::h_dotp(&vBuffer[nPos + 1 - nHalf], vCoeffs, nTaps);
+                nPos       += nM;
+            }
+        }
+        else
+        {
+            while ((n < count) && (nPos + nHalf < nFill))
+            {
+                dst[n++]    = dsp::h_dotp(&vBuffer[nPos + 1 - nHalf], &vCoeffs[nPhase * nTaps], nTaps);
+                nPhase     += nM;
+                nPos       += nPhase / nL;
+                nPhase      = nPhase % nL;
+            }
+        }
+
+        nOut       += n;
+        return n;
+    }
+
+    void Resampler::compact()
+    {
+        // Remove samples that are not required for further processing
+        size_t shift    = lsp_min(nPos + 1 - nHalf, nFill);
+        if (shift <= 0)
+            return;
+
+        dsp::move(vBuffer, &vBuffer[shift], nFill - shift);
+        nFill          -= shift;
+        nPos           -= shift;
+    }
+
+    size_t Resampler::append(const float *src, size_t count)
+    {
+        size_t n        = lsp_min(count, nCapacity - nFill);
+        if (src != NULL)
+            dsp::copy(&vBuffer[nFill], src, n);
+        else
+            dsp::fill_zero(&vBuffer[nFill], n);
+        nFill          += n;
+
+        return n;
+    }
+
+    size_t Resampler::process(float *dst, const float *src, size_t count)
+    {
+        size_t n        = 0;
+
+        while (count > 0)
+        {
+            compact();
+            size_t k        = append(src, count);
+            src            += k;
+            count          -= k;
+            nIn            += k;
+
+            n              += produce(&dst[n], ~size_t(0));
+        }
+
+        return n;
+    }
+
+    size_t Resampler::flush(float *dst, size_t count)
+    {
+        size_t n        = 0;
+        wsize_t length  = output_length(nIn);
+
+        while ((n < count) && (nOut < length))
+        {
+            size_t k        = produce(&dst[n], lsp_min(wsize_t(count - n), length - nOut));
+            n              += k;
+
+            // Feed zeros after the end of the stream
+            if (k <= 0)
+            {
+                compact();
+                append(NULL, nCapacity - nFill);
+            }
+        }
+
+        return n;
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,305 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/fmt/json/Serializer.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#include <private/stats.h>
+
+#if defined(PLATFORM_WINDOWS)
+    #include <windows.h>
+#else
+    #include <sys/resource.h>
+    #include <time.h>
+    #include <unistd.h>
+    #if defined(PLATFORM_MACOSX)
+        #include <mach/mach.h>
+    #endif /* PLATFORM_MACOSX */
+#endif /* PLATFORM_WINDOWS */
+
+namespace spike_bender
+{
+#if defined(PLATFORM_WINDOWS)
+    static double wall_time()
+    {
+        LARGE_INTEGER freq, time;
+        QueryPerformanceFrequency(&freq);
+        QueryPerformanceCounter(&time);
+        return double(time.QuadPart) / double(freq.QuadPart);
+    }
+
+    static double process_cpu_time()
+    {
+        FILETIME ct, et, kt, ut;
+        if (!GetProcessTimes(GetCurrentProcess(), &ct, &et, &kt, &ut))
+            return 0.0;
+
+        ULARGE_INTEGER k, u;
+        k.LowPart       = kt.dwLowDateTime;
+        k.HighPart      = kt.dwHighDateTime;
+        u.LowPart       = ut.dwLowDateTime;
+        u.HighPart      = ut.dwHighDateTime;
+
+        return double(k.QuadPart + u.QuadPart) * 1e-7;
+    }
+
+    static wsize_t process_peak_rss()
+    {
+        return 0;
+    }
+
+    static wsize_t process_rss()
+    {
+        return 0;
+    }
+#else
+    static double wall_time()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return double(ts.tv_sec) + double(ts.tv_nsec) * 1e-9;
+    }
+
+    static double process_cpu_time()
+    {
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+            return 0.0;
+
+        return double(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+            double(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) * 1e-6;
+    }
+
+    static wsize_t process_peak_rss()
+    {
+        struct rusage ru;
+        if (getrusage(RUSAGE_SELF, &ru) != 0)
+            return 0;
+
+    #if defined(PLATFORM_MACOSX)
+        return wsize_t(ru.ru_maxrss);           // Bytes
+    #else
+        return wsize_t(ru.ru_maxrss) * 1024;    // Kilobytes
+    #endif /* PLATFORM_MACOSX */
+    }
+
+    static wsize_t process_rss()
+    {
+    #if defined(PLATFORM_MACOSX)
+        mach_task_basic_info_data_t info;
+        mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+        if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) != KERN_SUCCESS)
+            return 0;
+        return wsize_t(info.resident_size);
+    #else
+        // The second field is the number of resident pages
+        FILE *fd = fopen("/proc/self/statm", "r");
+        if (fd == NULL)
+            return 0;
+        unsigned long long pages = 0;
+        int n = fscanf(fd, "%*s %llu", &pages);
+        fclose(fd);
+
+        return (n == 1) ? wsize_t(pages) * sysconf(_SC_PAGESIZE) : 0;
+    #endif /* PLATFORM_MACOSX */
+    }
+#endif /* PLATFORM_WINDOWS */
+
+    Stats::Stats()
+    {
+    }
+
+    Stats::~Stats()
+    {
+        vStages.flush();
+    }
+
+    void Stats::clear()
+    {
+        vStages.clear();
+    }
+
+    void Stats::swap(Stats *dst)
+    {
+        vStages.swap(&dst->vStages);
+    }
+
+    void Stats::start(probe_t *p)
+    {
+        p->fWallTime       = wall_time();
+        p->fProcessCpuTime = process_cpu_time();
+        p->nProcessRss     = process_rss();
+        p->nProcessPeakRss = process_peak_rss();
+    }
+
+    status_t Stats::commit(const probe_t *p, const char *name, ssize_t pass, wsize_t samples)
+    {
+        stage_t *s      = vStages.add();
+        if (s == NULL)
+            return STATUS_NO_MEM;
+
+        s->sName           = name;
+        s->nPass           = pass;
+        s->fWallTime       = wall_time() - p->fWallTime;
+        s->fProcessCpuTime = process_cpu_time() - p->fProcessCpuTime;
+        s->nSamples        = samples;
+        s->nProcessPeakRss = process_peak_rss();
+        s->nRssDelta       = wssize_t(process_rss()) - wssize_t(p->nProcessRss);
+        s->nPeakRssGrowth  = (s->nProcessPeakRss > p->nProcessPeakRss) ? s->nProcessPeakRss - p->nProcessPeakRss : 0;
+
+        return STATUS_OK;
+    }
+
+    static status_t write_stage(json::Serializer *s, const stage_t *st)
+    {
+        status_t res;
+
+        if ((res = s->start_object()) != STATUS_OK)
+            return res;
+
+        if ((res = s->write_property("stage")) != STATUS_OK)
+            return res;
+        if ((res = s->write_string(st->sName)) != STATUS_OK)
+            return res;
+        if (st->nPass >= 0)
+        {
+            if ((res = s->write_property("pass")) != STATUS_OK)
+                return res;
+            if ((res = s->write_int(st->nPass)) != STATUS_OK)
+                return res;
+        }
+        if ((res = s->write_property("wall_time")) != STATUS_OK)
+            return res;
+        if ((res = s->write_double(st->fWallTime)) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("process_cpu_time")) != STATUS_OK)
+            return res;
+        if ((res = s->write_double(st->fProcessCpuTime)) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("samples")) != STATUS_OK)
+            return res;
+        if ((res = s->write_int(st->nSamples)) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("process_peak_rss")) != STATUS_OK)
+            return res;
+        if ((res = s->write_int(st->nProcessPeakRss)) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("rss_delta")) != STATUS_OK)
+            return res;
+        if ((res = s->write_int(st->nRssDelta)) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("peak_rss_growth")) != STATUS_OK)
+            return res;
+        if ((res = s->write_int(st->nPeakRssGrowth)) != STATUS_OK)
+            return res;
+
+        return s->end_object();
+    }
+
+    static status_t write_file(json::Serializer *s, const file_stats_t *f)
+    {
+        status_t res;
+
+        if ((res = s->start_object()) != STATUS_OK)
+            return res;
+
+        if ((res = s->write_property("input")) != STATUS_OK)
+            return res;
+        if ((res = s->write_string(f->pInFile)) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("output")) != STATUS_OK)
+            return res;
+        if ((res = s->write_string(f->pOutFile)) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("result")) != STATUS_OK)
+            return res;
+        if ((res = s->write_int(f->nResult)) != STATUS_OK)
+            return res;
+
+        // Write stages
+        if ((res = s->write_property("stages")) != STATUS_OK)
+            return res;
+        if ((res = s->start_array()) != STATUS_OK)
+            return res;
+        for (size_t i=0, n=f->pStats->size(); i<n; ++i)
+        {
+            if ((res = write_stage(s, f->pStats->get(i))) != STATUS_OK)
+                return res;
+        }
+        if ((res = s->end_array()) != STATUS_OK)
+            return res;
+
+        return s->end_object();
+    }
+
+    static status_t write_files(json::Serializer *s, const file_stats_t *files, size_t count)
+    {
+        status_t res;
+
+        if ((res = s->start_object()) != STATUS_OK)
+            return res;
+        if ((res = s->write_property("files")) != STATUS_OK)
+            return res;
+        if ((res = s->start_array()) != STATUS_OK)
+            return res;
+        for (size_t i=0; i<count; ++i)
+        {
+            if ((res = write_file(s, &files[i])) != STATUS_OK)
+                return res;
+        }
+        if ((res = s->end_array()) != STATUS_OK)
+            return res;
+
+        return s->end_object();
+    }
+
+    status_t write_stats(const LSPString *path, const file_stats_t *files, size_t count)
+    {
+        status_t res;
+        json::Serializer s;
+        json::serial_flags_t flags;
+
+        // Produce strict JSON that can be parsed by any tool
+        flags.version       = json::JSON_LEGACY;
+        flags.identifiers   = false;
+        flags.ident         = ' ';
+        flags.padding       = 2;
+        flags.separator     = true;
+        flags.multiline     = true;
+
+        if ((res = s.open(path, &flags, "UTF-8")) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not write statistics file '%s', error code: %d\n", path->get_native(), int(res));
+            return res;
+        }
+
+        res                 = write_files(&s, files, count);
+        status_t cres       = s.close();
+        if (res == STATUS_OK)
+            res                 = cres;
+        if (res != STATUS_OK)
+            fprintf(stderr, "Error writing statistics file '%s', error code: %d\n", path->get_native(), int(res));
+
+        return res;
+    }
+
+} /* namespace spike_bender */
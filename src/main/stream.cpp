@@ -0,0 +1,1221 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/common/debug.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/mm/InAudioFileStream.h>
+#include <lsp-plug.in/mm/OutAudioFileStream.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#include <private/arena.h>
+#include <private/async.h>
+#include <private/stream.h>
+
+namespace spike_bender
+{
+    //-------------------------------------------------------------------------
+    // SampleFifo
+    SampleFifo::SampleFifo()
+    {
+        vData       = NULL;
+        nHead       = 0;
+        nTail       = 0;
+        nCapacity   = 0;
+    }
+
+    SampleFifo::~SampleFifo()
+    {
+        destroy();
+    }
+
+    void SampleFifo::destroy()
+    {
+        if (vData != NULL)
+        {
+            delete [] vData;
+            vData       = NULL;
+        }
+        nHead       = 0;
+        nTail       = 0;
+        nCapacity   = 0;
+    }
+
+    float *SampleFifo::reserve(size_t count)
+    {
+        // Enough space at the tail?
+        if ((vData != NULL) && ((nTail + count) <= nCapacity))
+            return &vData[nTail];
+
+        // Compact the data if possible
+        size_t size = nTail - nHead;
+        if ((vData != NULL) && ((size + count) <= nCapacity))
+        {
+            dsp::move(vData, &vData[nHead], size);
+            nHead       = 0;
+            nTail       = size;
+            return &vData[nTail];
+        }
+
+        // Grow the buffer
+        size_t cap  = lsp_max(nCapacity, size_t(0x400));
+        while (cap < (size + count))
+            cap       <<= 1;
+
+        float *buf  = new float[cap];
+        if (buf == NULL)
+            return NULL;
+        if (size > 0)
+            dsp::copy(buf, &vData[nHead], size);
+        if (vData != NULL)
+            delete [] vData;
+
+        vData       = buf;
+        nHead       = 0;
+        nTail       = size;
+        nCapacity   = cap;
+
+        return &vData[nTail];
+    }
+
+    void SampleFifo::commit(size_t count)
+    {
+        nTail      += count;
+    }
+
+    void SampleFifo::skip(size_t count)
+    {
+        nHead      += lsp_min(count, nTail - nHead);
+        if (nHead >= nTail)
+            nHead = nTail = 0;
+    }
+
+    bool SampleFifo::append(const float *src, size_t count)
+    {
+        float *dst  = reserve(count);
+        if (dst == NULL)
+            return false;
+        dsp::copy(dst, src, count);
+        nTail      += count;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    // GainStage
+    GainStage::GainStage()
+    {
+        vDelay      = NULL;
+        vRms        = NULL;
+        vBuffer     = NULL;
+        nDelay      = 0;
+        nDelayHead  = 0;
+        nSkip       = 0;
+        nTail       = 0;
+        nBlockSize  = 0;
+        nCapacity   = 0;
+    }
+
+    GainStage::~GainStage()
+    {
+        destroy();
+    }
+
+    status_t GainStage::init(size_t sample_rate, size_t block_size, weighting_t weight, size_t period,
+        float thresh, float range_db, float knee_db, gain_curve_t curve)
+    {
+        status_t res;
+
+        // The meter, the gain computer and the delay line keep their buffers
+        // between initializations, so the stage can be reused without allocations
+        if ((res = sMeter.init(sample_rate, weight, period)) != STATUS_OK)
+            return res;
+
+        nDelay      = sMeter.period() / 2;
+        size_t capacity = nDelay + block_size * 2;
+        if ((vDelay == NULL) || (nCapacity < capacity))
+        {
+            if (vDelay != NULL)
+                delete [] vDelay;
+            vDelay      = new float[capacity];
+            if (vDelay == NULL)
+            {
+                nCapacity   = 0;
+                return STATUS_NO_MEM;
+            }
+            nCapacity   = capacity;
+        }
+        vRms        = &vDelay[nDelay];
+        vBuffer     = &vRms[block_size];
+        dsp::fill_zero(vDelay, nDelay);
+
+        nDelayHead  = 0;
+        nSkip       = nDelay;
+        nTail       = nDelay;
+        nBlockSize  = block_size;
+
+        return sGain.init(sample_rate, thresh, range_db, knee_db, curve);
+    }
+
+    void GainStage::set_threshold(float thresh)
+    {
+        sGain.set_threshold(thresh);
+    }
+
+    void GainStage::destroy()
+    {
+        sMeter.destroy();
+        if (vDelay != NULL)
+        {
+            delete [] vDelay;
+            vDelay      = NULL;
+        }
+        vRms        = NULL;
+        vBuffer     = NULL;
+        nCapacity   = 0;
+    }
+
+    void GainStage::delay(const float *src, size_t count)
+    {
+        // Delay the input signal by the half of the RMS period, each iteration
+        // does not cross the end of the delay line
+        if (nDelay > 0)
+        {
+            for (size_t off=0, n; off<count; off += n)
+            {
+                n                   = lsp_min(count - off, nDelay - nDelayHead);
+                dsp::copy(&vBuffer[off], &vDelay[nDelayHead], n);
+                if (src != NULL)
+                    dsp::copy(&vDelay[nDelayHead], &src[off], n);
+                else
+                    dsp::fill_zero(&vDelay[nDelayHead], n);
+
+                nDelayHead         += n;
+                if (nDelayHead >= nDelay)
+                    nDelayHead          = 0;
+            }
+        }
+        else if (src != NULL)
+            dsp::copy(vBuffer, src, count);
+        else
+            dsp::fill_zero(vBuffer, count);
+    }
+
+    size_t GainStage::process(float *dst, const float *src, size_t count)
+    {
+        GainStage *self     = this;
+        return process(&self, &dst, (src != NULL) ? &src : NULL, 1, count);
+    }
+
+    size_t GainStage::process(GainStage * const *stages, float * const *dst,
+        const float * const *src, size_t lanes, size_t count)
+    {
+        RMSMeter *meters[LOCKSTEP_LANES];
+        GainComputer *gains[LOCKSTEP_LANES];
+        float *rms[LOCKSTEP_LANES];
+        const float *env[LOCKSTEP_LANES];
+
+        size_t n            = 0;
+        for (size_t first=0, lanes_n; first<lanes; first += lanes_n)
+        {
+            lanes_n             = lsp_min(lanes - first, LOCKSTEP_LANES);
+            GainStage * const *gs   = &stages[first];
+
+            // Estimate the RMS of the block
+            for (size_t l=0; l<lanes_n; ++l)
+            {
+                meters[l]           = &gs[l]->sMeter;
+                rms[l]              = gs[l]->vRms;
+            }
+            RMSMeter::process(meters, rms, (src != NULL) ? &src[first] : NULL, lanes_n, count);
+
+            // The first samples of the RMS are required only for lookahead, the stages
+            // share the configuration so they skip the same number of samples
+            size_t skip         = lsp_min(gs[0]->nSkip, count);
+            n                   = count - skip;
+            for (size_t l=0; l<lanes_n; ++l)
+            {
+                GainStage *st       = gs[l];
+                st->delay((src != NULL) ? src[first + l] : NULL, count);
+                st->nSkip          -= skip;
+                gains[l]            = &st->sGain;
+                env[l]              = &st->vRms[skip];
+            }
+            if (n <= 0)
+                continue;
+
+            // Compute the gain and apply it
+            GainComputer::process(gains, &dst[first], env, lanes_n, n);
+            for (size_t l=0; l<lanes_n; ++l)
+                dsp::mul2(dst[first + l], &gs[l]->vBuffer[skip], n);
+        }
+
+        return n;
+    }
+
+    size_t GainStage::flush(float *dst, size_t count)
+    {
+        GainStage *self     = this;
+        return flush(&self, &dst, 1, count);
+    }
+
+    size_t GainStage::flush(GainStage * const *stages, float * const *dst, size_t lanes, size_t count)
+    {
+        count           = lsp_min(count, stages[0]->nTail);
+        for (size_t l=0; l<lanes; ++l)
+            stages[l]->nTail   -= count;
+
+        return process(stages, dst, NULL, lanes, count);
+    }
+
+    //-------------------------------------------------------------------------
+    // Pipelined gain adjustment passes
+    typedef struct passes_task_t
+    {
+        dspu::Sample       *sample;
+        size_t              passes;
+        weighting_t         weight;
+        size_t              period;
+        const float        *thresh;
+        float               range_db;
+        float               knee_db;
+        gain_curve_t        curve;
+        size_t              segments;       // Number of segments of each channel
+        size_t              lanes;          // Number of channels processed in lockstep by each task
+        size_t              warmup;         // Number of samples before the segment for the stages to settle
+        size_t              lookahead;      // Number of samples after the segment required by the stages
+        float              *overlaps;       // Copies of the source signal around the boundaries of segments
+        float              *peaks;          // Absolute peak of each segment, may be NULL
+        ScratchArena       *arena;          // Scratch slot of each task
+    } passes_task_t;
+
+    typedef struct passes_output_t
+    {
+        float              *data;           // Start of the segment
+        size_t              offset;         // Position of the next output sample in the stream
+        size_t              first;          // Position of the first sample of the segment in the stream
+        size_t              last;           // Position of the end of the segment in the stream
+        float               peak;           // Absolute peak of the written samples
+        bool                track;          // Track the peak of the written samples
+    } passes_output_t;
+
+    static void write_passes(passes_output_t *out, const float *buf, size_t count)
+    {
+        // Write only the samples that belong to the segment
+        size_t first        = lsp_max(out->offset, out->first);
+        size_t last         = lsp_min(out->offset + count, out->last);
+        if (first < last)
+        {
+            const float *src    = &buf[first - out->offset];
+            dsp::copy(&out->data[first - out->first], src, last - first);
+            if (out->track)
+                out->peak           = lsp_max(out->peak, dsp::abs_max(src, last - first));
+        }
+        out->offset        += count;
+    }
+
+    static void feed_passes(const passes_task_t *t, GainStage * const *stages, float * const *buf,
+        const float * const *src, size_t lanes, size_t length, passes_output_t *out)
+    {
+        const float *sp[LOCKSTEP_LANES];
+
+        for (size_t rd=0; rd<length; )
+        {
+            size_t n            = lsp_min(length - rd, WINDOW_BLOCK_SIZE);
+            for (size_t l=0; l<lanes; ++l)
+                sp[l]               = &src[l][rd];
+
+            size_t count        = n;
+            for (size_t j=0; j<t->passes; ++j)
+            {
+                count               = GainStage::process(&stages[j * lanes], buf, sp, lanes, count);
+                for (size_t l=0; l<lanes; ++l)
+                    sp[l]               = buf[l];
+            }
+
+            for (size_t l=0; l<lanes; ++l)
+                write_passes(&out[l], buf[l], count);
+            rd                 += n;
+        }
+    }
+
+    static status_t process_passes_segment(void *arg, size_t index)
+    {
+        status_t res;
+        passes_task_t *t    = static_cast<passes_task_t *>(arg);
+        size_t g            = index / t->segments;
+        size_t s            = index % t->segments;
+        size_t first_ch     = g * t->lanes;
+        size_t lanes        = lsp_min(t->lanes, t->sample->channels() - first_ch);
+
+        // Stages are stored pass by pass, the stages of the same pass are processed in lockstep
+        scratch_t *sc       = t->arena->slot(index);
+        size_t nstages      = t->passes * lanes;
+        GainStage **vs      = sc->stages(nstages);
+        if (vs == NULL)
+            return STATUS_NO_MEM;
+        float *data         = sc->vValues.append_n(WINDOW_BLOCK_SIZE * lanes);
+        if (data == NULL)
+            return STATUS_NO_MEM;
+
+        for (size_t j=0; j<t->passes; ++j)
+        {
+            for (size_t l=0; l<lanes; ++l)
+            {
+                res = vs[j * lanes + l]->init(t->sample->sample_rate(), WINDOW_BLOCK_SIZE, t->weight, t->period,
+                    t->thresh[first_ch + l], t->range_db, t->knee_db, t->curve);
+                if (res != STATUS_OK)
+                    return res;
+            }
+        }
+
+        // The segment is preceded by the warm-up signal and followed by the lookahead signal,
+        // both are taken from copies since the neighbour segments are overwritten concurrently
+        size_t length       = t->sample->length();
+        size_t first        = segment_offset(length, s, t->segments);
+        size_t last         = segment_offset(length, s + 1, t->segments);
+        size_t overlap      = t->warmup + t->lookahead;
+        size_t nhead        = (s > 0) ? t->warmup : 0;
+        bool has_tail       = (s + 1) < t->segments;
+
+        float *buf[LOCKSTEP_LANES];
+        const float *head[LOCKSTEP_LANES], *body[LOCKSTEP_LANES], *tail[LOCKSTEP_LANES];
+        passes_output_t out[LOCKSTEP_LANES];
+        for (size_t l=0; l<lanes; ++l)
+        {
+            size_t base         = (first_ch + l) * (t->segments - 1);
+            head[l]             = (s > 0) ? &t->overlaps[(base + s - 1) * overlap] : NULL;
+            tail[l]             = (has_tail) ? &t->overlaps[(base + s) * overlap + t->warmup] : NULL;
+            buf[l]              = &data[l * WINDOW_BLOCK_SIZE];
+
+            // The output lags behind the input, so it can be written back in place
+            float *chan         = t->sample->channel(first_ch + l);
+            body[l]             = &chan[first];
+
+            passes_output_t *o  = &out[l];
+            o->data             = &chan[first];
+            o->offset           = 0;
+            o->first            = nhead;
+            o->last             = nhead + last - first;
+            o->peak             = 0.0f;
+            o->track            = t->peaks != NULL;
+        }
+
+        if (nhead > 0)
+            feed_passes(t, vs, buf, head, lanes, nhead, out);
+        feed_passes(t, vs, buf, body, lanes, last - first, out);
+        if (has_tail)
+        {
+            // The lookahead signal is enough to produce the rest of the segment
+            feed_passes(t, vs, buf, tail, lanes, t->lookahead, out);
+        }
+        else
+        {
+            // Flush the latency of each stage and pass it through the rest of stages
+            for (size_t j=0; j<t->passes; ++j)
+            {
+                GainStage * const *gs   = &vs[j * lanes];
+                while (gs[0]->tail() > 0)
+                {
+                    size_t count        = GainStage::flush(gs, buf, lanes, WINDOW_BLOCK_SIZE);
+                    for (size_t k=j+1; k<t->passes; ++k)
+                        count               = GainStage::process(&vs[k * lanes], buf, buf, lanes, count);
+
+                    for (size_t l=0; l<lanes; ++l)
+                        write_passes(&out[l], buf[l], count);
+                }
+            }
+        }
+
+        if (t->peaks != NULL)
+        {
+            for (size_t l=0; l<lanes; ++l)
+                t->peaks[(first_ch + l) * t->segments + s]  = out[l].peak;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t process_passes(dspu::Sample *sample, size_t passes, weighting_t weight, size_t period,
+        const float *thresh, float range_db, float knee_db, gain_curve_t curve, TaskPool *pool, float *peaks,
+        ScratchArena *arena)
+    {
+        status_t res;
+        ScratchArena tmp;
+        passes_task_t t;
+        t.sample    = sample;
+        t.passes    = passes;
+        t.weight    = weight;
+        t.period    = period;
+        t.thresh    = thresh;
+        t.range_db  = range_db;
+        t.knee_db   = knee_db;
+        t.curve     = curve;
+
+        // Each pass looks ahead for the half of the period and depends on the period
+        // of the signal before, the filters and the dynamics need time to settle
+        size_t channels = sample->channels();
+        size_t length   = sample->length();
+        t.warmup    = passes * (period + size_t(SEGMENT_WARMUP * sample->sample_rate()));
+        t.lookahead = passes * (period / 2 + 1);
+        t.segments  = channel_segments(pool, channels, length,
+            lsp_max(SEGMENT_MIN_LENGTH, t.warmup + t.lookahead));
+        t.lanes     = (t.segments > 1) ? 1 : channel_lanes(pool, channels, LOCKSTEP_LANES);
+        t.overlaps  = NULL;
+        t.peaks     = NULL;
+
+        // Peaks of segments are followed by copies of the source signal around the boundaries of segments
+        size_t overlap  = t.warmup + t.lookahead;
+        size_t npeaks   = (peaks != NULL) ? channels * t.segments : 0;
+        size_t novl     = channels * (t.segments - 1) * overlap;
+        float *buf      = NULL;
+        if ((npeaks + novl) > 0)
+        {
+            if ((buf = new float[npeaks + novl]) == NULL)
+                return STATUS_NO_MEM;
+            t.peaks     = (npeaks > 0) ? buf : NULL;
+            t.overlaps  = &buf[npeaks];
+        }
+        lsp_finally {
+            if (buf != NULL)
+                delete [] buf;
+        };
+
+        // Copy the source signal around the boundaries of segments before it is overwritten
+        for (size_t i=0; i<channels; ++i)
+        {
+            const float *data   = sample->channel(i);
+            float *ovl          = &t.overlaps[i * (t.segments - 1) * overlap];
+            for (size_t s=1; s<t.segments; ++s)
+            {
+                size_t offset       = segment_offset(length, s, t.segments);
+                dsp::copy(&ovl[(s - 1) * overlap], &data[offset - t.warmup], overlap);
+            }
+        }
+
+        // Each task takes the stages from its own slot of the arena
+        size_t groups   = (channels + t.lanes - 1) / t.lanes;
+        t.arena     = (arena != NULL) ? arena : &tmp;
+        if ((res = t.arena->reserve(groups * t.segments)) != STATUS_OK)
+            return res;
+        if ((res = run_tasks(pool, groups * t.segments, process_passes_segment, &t)) != STATUS_OK)
+            return res;
+
+        if (peaks != NULL)
+        {
+            for (size_t i=0; i<channels; ++i)
+            {
+                peaks[i]        = 0.0f;
+                for (size_t s=0; s<t.segments; ++s)
+                    peaks[i]        = lsp_max(peaks[i], t.peaks[i * t.segments + s]);
+            }
+        }
+
+        return STATUS_OK;
+    }
+
+    //-------------------------------------------------------------------------
+    // PeakScanner
+    PeakScanner::PeakScanner()
+    {
+    }
+
+    PeakScanner::~PeakScanner()
+    {
+        destroy();
+    }
+
+    status_t PeakScanner::init(size_t sample_rate)
+    {
+        vPos.clear();
+        vNeg.clear();
+
+        return sDetector.init(lsp_max(sample_rate / 100, size_t(1)));
+    }
+
+    void PeakScanner::destroy()
+    {
+        sDetector.destroy();
+        vPos.flush();
+        vNeg.flush();
+    }
+
+    status_t PeakScanner::process(const float *src, size_t count)
+    {
+        return sDetector.process(NULL, &vPos, &vNeg, src, count);
+    }
+
+    status_t PeakScanner::finish(float *p_avg, float *n_avg)
+    {
+        // Examine the last sample
+        status_t res = sDetector.finish(NULL, &vPos, &vNeg);
+        if (res != STATUS_OK)
+            return res;
+
+        // Estimate median values
+        if (!median_value(p_avg, &vPos))
+            return STATUS_NO_MEM;
+        if (!median_value(n_avg, &vNeg))
+            return STATUS_NO_MEM;
+
+        return STATUS_OK;
+    }
+
+    //-------------------------------------------------------------------------
+    // PeakSmasher
+    PeakSmasher::PeakSmasher()
+    {
+        fPAvg       = 0.0f;
+        fNAvg       = 0.0f;
+        fThresh     = 1.0f;
+        fGain       = 1.0f;
+        nLast       = 0;
+        nOffset     = 0;
+    }
+
+    PeakSmasher::~PeakSmasher()
+    {
+        destroy();
+    }
+
+    status_t PeakSmasher::init(float p_avg, float n_avg, float threshold)
+    {
+        fPAvg       = p_avg;
+        fNAvg       = n_avg;
+        fThresh     = threshold;
+        fGain       = 1.0f;
+        nLast       = 0;
+        nOffset     = 0;
+
+        sHold.clear();
+        vPeaks.clear();
+
+        // Quantized peaks are not used, so the step does not matter
+        return sDetector.init(1);
+    }
+
+    void PeakSmasher::destroy()
+    {
+        sDetector.destroy();
+        sHold.destroy();
+        vPeaks.flush();
+    }
+
+    bool PeakSmasher::emit(SampleFifo *dst, size_t index, float peak)
+    {
+        float egain     = peak_gain(peak, fPAvg, fNAvg, fThresh);
+        size_t count    = index - nLast;
+
+        // Emit all samples between the previous peak and the current one
+        float *buf      = dst->reserve(count);
+        if (buf == NULL)
+            return false;
+        dsp::copy(buf, sHold.head(), count);
+        apply_peak_ramp(buf, fGain, egain, count);
+        dst->commit(count);
+        sHold.skip(count);
+
+        nLast           = index;
+        fGain           = egain;
+
+        return true;
+    }
+
+    bool PeakSmasher::split(SampleFifo *dst, size_t index)
+    {
+        // The ranges longer than the maximum ramp are split at the held samples,
+        // so the hold does not grow when there are no peaks
+        while (index - nLast > PEAK_RAMP_MAX)
+        {
+            if (!emit(dst, nLast + PEAK_RAMP_MAX, sHold.head()[PEAK_RAMP_MAX]))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool PeakSmasher::emit_peaks(SampleFifo *dst)
+    {
+        for (size_t i=0, n=vPeaks.size(); i<n; ++i)
+        {
+            const peak_t *pk    = vPeaks.uget(i);
+            if ((!split(dst, pk->index)) || (!emit(dst, pk->index, pk->gain)))
+                return false;
+        }
+        vPeaks.clear();
+
+        return true;
+    }
+
+    status_t PeakSmasher::process(SampleFifo *dst, const float *src, size_t count)
+    {
+        if (!sHold.append(src, count))
+            return STATUS_NO_MEM;
+
+        status_t res = sDetector.process(&vPeaks, NULL, NULL, src, count);
+        if (res != STATUS_OK)
+            return res;
+        nOffset        += count;
+
+        // The last sample is not examined yet, the next peak may be found there
+        if (!emit_peaks(dst))
+            return STATUS_NO_MEM;
+        return ((nOffset <= 0) || (split(dst, nOffset - 1))) ? STATUS_OK : STATUS_NO_MEM;
+    }
+
+    status_t PeakSmasher::finish(SampleFifo *dst)
+    {
+        // Examine the last sample
+        status_t res = sDetector.finish(&vPeaks, NULL, NULL);
+        if (res != STATUS_OK)
+            return res;
+        if (!emit_peaks(dst))
+            return STATUS_NO_MEM;
+
+        // Add last peak at the end of file
+        if ((!split(dst, nOffset)) || (!emit(dst, nOffset, 1.0f)))
+            return STATUS_NO_MEM;
+
+        return STATUS_OK;
+    }
+
+    //-------------------------------------------------------------------------
+    // Streaming processor
+    enum sweep_t
+    {
+        SWEEP_RMS,          // Estimate the long-time RMS
+        SWEEP_PEAKS,        // Estimate the median peak values
+        SWEEP_LEVEL,        // Estimate the peak level of the output
+        SWEEP_OUTPUT        // Write the output file
+    };
+
+    static const char *sweep_names[] =
+    {
+        "stream_rms",
+        "stream_peaks",
+        "stream_level",
+        "stream_output"
+    };
+
+    typedef struct channel_t
+    {
+        LevelMeter              sLevel;         // Long-time RMS level meter
+        GainStage              *vStages;        // Gain adjustment stages, one per pass
+        PeakScanner             sScanner;       // Peak scanner
+        PeakSmasher             sSmasher;       // Peak smasher
+        SampleFifo              sOut;           // Output data
+        float                   fRmsAvg;        // Long-time RMS maximum
+        float                   fPAvg;          // Median of positive peaks
+        float                   fNAvg;          // Median of negative peaks
+        float                   fPeak;          // Peak level of the channel
+        float                  *vIn;            // Input buffer
+        float                  *vBuf;           // Processing buffer
+    } channel_t;
+
+    typedef struct stream_t
+    {
+        const config_t         *pConfig;        // Configuration
+        const LSPString        *pInFile;        // Input file
+        const LSPString        *pOutFile;       // Output file
+        channel_t              *vChannels;      // List of channels
+        size_t                  nChannels;      // Number of channels
+        size_t                  nSampleRate;    // Sample rate
+        wssize_t                nLength;        // Length of the file in samples
+        size_t                  nBlockSize;     // Block size
+        const float            *vFrames;        // Interleaved data of the current block
+        float                  *vBuffers;       // Buffers for channels
+        TaskPool               *pPool;          // Pool of worker threads
+        Stats                  *pStats;         // Statistics of sweeps
+        size_t                  nCount;         // Number of frames in the current block
+        float                   fPeak;          // Peak level of the output
+        float                   fNormGain;      // Normalization gain
+        sweep_t                 enSweep;        // Current sweep
+    } stream_t;
+
+    static void destroy_stream(stream_t *s)
+    {
+        if (s->vChannels != NULL)
+        {
+            for (size_t i=0; i<s->nChannels; ++i)
+            {
+                channel_t *c    = &s->vChannels[i];
+                if (c->vStages != NULL)
+                {
+                    delete [] c->vStages;
+                    c->vStages      = NULL;
+                }
+            }
+            delete [] s->vChannels;
+            s->vChannels    = NULL;
+        }
+        if (s->vBuffers != NULL)
+        {
+            delete [] s->vBuffers;
+            s->vBuffers     = NULL;
+        }
+    }
+
+    static status_t init_stream(stream_t *s, const config_t *cfg, const mm::IInAudioStream *is)
+    {
+        s->pConfig      = cfg;
+        s->nChannels    = is->channels();
+        s->nSampleRate  = is->sample_rate();
+        s->nLength      = is->length();
+        s->nBlockSize   = cfg->nBlockSize;
+        s->fPeak        = 0.0f;
+        s->fNormGain    = 1.0f;
+        s->enSweep      = SWEEP_RMS;
+
+        s->vChannels    = new channel_t[s->nChannels];
+        s->vBuffers     = new float[s->nBlockSize * s->nChannels * 2];
+        if ((s->vChannels == NULL) || (s->vBuffers == NULL))
+            return STATUS_NO_MEM;
+
+        float *buf      = s->vBuffers;
+        for (size_t i=0; i<s->nChannels; ++i)
+        {
+            channel_t *c    = &s->vChannels[i];
+
+            c->vStages      = new GainStage[cfg->nPasses];
+            if (c->vStages == NULL)
+                return STATUS_NO_MEM;
+
+            c->fRmsAvg      = 0.0f;
+            c->fPAvg        = 0.0f;
+            c->fNAvg        = 0.0f;
+            c->fPeak        = 0.0f;
+            c->vIn          = buf;
+            buf            += s->nBlockSize;
+            c->vBuf         = buf;
+            buf            += s->nBlockSize;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t start_sweep(stream_t *s, sweep_t sweep)
+    {
+        status_t res;
+        const config_t *cfg = s->pConfig;
+
+        s->enSweep      = sweep;
+        s->fPeak        = 0.0f;
+
+        size_t period   = size_t(dspu::millis_to_samples(s->nSampleRate, 400.0f)) | 1;
+        size_t speriod  = size_t(dspu::millis_to_samples(s->nSampleRate, cfg->fReactivity)) | 1;
+
+        for (size_t i=0; i<s->nChannels; ++i)
+        {
+            channel_t *c    = &s->vChannels[i];
+            c->sOut.clear();
+            c->fPeak        = 0.0f;
+
+            if (sweep == SWEEP_RMS)
+            {
+                res = c->sLevel.init(s->nSampleRate, cfg->enWeighting, period, cfg->nScanDecimation);
+                if (res != STATUS_OK)
+                    return res;
+                continue;
+            }
+
+            for (ssize_t j=0; j<cfg->nPasses; ++j)
+            {
+                res = c->vStages[j].init(s->nSampleRate, s->nBlockSize, cfg->enWeighting, speriod,
+                    c->fRmsAvg, cfg->fRange, cfg->fKnee, cfg->enGainCurve);
+                if (res != STATUS_OK)
+                    return res;
+            }
+
+            if (sweep == SWEEP_PEAKS)
+                res = c->sScanner.init(s->nSampleRate);
+            else if (cfg->bEliminatePeaks)
+                res = c->sSmasher.init(c->fPAvg, c->fNAvg, cfg->fPeakThresh);
+            if (res != STATUS_OK)
+                return res;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t emit_data(stream_t *s, channel_t *c, const float *buf, size_t count)
+    {
+        if (count <= 0)
+            return STATUS_OK;
+
+        switch (s->enSweep)
+        {
+            case SWEEP_PEAKS:
+                return c->sScanner.process(buf, count);
+
+            case SWEEP_LEVEL:
+                if (!s->pConfig->bEliminatePeaks)
+                {
+                    c->fPeak        = lsp_max(c->fPeak, dsp::abs_max(buf, count));
+                    return STATUS_OK;
+                }
+                break;
+
+            default:
+                break;
+        }
+
+        // Store the data to the output
+        if (s->pConfig->bEliminatePeaks)
+            return c->sSmasher.process(&c->sOut, buf, count);
+
+        return (c->sOut.append(buf, count)) ? STATUS_OK : STATUS_NO_MEM;
+    }
+
+    static status_t process_channel(stream_t *s, channel_t *c, size_t count)
+    {
+        // Pre-scan: estimate the long-time RMS
+        if (s->enSweep == SWEEP_RMS)
+        {
+            c->sLevel.process(c->vIn, count);
+            return STATUS_OK;
+        }
+
+        // Apply all gain adjustment passes
+        const float *src    = c->vIn;
+        for (ssize_t i=0, n=s->pConfig->nPasses; i<n; ++i)
+        {
+            count               = c->vStages[i].process(c->vBuf, src, count);
+            src                 = c->vBuf;
+        }
+
+        return emit_data(s, c, c->vBuf, count);
+    }
+
+    static status_t flush_channel(stream_t *s, channel_t *c)
+    {
+        status_t res;
+
+        // Pre-scan: process the tail of the long-time RMS
+        if (s->enSweep == SWEEP_RMS)
+        {
+            for (size_t tail = c->sLevel.period(); tail > 0; )
+            {
+                size_t count        = lsp_min(tail, s->nBlockSize);
+                c->sLevel.process(NULL, count);
+                tail               -= count;
+            }
+            c->fRmsAvg          = c->sLevel.level();
+            return STATUS_OK;
+        }
+
+        // Flush the latency of each stage and pass it through the rest of stages
+        for (ssize_t i=0, n=s->pConfig->nPasses; i<n; ++i)
+        {
+            GainStage *gs       = &c->vStages[i];
+            while (gs->tail() > 0)
+            {
+                size_t count        = gs->flush(c->vBuf, s->nBlockSize);
+                for (ssize_t j=i+1; j<n; ++j)
+                    count               = c->vStages[j].process(c->vBuf, c->vBuf, count);
+
+                if ((res = emit_data(s, c, c->vBuf, count)) != STATUS_OK)
+                    return res;
+            }
+        }
+
+        // Flush the peak smasher
+        if ((s->enSweep != SWEEP_PEAKS) && (s->pConfig->bEliminatePeaks))
+            return c->sSmasher.finish(&c->sOut);
+
+        return STATUS_OK;
+    }
+
+    static status_t write_data(stream_t *s, AsyncWriter *wr)
+    {
+        // Estimate number of frames ready for output
+        size_t frames       = s->vChannels[0].sOut.size();
+        for (size_t i=1; i<s->nChannels; ++i)
+            frames              = lsp_min(frames, s->vChannels[i].sOut.size());
+
+        while (frames > 0)
+        {
+            size_t count        = lsp_min(frames, s->nBlockSize);
+
+            // Wait for the free block of the writer
+            float *frm          = NULL;
+            if (wr != NULL)
+            {
+                if ((frm = wr->buffer()) == NULL)
+                {
+                    status_t res        = wr->close();
+                    fprintf(stderr, "  could not write file '%s', error code: %d\n",
+                        s->pOutFile->get_native(), int(res));
+                    return res;
+                }
+            }
+
+            // Interleave the data
+            for (size_t i=0; i<s->nChannels; ++i)
+            {
+                channel_t *c        = &s->vChannels[i];
+                const float *src    = c->sOut.head();
+
+                if (s->enSweep == SWEEP_LEVEL)
+                    s->fPeak            = lsp_max(s->fPeak, dsp::abs_max(src, count));
+                else if (frm != NULL)
+                {
+                    float *dst          = &frm[i];
+                    for (size_t j=0; j<count; ++j, dst += s->nChannels)
+                        *dst                = src[j] * s->fNormGain;
+                }
+
+                c->sOut.skip(count);
+            }
+
+            // Pass the data to the writer
+            if (frm != NULL)
+                wr->submit(count);
+
+            frames             -= count;
+        }
+
+        return STATUS_OK;
+    }
+
+    static status_t process_block_task(void *arg, size_t index)
+    {
+        stream_t *s         = static_cast<stream_t *>(arg);
+        channel_t *c        = &s->vChannels[index];
+
+        // De-interleave the data
+        const float *src    = &s->vFrames[index];
+        for (size_t j=0; j<s->nCount; ++j, src += s->nChannels)
+            c->vIn[j]           = *src;
+
+        return process_channel(s, c, s->nCount);
+    }
+
+    static status_t flush_channel_task(void *arg, size_t index)
+    {
+        stream_t *s         = static_cast<stream_t *>(arg);
+        return flush_channel(s, &s->vChannels[index]);
+    }
+
+    static status_t run_sweep(stream_t *s, sweep_t sweep, mm::IOutAudioStream *os)
+    {
+        status_t res;
+        mm::InAudioFileStream is;
+        AsyncReader rd;
+        AsyncWriter wr;
+        const LSPString *name   = s->pInFile;
+        probe_t p;
+
+        // Open the input file
+        Stats::start(&p);
+        if ((res = is.open(name)) != STATUS_OK)
+        {
+            fprintf(stderr, "  could not read file '%s', error code: %d\n", name->get_native(), int(res));
+            return res;
+        }
+        lsp_finally { is.close(); };
+
+        if ((res = start_sweep(s, sweep)) != STATUS_OK)
+            return res;
+
+        // Decoding and encoding are performed by separate threads, so they overlap with processing
+        if ((res = rd.open(&is, s->nBlockSize)) != STATUS_OK)
+            return res;
+        lsp_finally { rd.close(); };
+
+        AsyncWriter *pwr        = NULL;
+        if (os != NULL)
+        {
+            if ((res = wr.open(os, s->nBlockSize)) != STATUS_OK)
+                return res;
+            pwr                     = &wr;
+        }
+        lsp_finally { wr.close(); };
+
+        // Process the input data
+        while (true)
+        {
+            ssize_t count       = rd.read(&s->vFrames);
+            if (count < 0)
+            {
+                if (count == -STATUS_EOF)
+                    break;
+                fprintf(stderr, "  could not read file '%s', error code: %d\n", name->get_native(), int(-count));
+                return -count;
+            }
+            else if (count == 0)
+                break;
+
+            // Process channels, the input block is released for the next read
+            s->nCount           = count;
+            res                 = run_tasks(s->pPool, s->nChannels, process_block_task, s);
+            rd.release();
+            if (res != STATUS_OK)
+                return res;
+
+            if ((res = write_data(s, pwr)) != STATUS_OK)
+                return res;
+        }
+
+        // Flush the tail of the data
+        if ((res = run_tasks(s->pPool, s->nChannels, flush_channel_task, s)) != STATUS_OK)
+            return res;
+        if ((res = write_data(s, pwr)) != STATUS_OK)
+            return res;
+
+        // Wait for the writer to encode the rest of data
+        if ((pwr != NULL) && ((res = wr.close()) != STATUS_OK))
+        {
+            fprintf(stderr, "  could not write file '%s', error code: %d\n", s->pOutFile->get_native(), int(res));
+            return res;
+        }
+
+        // Collect the peak level of channels
+        for (size_t i=0; i<s->nChannels; ++i)
+            s->fPeak            = lsp_max(s->fPeak, s->vChannels[i].fPeak);
+
+        if (s->pStats != NULL)
+            return s->pStats->commit(&p, sweep_names[sweep], -1, s->nLength * s->nChannels);
+
+        return STATUS_OK;
+    }
+
+    status_t process_stream(const config_t *cfg, const LSPString *in_file, const LSPString *out_file, TaskPool *pool, Stats *stats)
+    {
+        status_t res;
+        stream_t s;
+        mm::InAudioFileStream is;
+
+        s.vChannels     = NULL;
+        s.nChannels     = 0;
+        s.vFrames       = NULL;
+        s.vBuffers      = NULL;
+        s.pInFile       = in_file;
+        s.pOutFile      = out_file;
+        s.pPool         = pool;
+        s.pStats        = stats;
+        s.nCount        = 0;
+        lsp_finally { destroy_stream(&s); };
+
+        // Obtain the information about input file
+        if ((res = is.open(in_file)) != STATUS_OK)
+        {
+            fprintf(stderr, "  could not read file '%s', error code: %d\n", in_file->get_native(), int(res));
+            return res;
+        }
+
+        if ((cfg->nSampleRate > 0) && (size_t(cfg->nSampleRate) != is.sample_rate()))
+        {
+            fprintf(stderr, "  streaming mode does not support resampling of file '%s' to sample rate %d\n",
+                in_file->get_native(), int(cfg->nSampleRate));
+            is.close();
+            return STATUS_NOT_SUPPORTED;
+        }
+
+        res             = init_stream(&s, cfg, &is);
+        is.close();
+        if (res != STATUS_OK)
+        {
+            fprintf(stderr, "  not enough memory\n");
+            return res;
+        }
+
+        duration_t d;
+        calc_duration(&d, s.nLength, s.nSampleRate);
+        fprintf(stdout, "  streaming file: '%s', channels: %d, samples: %d, sample rate: %d, duration: %02d:%02d:%02d.%03d\n",
+            in_file->get_native(),
+            int(s.nChannels), int(s.nLength), int(s.nSampleRate),
+            int(d.h), int(d.m), int(d.s), int(d.ms));
+
+        // Estmate average RMS
+        if ((res = run_sweep(&s, SWEEP_RMS, NULL)) != STATUS_OK)
+        {
+            fprintf(stderr, "Error estimating long-time RMS value, code=%d\n", int(res));
+            return res;
+        }
+
+        // Estimate median values of peaks
+        if (cfg->bEliminatePeaks)
+        {
+            if ((res = run_sweep(&s, SWEEP_PEAKS, NULL)) != STATUS_OK)
+            {
+                fprintf(stderr, "Error smashing amplitude, error code: %d\n", int(res));
+                return res;
+            }
+            for (size_t i=0; i<s.nChannels; ++i)
+            {
+                channel_t *c    = &s.vChannels[i];
+                if ((res = c->sScanner.finish(&c->fPAvg, &c->fNAvg)) != STATUS_OK)
+                {
+                    fprintf(stderr, "Error smashing amplitude, error code: %d\n", int(res));
+                    return res;
+                }
+                c->sScanner.destroy();
+            }
+        }
+
+        // Nothing to write?
+        if (out_file->is_empty())
+            return STATUS_OK;
+
+        // Estimate the normalization gain
+        if (cfg->enNormalize != NORM_NONE)
+        {
+            if ((res = run_sweep(&s, SWEEP_LEVEL, NULL)) != STATUS_OK)
+            {
+                fprintf(stderr, "Error normalizing output audio file, error code: %d\n", int(res));
+                return res;
+            }
+            s.fNormGain     = normalize_gain(s.fPeak, dspu::db_to_gain(cfg->fNormGain), cfg->enNormalize);
+        }
+
+        // Write the output file
+        mm::OutAudioFileStream os;
+        mm::audio_stream_t fmt;
+        fmt.srate       = s.nSampleRate;
+        fmt.channels    = s.nChannels;
+        fmt.frames      = s.nLength;
+        fmt.format      = mm::SFMT_F32;
+
+        if ((res = os.open(out_file, &fmt, mm::AFMT_WAV | mm::CFMT_PCM)) != STATUS_OK)
+        {
+            fprintf(stderr, "  could not write file '%s', error code: %d\n", out_file->get_native(), int(res));
+            return res;
+        }
+
+        res             = run_sweep(&s, SWEEP_OUTPUT, &os);
+        status_t cres   = os.close();
+        if (res == STATUS_OK)
+            res             = cres;
+        if (res != STATUS_OK)
+        {
+            fprintf(stderr, "Error saving audio file '%s', code=%d\n", out_file->get_native(), int(res));
+            return res;
+        }
+
+        fprintf(stdout, "  saved file: '%s', channels: %d, samples: %d, sample rate: %d, duration: %02d:%02d:%02d.%03d\n",
+            out_file->get_native(),
+            int(s.nChannels), int(s.nLength), int(s.nSampleRate),
+            int(d.h), int(d.m), int(d.s), int(d.ms));
+
+        return STATUS_OK;
+    }
+
+} /* namespace spike_bender */
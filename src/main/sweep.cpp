@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/io/InSequence.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/ipc/Mutex.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+
+#include <private/cmdline.h>
+#include <private/context.h>
+#include <private/pool.h>
+#include <private/sweep.h>
+#include <private/tool.h>
+
+namespace spike_bender
+{
+    typedef struct sweep_t
+    {
+        const config_t             *pConfig;        // Configuration
+        lltl::parray<variant_t>    *pVariants;      // List of variants
+        const dspu::Sample         *pSample;        // Decoded input signal
+        const float                *vLevels;        // Long-time RMS level of each channel
+        ipc::Mutex                  sMutex;         // Mutex to synchronize the variant queue
+        size_t                      nNext;          // Next variant to process
+    } sweep_t;
+
+    enum sweep_field_t
+    {
+        SF_OUT_FILE,
+        SF_RANGE,
+        SF_KNEE,
+        SF_PASSES,
+        SF_PEAK_THRESH,
+        SF_NORMALIZE,
+
+        SF_TOTAL
+    };
+
+    void destroy_variants(lltl::parray<variant_t> *list)
+    {
+        for (size_t i=0, n=list->size(); i<n; ++i)
+        {
+            variant_t *v = list->uget(i);
+            if (v != NULL)
+                delete v;
+        }
+        list->flush();
+    }
+
+    static status_t parse_field(dynamics_t *dyn, LSPString *out_file, size_t index, const LSPString *field)
+    {
+        status_t res;
+        const char *val = field->get_native();
+        if (val == NULL)
+            return STATUS_NO_MEM;
+
+        switch (index)
+        {
+            case SF_OUT_FILE:
+                return (out_file->set(field)) ? STATUS_OK : STATUS_NO_MEM;
+
+            case SF_RANGE:
+                if ((res = parse_cmdline_float(&dyn->fRange, val, "dynamic range")) != STATUS_OK)
+                    return res;
+                if (dyn->fRange <= 0.0f)
+                {
+                    fprintf(stderr, "Bad dynamic range value, should be positive\n");
+                    return STATUS_BAD_ARGUMENTS;
+                }
+                return STATUS_OK;
+
+            case SF_KNEE:
+                if ((res = parse_cmdline_float(&dyn->fKnee, val, "knee")) != STATUS_OK)
+                    return res;
+                if (dyn->fKnee < 0.0f)
+                {
+                    fprintf(stderr, "Bad knee value, should be non-negative\n");
+                    return STATUS_BAD_ARGUMENTS;
+                }
+                return STATUS_OK;
+
+            case SF_PASSES:
+                if ((res = parse_cmdline_int(&dyn->nPasses, val, "number of passes")) != STATUS_OK)
+                    return res;
+                if (dyn->nPasses <= 0)
+                {
+                    fprintf(stderr, "Invalid number of passes, should be positive\n");
+                    return STATUS_BAD_ARGUMENTS;
+                }
+                return STATUS_OK;
+
+            case SF_PEAK_THRESH:
+                if ((res = parse_cmdline_float(&dyn->fPeakThresh, val, "peak-threshold")) != STATUS_OK)
+                    return res;
+                dyn->fPeakThresh    = dspu::db_to_gain(dyn->fPeakThresh);
+                return STATUS_OK;
+
+            case SF_NORMALIZE:
+                return parse_cmdline_normalize(&dyn->enNormalize, val, "normalize");
+
+            default:
+                break;
+        }
+
+        fprintf(stderr, "Too many values\n");
+        return STATUS_BAD_ARGUMENTS;
+    }
+
+    static status_t parse_variant(variant_t *v, const LSPString *line, const config_t *cfg)
+    {
+        status_t res;
+        LSPString field;
+
+        cfg->get_dynamics(&v->sDynamics);
+        v->nResult      = STATUS_OK;
+
+        // Fields are separated by tab, empty fields keep the values of the configuration
+        for (ssize_t first = 0, index = 0; first <= ssize_t(line->length()); ++index)
+        {
+            ssize_t last    = line->index_of(first, '\t');
+            if (last < 0)
+                last            = line->length();
+            if (!field.set(line, first, last))
+                return STATUS_NO_MEM;
+            field.trim();
+            first           = last + 1;
+
+            if (field.is_empty())
+                continue;
+            if ((res = parse_field(&v->sDynamics, &v->sOutFile, index, &field)) != STATUS_OK)
+                return res;
+        }
+
+        if (v->sOutFile.is_empty())
+        {
+            fprintf(stderr, "Output file name required\n");
+            return STATUS_BAD_ARGUMENTS;
+        }
+
+        return STATUS_OK;
+    }
+
+    status_t read_sweep_file(lltl::parray<variant_t> *list, const config_t *cfg)
+    {
+        status_t res;
+        io::InSequence is;
+        LSPString line;
+
+        if ((res = is.open(&cfg->sSweepFile)) != STATUS_OK)
+        {
+            fprintf(stderr, "Could not open sweep file '%s', error code: %d\n", cfg->sSweepFile.get_native(), int(res));
+            return res;
+        }
+        lsp_finally { is.close(); };
+
+        for (size_t lnum = 1; ; ++lnum)
+        {
+            if ((res = is.read_line(&line, true)) != STATUS_OK)
+            {
+                if (res == STATUS_EOF)
+                    break;
+                fprintf(stderr, "Error reading sweep file '%s', error code: %d\n", cfg->sSweepFile.get_native(), int(res));
+                return res;
+            }
+
+            // Skip empty lines and comments
+            line.trim();
+            if ((line.is_empty()) || (line.first() == '#'))
+                continue;
+
+            variant_t *v    = new variant_t;
+            if (v == NULL)
+                return STATUS_NO_MEM;
+            if (!list->add(v))
+            {
+                delete v;
+                return STATUS_NO_MEM;
+            }
+
+            if ((res = parse_variant(v, &line, cfg)) != STATUS_OK)
+            {
+                fprintf(stderr, "  at line %d of sweep file '%s'\n", int(lnum), cfg->sSweepFile.get_native());
+                return res;
+            }
+        }
+
+        return STATUS_OK;
+    }
+
+    static variant_t *next_variant(sweep_t *s)
+    {
+        variant_t *v    = NULL;
+
+        s->sMutex.lock();
+        if (s->nNext < s->pVariants->size())
+            v               = s->pVariants->uget(s->nNext++);
+        s->sMutex.unlock();
+
+        return v;
+    }
+
+    static status_t process_variant(sweep_t *s, variant_t *v, Context *ctx)
+    {
+        status_t res;
+        io::Path path;
+        dspu::Sample out;
+        probe_t p;
+
+        // Ensure that the output directory exists
+        if ((res = path.set(&v->sOutFile)) != STATUS_OK)
+            return res;
+        if ((res = path.mkparent(true)) != STATUS_OK)
+            return res;
+
+        // All variants share the decoded signal, the processing is performed in place
+        Stats::start(&p);
+        if ((res = out.copy(s->pSample)) != STATUS_OK)
+            return res;
+        if ((res = process_dynamics(s->pConfig, &v->sDynamics, &out, s->vLevels, &v->sOutFile, ctx)) != STATUS_OK)
+            return res;
+
+        return ctx->stats()->commit(&p, "total", -1, 0);
+    }
+
+    static status_t sweep_worker(void *arg, size_t)
+    {
+        sweep_t *s      = static_cast<sweep_t *>(arg);
+
+        Context ctx(s->pConfig);
+        for (variant_t *v = next_variant(s); v != NULL; v = next_variant(s))
+        {
+            v->nResult      = process_variant(s, v, &ctx);
+            ctx.stats()->swap(&v->sStats);
+
+            if (v->nResult == STATUS_OK)
+                fprintf(stdout, "[  OK  ] '%s'\n", v->sOutFile.get_native());
+            else
+                fprintf(stdout, "[FAILED] '%s', error code: %d\n", v->sOutFile.get_native(), int(v->nResult));
+            fflush(stdout);
+        }
+
+        // Do not abort processing of other variants
+        return STATUS_OK;
+    }
+
+    static status_t write_sweep_stats(const config_t *cfg, const Stats *analysis, lltl::parray<variant_t> *variants)
+    {
+        LSPString none;
+        lltl::darray<file_stats_t> list;
+        file_stats_t *fs    = list.add_n(variants->size() + 1);
+        if (fs == NULL)
+            return STATUS_NO_MEM;
+
+        // The first entry is the shared analysis of the input file
+        fs->pInFile         = &cfg->sInFile;
+        fs->pOutFile        = &none;
+        fs->nResult         = STATUS_OK;
+        fs->pStats          = analysis;
+        ++fs;
+
+        for (size_t i=0, n=variants->size(); i<n; ++i, ++fs)
+        {
+            const variant_t *v  = variants->uget(i);
+            fs->pInFile         = &cfg->sInFile;
+            fs->pOutFile        = &v->sOutFile;
+            fs->nResult         = v->nResult;
+            fs->pStats          = &v->sStats;
+        }
+
+        return write_stats(&cfg->sStatsFile, list.array(), list.size());
+    }
+
+    status_t process_sweep(const config_t *cfg)
+    {
+        status_t res;
+        lltl::parray<variant_t> variants;
+        lsp_finally { destroy_variants(&variants); };
+
+        // Build list of variants
+        if ((res = read_sweep_file(&variants, cfg)) != STATUS_OK)
+            return res;
+        if (variants.is_empty())
+        {
+            fprintf(stderr, "No variants to process\n");
+            return STATUS_NO_DATA;
+        }
+
+        // Decode and analyze the input file once for all variants
+        dspu::Sample in;
+        lltl::darray<float> levels;
+        Context ctx(cfg);
+        probe_t p;
+
+        Stats::start(&p);
+        if ((res = analyze_file(cfg, &cfg->sInFile, &in, &levels, &ctx)) != STATUS_OK)
+            return res;
+        if ((res = ctx.stats()->commit(&p, "total", -1, 0)) != STATUS_OK)
+            return res;
+
+        // Process variants
+        TaskPool pool(cfg->nJobs);
+        sweep_t s;
+        s.pConfig       = cfg;
+        s.pVariants     = &variants;
+        s.pSample       = &in;
+        s.vLevels       = levels.array();
+        s.nNext         = 0;
+        if ((res = run_tasks(&pool, lsp_min(pool.threads(), variants.size()), sweep_worker, &s)) != STATUS_OK)
+            return res;
+
+        // Output the summary
+        size_t failed   = 0;
+        res             = STATUS_OK;
+        for (size_t i=0, n=variants.size(); i<n; ++i)
+        {
+            const variant_t *v = variants.uget(i);
+            if (v->nResult == STATUS_OK)
+                continue;
+            if (res == STATUS_OK)
+                res             = v->nResult;
+            ++failed;
+        }
+
+        fprintf(stdout, "Processed %d variants, %d succeeded, %d failed\n",
+            int(variants.size()), int(variants.size() - failed), int(failed));
+
+        // Write the statistics if required
+        if (!cfg->sStatsFile.is_empty())
+        {
+            status_t sres   = write_sweep_stats(cfg, ctx.stats(), &variants);
+            if (res == STATUS_OK)
+                res             = sres;
+        }
+
+        return res;
+    }
+
+} /* namespace spike_bender */
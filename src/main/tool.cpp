@@ -27,106 +27,303 @@
 #include <private/config.h>
 #include <private/cmdline.h>
 #include <private/audio.h>
+#include <private/batch.h>
+#include <private/cache.h>
+#include <private/live.h>
+#include <private/stream.h>
+#include <private/sweep.h>
 #include <private/tool.h>
 
 namespace spike_bender
 {
-    int main(int argc, const char **argv)
+    static inline wsize_t sample_count(const dspu::Sample *s)
     {
-        lsp::dspu::Sample in, rms, out;
-        config_t cfg;
+        return wsize_t(s->length()) * s->channels();
+    }
 
-        // Parse command line
-        status_t res    = parse_cmdline(&cfg, argc, argv);
-        if (res != STATUS_OK)
-            return (res != STATUS_SKIP) ? print_usage(argv[0], true) : STATUS_OK;
+    static status_t load_cached_analysis(dspu::Sample *out, lltl::darray<float> *levels,
+        const LSPString *path, const cache_key_t *key, Stats *stats)
+    {
+        AnalysisCache cache;
+        status_t res;
+        probe_t p;
+
+        // Missing or outdated cache is not an error, the analysis is just performed again
+        Stats::start(&p);
+        if (cache.open(path, key) != STATUS_OK)
+            return STATUS_OK;
 
-        // Load audio file
-        if ((res = load_audio_file(&in, &cfg.sInFile, cfg.nSampleRate)) != STATUS_OK)
+        float *dst      = levels->add_n(cache.channels());
+        if (dst == NULL)
+            return STATUS_NO_MEM;
+        for (size_t i=0; i<cache.channels(); ++i)
+            dst[i]          = cache.level(i);
+        if ((res = cache.load(out)) != STATUS_OK)
         {
-            fprintf(stderr, "Error loading audio file '%s', code=%d\n", cfg.sInFile.get_native(), int(res));
+            levels->clear();
             return res;
         }
-        if (cfg.nSampleRate <= 0)
-            cfg.nSampleRate     = in.sample_rate();
 
-        // Estmate average RMS
-        size_t period   = size_t(dspu::millis_to_samples(cfg.nSampleRate, 400.0f)) | 1;
-        if ((res = estimate_rms(&rms, &in, cfg.enWeighting, period)) != STATUS_OK)
+        fprintf(stdout, "  loaded analysis: '%s', channels: %d, samples: %d, sample rate: %d\n",
+            path->get_native(), int(out->channels()), int(out->length()), int(out->sample_rate()));
+
+        return stats->commit(&p, "cache_load", -1, sample_count(out));
+    }
+
+    status_t analyze_file(const config_t *cfg, const LSPString *in_file, dspu::Sample *out,
+        lltl::darray<float> *levels, Context *ctx)
+    {
+        Stats *stats    = ctx->stats();
+        status_t res;
+        probe_t p;
+
+        levels->clear();
+
+        // Look up the analysis cache, the analysis does not depend on the dynamics parameters
+        cache_key_t key;
+        LSPString cache;
+        if (!cfg->sCacheDir.is_empty())
         {
-            fprintf(stderr, "Error estimating long-time RMS value, code=%d\n", int(res));
+            if ((res = make_cache_key(&key, in_file, cfg)) != STATUS_OK)
+            {
+                fprintf(stderr, "Error reading audio file '%s', code=%d\n", in_file->get_native(), int(res));
+                return res;
+            }
+            if ((res = make_cache_path(&cache, &cfg->sCacheDir, &key)) != STATUS_OK)
+                return res;
+            if ((res = load_cached_analysis(out, levels, &cache, &key, stats)) != STATUS_OK)
+            {
+                fprintf(stderr, "Error loading analysis cache '%s', code=%d\n", cache.get_native(), int(res));
+                return res;
+            }
+            if (!levels->is_empty())
+                return STATUS_OK;
+        }
+
+        // Load audio file, all further processing is performed in place
+        if ((res = load_audio_file(out, in_file, cfg->nSampleRate, cfg->enResample, stats)) != STATUS_OK)
+        {
+            fprintf(stderr, "Error loading audio file '%s', code=%d\n", in_file->get_native(), int(res));
             return res;
         }
 
-        float *rms_avg = new float[rms.length()];
+        // Estmate average RMS, only the maximum of each channel is required
+        Stats::start(&p);
+        float *rms_avg  = levels->add_n(out->channels());
         if (rms_avg == NULL)
         {
             fprintf(stderr, "Not enough memory\n");
             return STATUS_NO_MEM;
         }
-        lsp_finally { delete[] rms_avg; };
-        for (size_t i=0; i<rms.channels(); ++i)
-            rms_avg[i]      = dsp::abs_max(rms.channel(i), rms.length());
 
-        // Do the processing
-        for (ssize_t i=0; i<cfg.nPasses; ++i)
+        size_t period   = size_t(dspu::millis_to_samples(out->sample_rate(), 400.0f)) | 1;
+        res             = estimate_rms_peak(rms_avg, out, cfg->enWeighting, period, cfg->nScanDecimation,
+                            ctx->pool(), ctx->arena());
+        if (res != STATUS_OK)
+        {
+            fprintf(stderr, "Error estimating long-time RMS value, code=%d\n", int(res));
+            return res;
+        }
+        if ((res = stats->commit(&p, "rms_avg", -1, sample_count(out))) != STATUS_OK)
+            return res;
+
+        // Store the analysis, failure to write the cache does not abort processing
+        if (!cache.is_empty())
         {
-            // Commit output to input
-            const dspu::Sample *src = (i > 0) ? &out : &in;
+            Stats::start(&p);
+            if ((res = AnalysisCache::save(&cache, &key, out, rms_avg)) != STATUS_OK)
+                fprintf(stderr, "Error writing analysis cache '%s', code=%d\n", cache.get_native(), int(res));
+            else if ((res = stats->commit(&p, "cache_save", -1, sample_count(out))) != STATUS_OK)
+                return res;
+        }
+
+        return STATUS_OK;
+    }
 
-            // Estmate short-time weighted RMS
-            period          = size_t(dspu::millis_to_samples(cfg.nSampleRate, cfg.fReactivity)) | 1;
+    status_t process_dynamics(const config_t *cfg, const dynamics_t *dyn, dspu::Sample *out,
+        const float *rms_avg, const LSPString *out_file, Context *ctx)
+    {
+        ControlBuffer rms;
+        TaskPool *pool  = ctx->pool();
+        ScratchArena *arena = ctx->arena();
+        Stats *stats    = ctx->stats();
+        status_t res;
+        probe_t p;
+
+        size_t srate    = (cfg->nSampleRate > 0) ? cfg->nSampleRate : out->sample_rate();
+        size_t period   = size_t(dspu::millis_to_samples(srate, cfg->fReactivity)) | 1;
+
+        // The peaks of the output are tracked by the last processing stage if normalization is required
+        lltl::darray<float> peaks;
+        float *vpeaks   = NULL;
+        if ((!out_file->is_empty()) && (dyn->enNormalize != NORM_NONE))
+        {
+            if ((vpeaks = peaks.append_n(lsp_max(out->channels(), size_t(1)))) == NULL)
+                return STATUS_NO_MEM;
+            dsp::fill_zero(vpeaks, peaks.size());
+        }
+        float *last_peaks   = (cfg->bEliminatePeaks) ? NULL : vpeaks;
+        bool tracked    = (cfg->bEliminatePeaks) || (dyn->nPasses > 0);
 
-            if ((res = estimate_rms(&rms, src, cfg.enWeighting, period)) != STATUS_OK)
+        // Do the processing: chain all passes in a single sweep if the control path is not decimated
+        if (cfg->nDecimation <= 1)
+        {
+            Stats::start(&p);
+            if ((res = process_passes(out, dyn->nPasses, cfg->enWeighting, period, rms_avg, dyn->fRange, dyn->fKnee,
+                cfg->enGainCurve, pool, last_peaks, arena)) != STATUS_OK)
             {
-                fprintf(stderr, "Error estimating short-time RMS value for pass #%d, code=%d\n",
-                    int(i), int(res));
+                fprintf(stderr, "Error adjusting gain, code=%d\n", int(res));
                 return res;
             }
-            if ((res = rms.remove(0, period / 2)) != STATUS_OK)
-            {
-                fprintf(stderr, "Error cutting sample for pass #%d, code=%d\n", int(i), int(res));
+            if ((res = stats->commit(&p, "passes", -1, sample_count(out) * dyn->nPasses)) != STATUS_OK)
                 return res;
-            }
-
-            // Adjust the gain
-            if ((res = adjust_gain(&out, NULL, src, &rms, rms_avg, cfg.fRange, cfg.fKnee)) != STATUS_OK)
+        }
+        else
+        {
+            for (ssize_t i=0; i<dyn->nPasses; ++i)
             {
-                fprintf(stderr, "Error adjusting gain for pass #%d, code=%d\n", int(i), int(res));
-                return res;
+                // Estmate short-time weighted RMS, release the previous one before
+                rms.destroy();
+
+                Stats::start(&p);
+                if ((res = estimate_control_rms(&rms, out, cfg->enWeighting, period, cfg->nDecimation,
+                    cfg->enControlFormat, pool, arena)) != STATUS_OK)
+                {
+                    fprintf(stderr, "Error estimating short-time RMS value for pass #%d, code=%d\n",
+                        int(i), int(res));
+                    return res;
+                }
+                if ((res = stats->commit(&p, "rms", i, sample_count(out))) != STATUS_OK)
+                    return res;
+
+                // Adjust the gain, the RMS latency is compensated by the offset
+                Stats::start(&p);
+                if ((res = adjust_control_gain(out, out, &rms, period / 2, cfg->nDecimation, rms_avg, dyn->fRange, dyn->fKnee,
+                    cfg->enGainCurve, pool, arena, (i + 1 >= dyn->nPasses) ? last_peaks : NULL)) != STATUS_OK)
+                {
+                    fprintf(stderr, "Error adjusting gain for pass #%d, code=%d\n", int(i), int(res));
+                    return res;
+                }
+                if ((res = stats->commit(&p, "gain", i, sample_count(out))) != STATUS_OK)
+                    return res;
             }
         }
 
         // Smash peaks?
-        if (cfg.bEliminatePeaks)
+        if (cfg->bEliminatePeaks)
         {
-            if ((res = smash_amplitude(&out, &out, cfg.fPeakThresh)) != STATUS_OK)
+            Stats::start(&p);
+            if ((res = smash_amplitude(out, out, dyn->fPeakThresh, pool, arena, vpeaks)) != STATUS_OK)
             {
                 fprintf(stderr, "Error smashing amplitude, error code: %d\n", int(res));
                 return res;
             }
+            if ((res = stats->commit(&p, "smash", -1, sample_count(out))) != STATUS_OK)
+                return res;
         }
 
         // Write result
-        if (!cfg.sOutFile.is_empty())
+        if (!out_file->is_empty())
         {
-            // Normalize if required
-            float ngain         = dspu::db_to_gain(cfg.fNormGain);
-            if ((res = normalize(&out, ngain, cfg.enNormalize)) != STATUS_OK)
+            // Normalize if required, the gain is applied while encoding
+            float ngain         = 1.0f;
+            if (vpeaks != NULL)
             {
-                fprintf(stderr, "Error normalizing output audio file, error code: %d\n", int(res));
-                return res;
+                if ((!tracked) && ((res = estimate_peaks(out, vpeaks, pool)) != STATUS_OK))
+                {
+                    fprintf(stderr, "Error normalizing output audio file, error code: %d\n", int(res));
+                    return res;
+                }
+
+                float peak          = 0.0f;
+                for (size_t i=0, n=peaks.size(); i<n; ++i)
+                    peak                = lsp_max(peak, vpeaks[i]);
+                ngain               = normalize_gain(peak, dspu::db_to_gain(cfg->fNormGain), dyn->enNormalize);
             }
 
-            if ((res = save_audio_file(&out, &cfg.sOutFile)) != STATUS_OK)
+            Stats::start(&p);
+            if ((res = save_audio_file(out, out_file, ngain)) != STATUS_OK)
             {
-                fprintf(stderr, "Error saving audio file '%s', code=%d\n", cfg.sOutFile.get_native(), int(res));
+                fprintf(stderr, "Error saving audio file '%s', code=%d\n", out_file->get_native(), int(res));
                 return res;
             }
+            if ((res = stats->commit(&p, "encode", -1, sample_count(out))) != STATUS_OK)
+                return res;
         }
 
         return STATUS_OK;
     }
+
+    static status_t process_sample(const config_t *cfg, const LSPString *in_file, const LSPString *out_file, Context *ctx)
+    {
+        lsp::dspu::Sample out;
+        lltl::darray<float> levels;
+        dynamics_t dyn;
+        status_t res;
+
+        if ((res = analyze_file(cfg, in_file, &out, &levels, ctx)) != STATUS_OK)
+            return res;
+
+        cfg->get_dynamics(&dyn);
+        return process_dynamics(cfg, &dyn, &out, levels.array(), out_file, ctx);
+    }
+
+    status_t process_file(const config_t *cfg, const LSPString *in_file, const LSPString *out_file, Context *ctx)
+    {
+        status_t res;
+        probe_t p;
+
+        // Process the file block by block if required
+        Stats::start(&p);
+        res = (cfg->bStreaming) ?
+            process_stream(cfg, in_file, out_file, ctx->pool(), ctx->stats()) :
+            process_sample(cfg, in_file, out_file, ctx);
+        if (res != STATUS_OK)
+            return res;
+
+        return ctx->stats()->commit(&p, "total", -1, 0);
+    }
+
+    int main(int argc, const char **argv)
+    {
+        config_t cfg;
+
+        // Parse command line
+        status_t res    = parse_cmdline(&cfg, argc, argv);
+        if (res != STATUS_OK)
+            return (res != STATUS_SKIP) ? print_usage(argv[0], true) : STATUS_OK;
+
+        // Process the batch of files if required
+        if (cfg.is_batch())
+            return process_batch(&cfg);
+
+        // Process all variants of the parameter sweep if required
+        if (cfg.is_sweep())
+            return process_sweep(&cfg);
+
+        // Create the processing context and process the file or the live stream
+        Context ctx(&cfg);
+        if (cfg.bLive)
+            res             = process_live(&cfg, ctx.stats());
+        else
+            res             = process_file(&cfg, &cfg.sInFile, &cfg.sOutFile, &ctx);
+
+        // Write the statistics if required
+        if (!cfg.sStatsFile.is_empty())
+        {
+            file_stats_t fs;
+            fs.pInFile      = &cfg.sInFile;
+            fs.pOutFile     = &cfg.sOutFile;
+            fs.nResult      = res;
+            fs.pStats       = ctx.stats();
+
+            status_t sres   = write_stats(&cfg.sStatsFile, &fs, 1);
+            if (res == STATUS_OK)
+                res             = sres;
+        }
+
+        return res;
+    }
 } /* namespace spike_bender */
 
 
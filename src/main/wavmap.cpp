@@ -0,0 +1,724 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/wavmap.h>
+
+#if defined(PLATFORM_WINDOWS)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <stdlib.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif /* PLATFORM_WINDOWS */
+
+namespace spike_bender
+{
+    static constexpr uint16_t WAV_FORMAT_PCM        = 0x0001;
+    static constexpr uint16_t WAV_FORMAT_IEEE_FLOAT = 0x0003;
+    static constexpr uint16_t WAV_FORMAT_EXTENSIBLE = 0xfffe;
+    static constexpr size_t WAV_HEADER_SIZE         = 12 + 8 + 16 + 8;                  // RIFF, 'fmt ', 'data'
+    static constexpr size_t RF64_HEADER_SIZE        = WAV_HEADER_SIZE + 8 + 28;         // Additional 'ds64'
+    static constexpr size_t MAPPED_TEMP_ATTEMPTS    = 16;                               // Attempts to create the unique temporary file
+
+    static inline uint16_t get_u16(const uint8_t *p)
+    {
+        return uint16_t(p[0]) | (uint16_t(p[1]) << 8);
+    }
+
+    static inline uint32_t get_u32(const uint8_t *p)
+    {
+        return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+    }
+
+    static inline int32_t get_s24(const uint8_t *p)
+    {
+        return int32_t((uint32_t(p[0]) << 8) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 24)) >> 8;
+    }
+
+    static inline uint64_t get_u64(const uint8_t *p)
+    {
+        return uint64_t(get_u32(p)) | (uint64_t(get_u32(&p[4])) << 32);
+    }
+
+    static inline uint8_t *put_u16(uint8_t *p, uint16_t v)
+    {
+        p[0]        = uint8_t(v);
+        p[1]        = uint8_t(v >> 8);
+        return &p[2];
+    }
+
+    static inline uint8_t *put_u32(uint8_t *p, uint32_t v)
+    {
+        p[0]        = uint8_t(v);
+        p[1]        = uint8_t(v >> 8);
+        p[2]        = uint8_t(v >> 16);
+        p[3]        = uint8_t(v >> 24);
+        return &p[4];
+    }
+
+    static inline uint8_t *put_u64(uint8_t *p, uint64_t v)
+    {
+        p           = put_u32(p, uint32_t(v));
+        return put_u32(p, uint32_t(v >> 32));
+    }
+
+    static inline uint8_t *put_id(uint8_t *p, const char *id)
+    {
+        memcpy(p, id, 4);
+        return &p[4];
+    }
+
+    //-------------------------------------------------------------------------
+    // MappedFile
+    MappedFile::MappedFile()
+    {
+        pData       = NULL;
+        nSize       = 0;
+    #if defined(PLATFORM_WINDOWS)
+        hFile       = INVALID_HANDLE_VALUE;
+        hMapping    = NULL;
+    #else
+        hFd         = -1;
+    #endif /* PLATFORM_WINDOWS */
+    }
+
+    MappedFile::~MappedFile()
+    {
+        close();
+    }
+
+#if defined(PLATFORM_WINDOWS)
+    static status_t map_file(HANDLE fd, bool write, wsize_t size, void **mapping, uint8_t **data)
+    {
+        HANDLE hm       = CreateFileMappingW(fd, NULL, (write) ? PAGE_READWRITE : PAGE_READONLY,
+                            DWORD(size >> 32), DWORD(size & 0xffffffff), NULL);
+        if (hm == NULL)
+            return STATUS_IO_ERROR;
+
+        void *ptr       = MapViewOfFile(hm, (write) ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, 0);
+        if (ptr == NULL)
+        {
+            CloseHandle(hm);
+            return STATUS_IO_ERROR;
+        }
+
+        *mapping        = hm;
+        *data           = static_cast<uint8_t *>(ptr);
+
+        return STATUS_OK;
+    }
+
+    status_t MappedFile::open(const LSPString *path)
+    {
+        close();
+
+        HANDLE fd       = CreateFileW(reinterpret_cast<LPCWSTR>(path->get_utf16()), GENERIC_READ,
+                            FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (fd == INVALID_HANDLE_VALUE)
+            return STATUS_NOT_FOUND;
+
+        LARGE_INTEGER size;
+        if ((!GetFileSizeEx(fd, &size)) || (size.QuadPart <= 0))
+        {
+            CloseHandle(fd);
+            return STATUS_BAD_FORMAT;
+        }
+
+        status_t res    = map_file(fd, false, size.QuadPart, &hMapping, &pData);
+        if (res != STATUS_OK)
+        {
+            CloseHandle(fd);
+            return res;
+        }
+
+        hFile           = fd;
+        nSize           = size.QuadPart;
+
+        return STATUS_OK;
+    }
+
+    status_t MappedFile::create(const LSPString *path, wsize_t size)
+    {
+        close();
+
+        HANDLE fd       = CreateFileW(reinterpret_cast<LPCWSTR>(path->get_utf16()), GENERIC_READ | GENERIC_WRITE,
+                            0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (fd == INVALID_HANDLE_VALUE)
+            return STATUS_PERMISSION_DENIED;
+
+        status_t res    = map_file(fd, true, size, &hMapping, &pData);
+        if (res != STATUS_OK)
+        {
+            CloseHandle(fd);
+            return res;
+        }
+
+        hFile           = fd;
+        nSize           = size;
+
+        return STATUS_OK;
+    }
+
+    status_t MappedFile::create_temp(const LSPString *path, wsize_t size)
+    {
+        close();
+
+        // The name is unique for the process and the attempt, the existing file is never opened
+        HANDLE fd       = INVALID_HANDLE_VALUE;
+        for (size_t i=0; (fd == INVALID_HANDLE_VALUE) && (i < MAPPED_TEMP_ATTEMPTS); ++i)
+        {
+            if ((!sTemp.set(path)) ||
+                (!sTemp.fmt_append_ascii(".%lx-%lx.tmp", long(GetCurrentProcessId()), long(GetTickCount() + i))))
+            {
+                sTemp.truncate();
+                return STATUS_NO_MEM;
+            }
+            fd              = CreateFileW(reinterpret_cast<LPCWSTR>(sTemp.get_utf16()), GENERIC_READ | GENERIC_WRITE,
+                                0, NULL, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, NULL);
+        }
+        if (fd == INVALID_HANDLE_VALUE)
+        {
+            sTemp.truncate();
+            return STATUS_PERMISSION_DENIED;
+        }
+
+        hFile           = fd;
+        if ((!sPath.set(path)) || (map_file(fd, true, size, &hMapping, &pData) != STATUS_OK))
+        {
+            close();
+            return STATUS_IO_ERROR;
+        }
+        nSize           = size;
+
+        return STATUS_OK;
+    }
+
+    status_t MappedFile::commit()
+    {
+        if (sTemp.is_empty())
+            return STATUS_BAD_STATE;
+
+        // The file can not be moved while it is mapped
+        LSPString temp;
+        temp.swap(&sTemp);
+        status_t res    = close();
+        if ((res == STATUS_OK) &&
+            (!MoveFileExW(reinterpret_cast<LPCWSTR>(temp.get_utf16()), reinterpret_cast<LPCWSTR>(sPath.get_utf16()),
+                MOVEFILE_REPLACE_EXISTING)))
+            res             = STATUS_IO_ERROR;
+        if (res != STATUS_OK)
+            DeleteFileW(reinterpret_cast<LPCWSTR>(temp.get_utf16()));
+        sPath.truncate();
+
+        return res;
+    }
+
+    status_t MappedFile::close()
+    {
+        status_t res    = STATUS_OK;
+
+        if (pData != NULL)
+        {
+            if (!UnmapViewOfFile(pData))
+                res             = STATUS_IO_ERROR;
+            pData           = NULL;
+        }
+        if (hMapping != NULL)
+        {
+            CloseHandle(hMapping);
+            hMapping        = NULL;
+        }
+        if (hFile != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(hFile);
+            hFile           = INVALID_HANDLE_VALUE;
+        }
+        if (!sTemp.is_empty())
+        {
+            DeleteFileW(reinterpret_cast<LPCWSTR>(sTemp.get_utf16()));
+            sTemp.truncate();
+            sPath.truncate();
+        }
+        nSize           = 0;
+
+        return res;
+    }
+#else
+    status_t MappedFile::open(const LSPString *path)
+    {
+        close();
+
+        int fd          = ::open(path->get_native(), O_RDONLY);
+        if (fd < 0)
+            return STATUS_NOT_FOUND;
+
+        struct stat st;
+        if ((fstat(fd, &st) != 0) || (!S_ISREG(st.st_mode)) || (st.st_size <= 0))
+        {
+            ::close(fd);
+            return STATUS_BAD_FORMAT;
+        }
+
+        void *ptr       = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            ::close(fd);
+            return STATUS_IO_ERROR;
+        }
+        madvise(ptr, st.st_size, MADV_SEQUENTIAL);
+
+        hFd             = fd;
+        pData           = static_cast<uint8_t *>(ptr);
+        nSize           = st.st_size;
+
+        return STATUS_OK;
+    }
+
+    status_t MappedFile::create(const LSPString *path, wsize_t size)
+    {
+        close();
+
+        int fd          = ::open(path->get_native(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return STATUS_PERMISSION_DENIED;
+
+        if (ftruncate(fd, off_t(size)) != 0)
+        {
+            ::close(fd);
+            return STATUS_IO_ERROR;
+        }
+
+        void *ptr       = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            ::close(fd);
+            return STATUS_IO_ERROR;
+        }
+
+        hFd             = fd;
+        pData           = static_cast<uint8_t *>(ptr);
+        nSize           = size;
+
+        return STATUS_OK;
+    }
+
+    status_t MappedFile::create_temp(const LSPString *path, wsize_t size)
+    {
+        close();
+
+        // The template is replaced by the unique name, the existing file is never opened
+        if ((!sTemp.set(path)) || (!sTemp.append_ascii(".XXXXXX")) || (!sPath.set(path)))
+        {
+            close();
+            return STATUS_NO_MEM;
+        }
+        size_t len      = strlen(sTemp.get_native());
+        char *name      = new char[len + 1];
+        if (name == NULL)
+        {
+            close();
+            return STATUS_NO_MEM;
+        }
+        lsp_finally { delete [] name; };
+        memcpy(name, sTemp.get_native(), len + 1);
+
+        int fd          = mkstemp(name);
+        if (fd < 0)
+        {
+            sTemp.truncate();
+            sPath.truncate();
+            return STATUS_PERMISSION_DENIED;
+        }
+        hFd             = fd;
+        if ((!sTemp.set_native(name)) || (fchmod(fd, 0644) != 0) || (ftruncate(fd, off_t(size)) != 0))
+        {
+            close();
+            return STATUS_IO_ERROR;
+        }
+
+        void *ptr       = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (ptr == MAP_FAILED)
+        {
+            close();
+            return STATUS_IO_ERROR;
+        }
+
+        pData           = static_cast<uint8_t *>(ptr);
+        nSize           = size;
+
+        return STATUS_OK;
+    }
+
+    status_t MappedFile::commit()
+    {
+        if (sTemp.is_empty())
+            return STATUS_BAD_STATE;
+
+        // The readers of the replaced file keep its data until they close it
+        LSPString temp;
+        temp.swap(&sTemp);
+        status_t res    = close();
+        if ((res == STATUS_OK) && (rename(temp.get_native(), sPath.get_native()) != 0))
+            res             = STATUS_IO_ERROR;
+        if (res != STATUS_OK)
+            unlink(temp.get_native());
+        sPath.truncate();
+
+        return res;
+    }
+
+    status_t MappedFile::close()
+    {
+        status_t res    = STATUS_OK;
+
+        if (pData != NULL)
+        {
+            if (munmap(pData, nSize) != 0)
+                res             = STATUS_IO_ERROR;
+            pData           = NULL;
+        }
+        if (hFd >= 0)
+        {
+            if (::close(hFd) != 0)
+                res             = STATUS_IO_ERROR;
+            hFd             = -1;
+        }
+        if (!sTemp.is_empty())
+        {
+            unlink(sTemp.get_native());
+            sTemp.truncate();
+            sPath.truncate();
+        }
+        nSize           = 0;
+
+        return res;
+    }
+#endif /* PLATFORM_WINDOWS */
+
+    //-------------------------------------------------------------------------
+    // WavReader
+    WavReader::WavReader()
+    {
+        pFrames     = NULL;
+        nFrames     = 0;
+        nChannels   = 0;
+        nSampleRate = 0;
+        nFrameSize  = 0;
+        nSampleSize = 0;
+        enEncoding  = ENC_F32;
+    }
+
+    WavReader::~WavReader()
+    {
+        close();
+    }
+
+    status_t WavReader::open(const LSPString *path)
+    {
+        status_t res;
+
+        close();
+        if ((res = sFile.open(path)) != STATUS_OK)
+            return res;
+        if ((res = parse()) != STATUS_OK)
+            close();
+
+        return res;
+    }
+
+    status_t WavReader::close()
+    {
+        pFrames     = NULL;
+        nFrames     = 0;
+        nChannels   = 0;
+        return sFile.close();
+    }
+
+    status_t WavReader::parse()
+    {
+        const uint8_t *data = sFile.data();
+        const wsize_t size  = sFile.size();
+
+        // Check the header of the file
+        if (size < 12)
+            return STATUS_UNSUPPORTED_FORMAT;
+        bool rf64           = memcmp(data, "RF64", 4) == 0;
+        if (((!rf64) && (memcmp(data, "RIFF", 4) != 0)) || (memcmp(&data[8], "WAVE", 4) != 0))
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        // Scan chunks
+        uint64_t data_size  = 0;
+        const uint8_t *fmt  = NULL;
+        size_t fmt_size     = 0;
+        bool ds64           = false;
+        for (wsize_t off = 12; off + 8 <= size; )
+        {
+            const uint8_t *chunk    = &data[off];
+            uint64_t csize          = get_u32(&chunk[4]);
+            off                    += 8;
+
+            if ((rf64) && (memcmp(chunk, "ds64", 4) == 0))
+            {
+                if ((csize < 24) || (off + csize > size))
+                    return STATUS_CORRUPTED_FILE;
+                data_size               = get_u64(&chunk[16]);
+                ds64                    = true;
+            }
+            else if (memcmp(chunk, "fmt ", 4) == 0)
+            {
+                if ((csize < 16) || (off + csize > size))
+                    return STATUS_CORRUPTED_FILE;
+                fmt                     = &chunk[8];
+                fmt_size                = csize;
+            }
+            else if (memcmp(chunk, "data", 4) == 0)
+            {
+                if (fmt == NULL)
+                    return STATUS_UNSUPPORTED_FORMAT;
+                // The size of the data in RF64 file is stored in 'ds64' chunk
+                if ((!rf64) || (csize != 0xffffffff))
+                    data_size               = csize;
+                else if (!ds64)
+                    return STATUS_CORRUPTED_FILE;
+                pFrames                 = &data[off];
+                data_size               = lsp_min(data_size, uint64_t(size - off));
+                break;
+            }
+
+            // Chunks are aligned to the even number of bytes
+            off                    += csize + (csize & 1);
+        }
+        if (pFrames == NULL)
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        // Parse the format
+        uint16_t tag        = get_u16(&fmt[0]);
+        nChannels           = get_u16(&fmt[2]);
+        nSampleRate         = get_u32(&fmt[4]);
+        nFrameSize          = get_u16(&fmt[12]);
+        size_t bits         = get_u16(&fmt[14]);
+        if ((tag == WAV_FORMAT_EXTENSIBLE) && (fmt_size >= 40))
+            tag                 = get_u16(&fmt[24]);
+
+        if ((nChannels <= 0) || (nSampleRate <= 0))
+            return STATUS_CORRUPTED_FILE;
+
+        nSampleSize         = (bits + 7) / 8;
+        if (nFrameSize < nSampleSize * nChannels)
+            return STATUS_CORRUPTED_FILE;
+
+        if (tag == WAV_FORMAT_PCM)
+        {
+            switch (nSampleSize)
+            {
+                case 1: enEncoding  = ENC_U8; break;
+                case 2: enEncoding  = ENC_S16; break;
+                case 3: enEncoding  = ENC_S24; break;
+                case 4: enEncoding  = ENC_S32; break;
+                default:
+                    return STATUS_UNSUPPORTED_FORMAT;
+            }
+        }
+        else if (tag == WAV_FORMAT_IEEE_FLOAT)
+        {
+            switch (bits)
+            {
+                case 32: enEncoding = ENC_F32; break;
+                case 64: enEncoding = ENC_F64; break;
+                default:
+                    return STATUS_UNSUPPORTED_FORMAT;
+            }
+        }
+        else
+            return STATUS_UNSUPPORTED_FORMAT;
+
+        nFrames             = data_size / nFrameSize;
+
+        return STATUS_OK;
+    }
+
+    size_t WavReader::read(float *dst, size_t channel, wsize_t offset, size_t count) const
+    {
+        if ((channel >= nChannels) || (offset >= nFrames))
+            return 0;
+        count               = lsp_min(wsize_t(count), nFrames - offset);
+
+        const size_t step   = nFrameSize;
+        const uint8_t *p    = &pFrames[offset * step + channel * nSampleSize];
+
+        switch (enEncoding)
+        {
+            case ENC_U8:
+                for (size_t i=0; i<count; ++i, p += step)
+                    dst[i]              = (float(p[0]) - 128.0f) * (1.0f / 128.0f);
+                break;
+            case ENC_S16:
+                for (size_t i=0; i<count; ++i, p += step)
+                    dst[i]              = float(int16_t(get_u16(p))) * (1.0f / 0x8000);
+                break;
+            case ENC_S24:
+                for (size_t i=0; i<count; ++i, p += step)
+                    dst[i]              = float(get_s24(p)) * (1.0f / 0x800000);
+                break;
+            case ENC_S32:
+                for (size_t i=0; i<count; ++i, p += step)
+                    dst[i]              = float(int32_t(get_u32(p))) * (1.0f / 0x80000000);
+                break;
+            case ENC_F32:
+                for (size_t i=0; i<count; ++i, p += step)
+                {
+                    uint32_t v          = get_u32(p);
+                    memcpy(&dst[i], &v, sizeof(float));
+                }
+                break;
+            case ENC_F64:
+                for (size_t i=0; i<count; ++i, p += step)
+                {
+                    uint64_t v          = get_u64(p);
+                    double d;
+                    memcpy(&d, &v, sizeof(double));
+                    dst[i]              = float(d);
+                }
+                break;
+        }
+
+        return count;
+    }
+
+    //-------------------------------------------------------------------------
+    // WavWriter
+    WavWriter::WavWriter()
+    {
+        pFrames     = NULL;
+        nFrames     = 0;
+        nChannels   = 0;
+    }
+
+    WavWriter::~WavWriter()
+    {
+        close();
+    }
+
+    status_t WavWriter::open(const LSPString *path, size_t channels, size_t sample_rate, wsize_t frames)
+    {
+        status_t res;
+
+        close();
+        if ((channels <= 0) || (channels > 0xffff) || (sample_rate <= 0))
+            return STATUS_BAD_ARGUMENTS;
+
+        // Use RF64 if the file does not fit into the 32-bit RIFF
+        const size_t frame_size = channels * sizeof(float);
+        const uint64_t data_size= uint64_t(frames) * frame_size;
+        const bool rf64         = data_size + RF64_HEADER_SIZE > 0xffffffffu;
+        const size_t header     = (rf64) ? RF64_HEADER_SIZE : WAV_HEADER_SIZE;
+
+        if ((res = sFile.create(path, header + data_size)) != STATUS_OK)
+            return res;
+
+        // Write the header
+        uint8_t *p              = sFile.data();
+        if (rf64)
+        {
+            p                       = put_id(p, "RF64");
+            p                       = put_u32(p, 0xffffffff);
+            p                       = put_id(p, "WAVE");
+            p                       = put_id(p, "ds64");
+            p                       = put_u32(p, 28);
+            p                       = put_u64(p, header + data_size - 8);   // Size of RIFF
+            p                       = put_u64(p, data_size);                // Size of data
+            p                       = put_u64(p, frames);                   // Number of frames
+            p                       = put_u32(p, 0);                        // Table length
+        }
+        else
+        {
+            p                       = put_id(p, "RIFF");
+            p                       = put_u32(p, uint32_t(header + data_size - 8));
+            p                       = put_id(p, "WAVE");
+        }
+
+        p                       = put_id(p, "fmt ");
+        p                       = put_u32(p, 16);
+        p                       = put_u16(p, WAV_FORMAT_IEEE_FLOAT);
+        p                       = put_u16(p, uint16_t(channels));
+        p                       = put_u32(p, uint32_t(sample_rate));
+        p                       = put_u32(p, uint32_t(sample_rate * frame_size));
+        p                       = put_u16(p, uint16_t(frame_size));
+        p                       = put_u16(p, 32);
+
+        p                       = put_id(p, "data");
+        p                       = put_u32(p, (rf64) ? 0xffffffff : uint32_t(data_size));
+
+        pFrames                 = p;
+        nFrames                 = frames;
+        nChannels               = channels;
+
+        return STATUS_OK;
+    }
+
+    status_t WavWriter::close()
+    {
+        pFrames     = NULL;
+        nFrames     = 0;
+        nChannels   = 0;
+        return sFile.close();
+    }
+
+    size_t WavWriter::write(size_t channel, const float *src, wsize_t offset, size_t count, float gain)
+    {
+        if ((channel >= nChannels) || (offset >= nFrames))
+            return 0;
+        count               = lsp_min(wsize_t(count), nFrames - offset);
+
+        const size_t step   = nChannels * sizeof(float);
+        uint8_t *p          = &pFrames[offset * step + channel * sizeof(float)];
+
+        for (size_t i=0; i<count; ++i, p += step)
+        {
+            uint32_t v;
+            float s             = src[i] * gain;
+            memcpy(&v, &s, sizeof(float));
+            put_u32(p, v);
+        }
+
+        return count;
+    }
+
+    bool is_wav_file(const LSPString *path)
+    {
+        io::Path p;
+        LSPString ext;
+
+        if (p.set(path) != STATUS_OK)
+            return false;
+        if (p.get_ext(&ext) != STATUS_OK)
+            return false;
+
+        return ext.equals_ascii_nocase("wav");
+    }
+
+} /* namespace spike_bender */
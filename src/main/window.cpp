@@ -0,0 +1,510 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/window.h>
+
+namespace spike_bender
+{
+    //-------------------------------------------------------------------------
+    // WeightingFilter
+    WeightingFilter::WeightingFilter()
+    {
+        enWeight    = NO_WEIGHT;
+        nSampleRate = 0;
+        bConfigured = false;
+    }
+
+    WeightingFilter::~WeightingFilter()
+    {
+        destroy();
+    }
+
+    status_t WeightingFilter::init(weighting_t weight, size_t sample_rate)
+    {
+        status_t res;
+
+        // Only reset the state if the configuration matches
+        if ((bConfigured) && (enWeight == weight) && (nSampleRate == sample_rate))
+        {
+            sFilter.clear();
+            return STATUS_OK;
+        }
+
+        destroy();
+        if ((res = init_weighting(&sFilter, weight, sample_rate)) != STATUS_OK)
+            return res;
+
+        enWeight    = weight;
+        nSampleRate = sample_rate;
+        bConfigured = true;
+
+        return STATUS_OK;
+    }
+
+    void WeightingFilter::destroy()
+    {
+        sFilter.destroy();
+        bConfigured = false;
+    }
+
+    void WeightingFilter::process(float *dst, const float *src, size_t count)
+    {
+        if (src != NULL)
+            sFilter.process(dst, src, count);
+        else
+        {
+            dsp::fill_zero(dst, count);
+            sFilter.process(dst, dst, count);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // SlidingWindow
+    SlidingWindow::SlidingWindow()
+    {
+        vHistory    = NULL;
+        nPeriod     = 0;
+        nHead       = 0;
+    }
+
+    SlidingWindow::~SlidingWindow()
+    {
+        destroy();
+    }
+
+    status_t SlidingWindow::init(size_t sample_rate, weighting_t weight, size_t period)
+    {
+        status_t res;
+
+        if ((res = sFilter.init(weight, sample_rate)) != STATUS_OK)
+            return res;
+
+        // Keep the history buffer if the period does not change
+        period      = lsp_max(period, size_t(1));
+        if ((vHistory == NULL) || (nPeriod != period))
+        {
+            if (vHistory != NULL)
+                delete [] vHistory;
+            vHistory    = new float[period];
+            if (vHistory == NULL)
+                return STATUS_NO_MEM;
+        }
+        dsp::fill_zero(vHistory, period);
+
+        nPeriod     = period;
+        nHead       = 0;
+
+        return STATUS_OK;
+    }
+
+    void SlidingWindow::destroy()
+    {
+        sFilter.destroy();
+        if (vHistory != NULL)
+        {
+            delete [] vHistory;
+            vHistory    = NULL;
+        }
+        nPeriod     = 0;
+        nHead       = 0;
+    }
+
+    void SlidingWindow::filter(float *dst, const float *src, size_t count)
+    {
+        sFilter.process(dst, src, count);
+    }
+
+    void SlidingWindow::push(float *dst, const float *src, size_t count)
+    {
+        // Each iteration does not push more than period samples
+        for (size_t n; count > 0; count -= n, dst += n, src += n)
+        {
+            n               = lsp_min(count, nPeriod - nHead);
+            dsp::copy(dst, &vHistory[nHead], n);
+            dsp::copy(&vHistory[nHead], src, n);
+
+            nHead          += n;
+            if (nHead >= nPeriod)
+                nHead           = 0;
+        }
+    }
+
+    double SlidingWindow::square_sum() const
+    {
+        double sum      = 0.0;
+        for (size_t i=0; i<nPeriod; ++i)
+        {
+            float s         = vHistory[i];
+            sum            += s * s;
+        }
+
+        return sum;
+    }
+
+    //-------------------------------------------------------------------------
+    // RMSMeter
+    RMSMeter::RMSMeter()
+    {
+        vOld        = NULL;
+        vNew        = NULL;
+        fSum        = 0.0;
+        fKPeriod    = 0.0f;
+        nAnchor     = 0;
+        nCounter    = 0;
+    }
+
+    RMSMeter::~RMSMeter()
+    {
+        destroy();
+    }
+
+    status_t RMSMeter::init(size_t sample_rate, weighting_t weight, size_t period)
+    {
+        status_t res;
+        if ((res = sWindow.init(sample_rate, weight, period)) != STATUS_OK)
+            return res;
+
+        // The buffers do not depend on the configuration and are kept between uses
+        if (vOld == NULL)
+        {
+            vOld        = new float[WINDOW_BLOCK_SIZE * 2];
+            if (vOld == NULL)
+                return STATUS_NO_MEM;
+            vNew        = &vOld[WINDOW_BLOCK_SIZE];
+        }
+
+        fSum        = 0.0;
+        fKPeriod    = 1.0f / sWindow.period();
+        nAnchor     = lsp_max(sWindow.period() * WINDOW_ANCHOR_PERIODS, WINDOW_ANCHOR_MIN);
+        nCounter    = 0;
+
+        return STATUS_OK;
+    }
+
+    void RMSMeter::destroy()
+    {
+        sWindow.destroy();
+        if (vOld != NULL)
+        {
+            delete [] vOld;
+            vOld        = NULL;
+        }
+        vNew        = NULL;
+    }
+
+    /**
+     * Update the running sums of the several windows in lockstep, the number of lanes
+     * is known at compile time so the sums are kept in registers
+     */
+    template <size_t L>
+    static void running_sums(double *sum, float * const *dst,
+        const float * const *vold, const float * const *vnew, size_t count)
+    {
+        double s[L];
+        float *d[L];
+        const float *o[L], *n[L];
+        for (size_t l=0; l<L; ++l)
+        {
+            s[l]                = sum[l];
+            d[l]                = dst[l];
+            o[l]                = vold[l];
+            n[l]                = vnew[l];
+        }
+
+        for (size_t j=0; j<count; ++j)
+        {
+            for (size_t l=0; l<L; ++l)
+            {
+                s[l]               -= o[l][j];
+                s[l]               += n[l][j];
+                d[l][j]             = float(s[l]);
+            }
+        }
+
+        for (size_t l=0; l<L; ++l)
+            sum[l]              = s[l];
+    }
+
+    void RMSMeter::process(float *dst, const float *src, size_t count)
+    {
+        RMSMeter *self      = this;
+        process(&self, &dst, (src != NULL) ? &src : NULL, 1, count);
+    }
+
+    void RMSMeter::process(RMSMeter * const *meters, float * const *dst,
+        const float * const *src, size_t lanes, size_t count)
+    {
+        double sum[LOCKSTEP_LANES];
+        float *vd[LOCKSTEP_LANES];
+        const float *vo[LOCKSTEP_LANES], *vn[LOCKSTEP_LANES];
+
+        for (size_t first=0, lanes_n; first<lanes; first += lanes_n)
+        {
+            lanes_n             = lsp_min(lanes - first, LOCKSTEP_LANES);
+            RMSMeter * const *m = &meters[first];
+
+            // Apply filters to input buffers
+            for (size_t l=0; l<lanes_n; ++l)
+                m[l]->sWindow.filter(dst[first + l], (src != NULL) ? src[first + l] : NULL, count);
+
+            for (size_t off=0, n; off<count; off += n)
+            {
+                n                   = lsp_min(count - off, WINDOW_BLOCK_SIZE);
+
+                // Compute squares of values
+                for (size_t l=0; l<lanes_n; ++l)
+                {
+                    RMSMeter *rm        = m[l];
+                    vd[l]               = &dst[first + l][off];
+                    rm->sWindow.push(rm->vOld, vd[l], n);
+                    dsp::sqr1(rm->vOld, n);
+                    dsp::sqr2(rm->vNew, vd[l], n);
+
+                    sum[l]              = rm->fSum;
+                    vo[l]               = rm->vOld;
+                    vn[l]               = rm->vNew;
+                }
+
+                // Update the running sums by groups of four and two lanes
+                for (size_t l=0, k; l<lanes_n; l += k)
+                {
+                    k                   = lockstep_width(lanes_n - l);
+                    if (k == 4)
+                        running_sums<4>(&sum[l], &vd[l], &vo[l], &vn[l], n);
+                    else if (k == 2)
+                        running_sums<2>(&sum[l], &vd[l], &vo[l], &vn[l], n);
+                    else
+                        running_sums<1>(&sum[l], &vd[l], &vo[l], &vn[l], n);
+                }
+
+                // Re-anchor the running sums and compute the RMS values
+                for (size_t l=0; l<lanes_n; ++l)
+                {
+                    RMSMeter *rm        = m[l];
+                    rm->fSum            = sum[l];
+                    rm->nCounter       += n;
+                    if (rm->nCounter >= rm->nAnchor)
+                    {
+                        rm->fSum            = rm->sWindow.square_sum();
+                        rm->nCounter        = 0;
+                    }
+
+                    dsp::mul_k2(vd[l], rm->fKPeriod, n);
+                    dsp::ssqrt1(vd[l], n);
+                }
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    // ControlMeter
+    ControlMeter::ControlMeter()
+    {
+        vHistory    = NULL;
+        vBuffer     = NULL;
+        fSum        = 0.0;
+        fBlock      = 0.0;
+        fKPeriod    = 0.0f;
+        nPeriod     = 0;
+        nHead       = 0;
+        nDecimation = 1;
+        nPhase      = 0;
+        nAnchor     = 0;
+        nCounter    = 0;
+    }
+
+    ControlMeter::~ControlMeter()
+    {
+        destroy();
+    }
+
+    status_t ControlMeter::init(size_t sample_rate, weighting_t weight, size_t period, size_t decimation)
+    {
+        status_t res;
+
+        if ((res = sFilter.init(weight, sample_rate)) != STATUS_OK)
+            return res;
+
+        decimation  = lsp_max(decimation, size_t(1));
+        period      = lsp_max((period + decimation / 2) / decimation, size_t(1));
+
+        // Keep the buffers if the period does not change
+        if ((vBuffer == NULL) || (nPeriod != period))
+        {
+            if (vBuffer != NULL)
+                delete [] vBuffer;
+            vBuffer     = new float[WINDOW_BLOCK_SIZE + period];
+            if (vBuffer == NULL)
+                return STATUS_NO_MEM;
+        }
+        vHistory    = &vBuffer[WINDOW_BLOCK_SIZE];
+        dsp::fill_zero(vHistory, period);
+
+        fSum        = 0.0;
+        fBlock      = 0.0;
+        fKPeriod    = 1.0f / (period * decimation);
+        nPeriod     = period;
+        nHead       = 0;
+        nDecimation = decimation;
+        nPhase      = 0;
+        nAnchor     = lsp_max(period * WINDOW_ANCHOR_PERIODS, WINDOW_ANCHOR_MIN / decimation);
+        nCounter    = 0;
+
+        return STATUS_OK;
+    }
+
+    void ControlMeter::destroy()
+    {
+        sFilter.destroy();
+        if (vBuffer != NULL)
+        {
+            delete [] vBuffer;
+            vBuffer     = NULL;
+        }
+        vHistory    = NULL;
+        nPeriod     = 0;
+        nHead       = 0;
+    }
+
+    size_t ControlMeter::process(float *dst, const float *src, size_t count)
+    {
+        size_t k = 0;
+
+        for (size_t n; count > 0; count -= n)
+        {
+            n                   = lsp_min(count, WINDOW_BLOCK_SIZE);
+
+            // Apply filter and compute squares of values
+            sFilter.process(vBuffer, src, n);
+            if (src != NULL)
+                src                += n;
+            dsp::sqr1(vBuffer, n);
+
+            // Sum squares over decimation blocks and slide the window over block sums
+            for (size_t j=0; j<n; )
+            {
+                size_t m            = lsp_min(n - j, nDecimation - nPhase);
+                fBlock             += dsp::h_sum(&vBuffer[j], m);
+                j                  += m;
+                nPhase             += m;
+                if (nPhase < nDecimation)
+                    break;
+
+                float s             = float(fBlock);
+                fSum               -= vHistory[nHead];
+                fSum               += s;
+                vHistory[nHead]     = s;
+                if ((++nHead) >= nPeriod)
+                    nHead               = 0;
+
+                // Re-anchor the running sum to eliminate the accumulated error
+                if ((++nCounter) >= nAnchor)
+                {
+                    fSum                = 0.0;
+                    for (size_t i=0; i<nPeriod; ++i)
+                        fSum               += vHistory[i];
+                    nCounter            = 0;
+                }
+
+                dst[k++]            = float(fSum);
+                fBlock              = 0.0;
+                nPhase              = 0;
+            }
+        }
+
+        // Compute the RMS value
+        dsp::mul_k2(dst, fKPeriod, k);
+        dsp::ssqrt1(dst, k);
+
+        return k;
+    }
+
+    //-------------------------------------------------------------------------
+    // LevelMeter
+    LevelMeter::LevelMeter()
+    {
+        vBuffer     = NULL;
+        fLevel      = 0.0f;
+        nDecimation = 1;
+    }
+
+    LevelMeter::~LevelMeter()
+    {
+        destroy();
+    }
+
+    status_t LevelMeter::init(size_t sample_rate, weighting_t weight, size_t period, size_t decimation)
+    {
+        status_t res;
+
+        nDecimation = lsp_max(decimation, size_t(1));
+        res         = (nDecimation > 1) ?
+                        sControl.init(sample_rate, weight, period, nDecimation) :
+                        sMeter.init(sample_rate, weight, period);
+        if (res != STATUS_OK)
+            return res;
+
+        // The meters emit at most one value per input sample
+        if (vBuffer == NULL)
+        {
+            vBuffer     = new float[WINDOW_BLOCK_SIZE];
+            if (vBuffer == NULL)
+                return STATUS_NO_MEM;
+        }
+
+        fLevel      = 0.0f;
+
+        return STATUS_OK;
+    }
+
+    void LevelMeter::destroy()
+    {
+        sMeter.destroy();
+        sControl.destroy();
+        if (vBuffer != NULL)
+        {
+            delete [] vBuffer;
+            vBuffer     = NULL;
+        }
+    }
+
+    void LevelMeter::process(const float *src, size_t count)
+    {
+        for (size_t n; count > 0; count -= n)
+        {
+            n                   = lsp_min(count, WINDOW_BLOCK_SIZE);
+            size_t k            = n;
+            if (nDecimation > 1)
+                k                   = sControl.process(vBuffer, src, n);
+            else
+                sMeter.process(vBuffer, src, n);
+            if (src != NULL)
+                src                += n;
+
+            if (k > 0)
+                fLevel              = lsp_max(fLevel, dsp::abs_max(vBuffer, k));
+        }
+    }
+
+} /* namespace spike_bender */
@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/common/types.h>
+#include <lsp-plug.in/dsp-units/sampling/Sample.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/lltl/darray.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/string.h>
+#include <lsp-plug.in/test-fw/mtest.h>
+
+#include <private/audio.h>
+#include <private/cmdline.h>
+#include <private/config.h>
+#include <private/context.h>
+#include <private/stats.h>
+#include <private/tool.h>
+
+#if !defined(PLATFORM_WINDOWS)
+    #include <sys/types.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif /* PLATFORM_WINDOWS */
+
+namespace
+{
+    using namespace lsp;
+
+    static const char * const pass_counts[]     = { "1", "3" };
+    static const char * const weightings[]      = { "none", "k" };
+    static const char * const thread_counts[]   = { "1", "0" };     // 0 for the number of CPU cores
+    static const char * const peak_modes[]      = { "off", "on" };  // Peak elimination is enabled by default, so it is set explicitly
+
+    static constexpr size_t MAX_ARGS            = 32;               // Maximum number of command line arguments of the case
+
+    /**
+     * Measurement of the single stage of the benchmark case
+     */
+    typedef struct record_t
+    {
+        char                sCase[64];      // Name of the benchmark case
+        char                sStage[32];     // Name of the stage followed by the number of the pass
+        double              fWallTime;      // Wall clock time in seconds
+        double              fProcessCpuTime; // Processor time in seconds
+        double              fRealtime;      // Duration of the signal divided by the wall clock time
+        wsize_t             nProcessPeakRss; // Peak resident memory of the process in bytes
+    } record_t;
+
+    typedef lltl::darray<record_t> records_t;
+
+    /**
+     * Generate the synthetic signal: amplitude-modulated tones with noise and sparse spikes,
+     * the tone and the modulation differ between channels
+     */
+    static void generate(dspu::Sample *s, size_t channels, size_t sample_rate, size_t length)
+    {
+        uint32_t seed   = 0x1234567;
+
+        s->init(channels, length, length);
+        s->set_sample_rate(sample_rate);
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            float *dst      = s->channel(i);
+            float kf        = 2.0f * M_PI * (110.0f * (i + 2)) / sample_rate;
+            float km        = 2.0f * M_PI * (0.3f + 0.1f * i) / sample_rate;
+
+            for (size_t j=0; j<length; ++j)
+            {
+                seed            = seed * 1103515245 + 12345;
+                float noise     = float((seed >> 8) & 0xffff) / 32768.0f - 1.0f;
+                float env       = 0.05f + 0.45f * (1.0f + sinf(km * j));
+                float spike     = ((seed >> 24) == 0) ? 4.0f : 1.0f;
+
+                dst[j]          = (env * sinf(kf * j) + 0.02f * noise) * spike;
+            }
+        }
+    }
+
+    static status_t write_records(const char *path, const records_t *list)
+    {
+        FILE *fd        = fopen(path, "w");
+        if (fd == NULL)
+            return STATUS_IO_ERROR;
+
+        fprintf(fd, "# case\tstage\twall_time\tprocess_cpu_time\trealtime\tprocess_peak_rss\n");
+        for (size_t i=0, n=list->size(); i<n; ++i)
+        {
+            const record_t *r   = list->uget(i);
+            fprintf(fd, "%s\t%s\t%.6f\t%.6f\t%.3f\t%llu\n",
+                r->sCase, r->sStage, r->fWallTime, r->fProcessCpuTime, r->fRealtime,
+                (unsigned long long)r->nProcessPeakRss);
+        }
+
+        return (fclose(fd) == 0) ? STATUS_OK : STATUS_IO_ERROR;
+    }
+
+    static status_t read_records(records_t *list, const char *path)
+    {
+        char line[256];
+        char *fields[6];
+
+        FILE *fd        = fopen(path, "r");
+        if (fd == NULL)
+            return STATUS_NOT_FOUND;
+        lsp_finally { fclose(fd); };
+
+        while (fgets(line, sizeof(line), fd) != NULL)
+        {
+            // Skip empty lines and comments
+            line[strcspn(line, "\r\n")] = '\0';
+            if ((line[0] == '\0') || (line[0] == '#'))
+                continue;
+
+            // Fields are separated by tab
+            size_t count    = 0;
+            for (char *p = line; (p != NULL) && (count < 6); ++count)
+            {
+                fields[count]   = p;
+                if ((p = strchr(p, '\t')) != NULL)
+                    *(p++)          = '\0';
+            }
+            if (count < 6)
+                return STATUS_BAD_FORMAT;
+
+            record_t *r     = list->add();
+            if (r == NULL)
+                return STATUS_NO_MEM;
+            snprintf(r->sCase, sizeof(r->sCase), "%s", fields[0]);
+            snprintf(r->sStage, sizeof(r->sStage), "%s", fields[1]);
+            r->fWallTime       = atof(fields[2]);
+            r->fProcessCpuTime = atof(fields[3]);
+            r->fRealtime       = atof(fields[4]);
+            r->nProcessPeakRss = strtoull(fields[5], NULL, 10);
+        }
+
+        return STATUS_OK;
+    }
+
+    static const record_t *find_record(const records_t *list, const char *name, const char *stage)
+    {
+        for (size_t i=0, n=list->size(); i<n; ++i)
+        {
+            const record_t *r   = list->uget(i);
+            if ((!strcmp(r->sCase, name)) && (!strcmp(r->sStage, stage)))
+                return r;
+        }
+        return NULL;
+    }
+
+    static status_t collect_records(records_t *list, const char *name, const spike_bender::Stats *stats, double duration)
+    {
+        for (size_t i=0, n=stats->size(); i<n; ++i)
+        {
+            const spike_bender::stage_t *st = stats->get(i);
+            record_t *r     = list->add();
+            if (r == NULL)
+                return STATUS_NO_MEM;
+
+            snprintf(r->sCase, sizeof(r->sCase), "%s", name);
+            if (st->nPass >= 0)
+                snprintf(r->sStage, sizeof(r->sStage), "%s#%d", st->sName, int(st->nPass));
+            else
+                snprintf(r->sStage, sizeof(r->sStage), "%s", st->sName);
+            r->fWallTime       = st->fWallTime;
+            r->fProcessCpuTime = st->fProcessCpuTime;
+            r->fRealtime       = (st->fWallTime > 0.0) ? duration / st->fWallTime : 0.0;
+            r->nProcessPeakRss = st->nProcessPeakRss;
+        }
+
+        return STATUS_OK;
+    }
+
+    /**
+     * Run the complete pipeline of the tool for the single file and store the statistics
+     */
+    static status_t run_pipeline(const char *path, const char *name, int argc, const char **argv,
+        bool eliminate, double duration)
+    {
+        spike_bender::config_t cfg;
+        status_t res    = spike_bender::parse_cmdline(&cfg, argc, argv);
+        if (res != STATUS_OK)
+            return res;
+        cfg.bEliminatePeaks = eliminate;
+
+        spike_bender::Context ctx(&cfg);
+        if ((res = spike_bender::process_file(&cfg, &cfg.sInFile, &cfg.sOutFile, &ctx)) != STATUS_OK)
+            return res;
+
+        records_t list;
+        if ((res = collect_records(&list, name, ctx.stats(), duration)) != STATUS_OK)
+            return res;
+
+        return write_records(path, &list);
+    }
+
+    /**
+     * Run the benchmark case in the child process, so the peak resident memory
+     * is measured for the single case only
+     */
+    static status_t run_case(records_t *list, const char *path, const char *name, int argc, const char **argv,
+        bool eliminate, double duration)
+    {
+        status_t res;
+        remove(path);
+
+    #if defined(PLATFORM_WINDOWS)
+        res             = run_pipeline(path, name, argc, argv, eliminate, duration);
+    #else
+        fflush(stdout);
+        fflush(stderr);
+        pid_t pid       = fork();
+        if (pid < 0)
+            return STATUS_UNKNOWN_ERR;
+        if (pid == 0)
+            _exit((run_pipeline(path, name, argc, argv, eliminate, duration) == STATUS_OK) ? 0 : 1);
+
+        int status      = 0;
+        if (waitpid(pid, &status, 0) != pid)
+            return STATUS_UNKNOWN_ERR;
+        res             = ((WIFEXITED(status)) && (WEXITSTATUS(status) == 0)) ? STATUS_OK : STATUS_UNKNOWN_ERR;
+    #endif /* PLATFORM_WINDOWS */
+
+        return (res == STATUS_OK) ? read_records(list, path) : res;
+    }
+
+    static wsize_t process_peak_rss(const records_t *list, const char *name)
+    {
+        wsize_t peak    = 0;
+        for (size_t i=0, n=list->size(); i<n; ++i)
+        {
+            const record_t *r   = list->uget(i);
+            if (!strcmp(r->sCase, name))
+                peak            = lsp_max(peak, r->nProcessPeakRss);
+        }
+        return peak;
+    }
+
+    static inline double percents(double value, double base)
+    {
+        return (base > 0.0) ? (value - base) * 100.0 / base : 0.0;
+    }
+
+    /**
+     * Compare the results with the baseline: the case regresses if the overall realtime
+     * factor drops or the peak resident memory grows above the tolerance
+     */
+    static size_t compare_records(const records_t *list, const records_t *base, double tolerance)
+    {
+        size_t regressions  = 0;
+
+        for (size_t i=0, n=list->size(); i<n; ++i)
+        {
+            const record_t *r   = list->uget(i);
+            if (strcmp(r->sStage, "total"))
+                continue;
+
+            const record_t *b   = find_record(base, r->sCase, r->sStage);
+            if (b == NULL)
+            {
+                printf("  %-40s no baseline\n", r->sCase);
+                continue;
+            }
+
+            wsize_t mem         = process_peak_rss(list, r->sCase);
+            wsize_t bmem        = process_peak_rss(base, r->sCase);
+            bool slower         = r->fRealtime < b->fRealtime * (1.0 - tolerance * 0.01);
+            bool larger         = (bmem > 0) && (double(mem) > double(bmem) * (1.0 + tolerance * 0.01));
+            if ((slower) || (larger))
+                ++regressions;
+
+            printf("  %-40s realtime %8.2fx vs %8.2fx (%+6.1f%%), peak RSS %7.1f MB vs %7.1f MB (%+6.1f%%)%s\n",
+                r->sCase, r->fRealtime, b->fRealtime, percents(r->fRealtime, b->fRealtime),
+                mem / 1048576.0, bmem / 1048576.0, percents(double(mem), double(bmem)),
+                ((slower) || (larger)) ? " REGRESSION" : "");
+
+            // Show the stages of the case that have been slowed down
+            for (size_t j=0; j<n; ++j)
+            {
+                const record_t *s   = list->uget(j);
+                if ((strcmp(s->sCase, r->sCase)) || (s == r))
+                    continue;
+                const record_t *bs  = find_record(base, s->sCase, s->sStage);
+                if ((bs != NULL) && (s->fRealtime < bs->fRealtime * (1.0 - tolerance * 0.01)))
+                    printf("    %-38s %.3f s vs %.3f s\n", s->sStage, s->fWallTime, bs->fWallTime);
+            }
+        }
+
+        return regressions;
+    }
+}
+
+MTEST_BEGIN("spike_bender", benchmark)
+
+    MTEST_MAIN
+    {
+        double duration     = 30.0;
+        size_t sample_rate  = 48000;
+        size_t channels     = 2;
+        size_t repeats      = 3;
+        double tolerance    = 10.0;
+        const char *results = NULL;
+        const char *baseline= NULL;
+
+        // Parse arguments
+        for (ssize_t i=0; i < argc; i += 2)
+        {
+            const char *opt     = argv[i];
+            const char *val     = argv[i + 1];
+            MTEST_ASSERT_MSG(i + 1 < argc, "Value required for option %s", opt);
+
+            if (!strcmp(opt, "-d"))
+                duration            = atof(val);
+            else if (!strcmp(opt, "-sr"))
+                sample_rate         = atoi(val);
+            else if (!strcmp(opt, "-ch"))
+                channels            = atoi(val);
+            else if (!strcmp(opt, "-r"))
+                repeats             = atoi(val);
+            else if (!strcmp(opt, "-t"))
+                tolerance           = atof(val);
+            else if (!strcmp(opt, "-o"))
+                results             = val;
+            else if (!strcmp(opt, "-b"))
+                baseline            = val;
+            else
+                MTEST_FAIL_MSG("Unknown option %s, available options: "
+                    "-d seconds, -sr sample rate, -ch channels, -r repeats, "
+                    "-t tolerance in percents, -o results file, -b baseline file", opt);
+        }
+        MTEST_ASSERT((duration > 0.0) && (sample_rate > 0) && (channels > 0) && (repeats > 0));
+
+        // Generate the input file
+        io::Path in_file, out_file, run_file;
+        MTEST_ASSERT(in_file.fmt("%s/%s-in.wav", tempdir(), full_name()) > 0);
+        MTEST_ASSERT(out_file.fmt("%s/%s-out.wav", tempdir(), full_name()) > 0);
+        MTEST_ASSERT(run_file.fmt("%s/%s-run.txt", tempdir(), full_name()) > 0);
+        {
+            dspu::Sample in;
+            generate(&in, channels, sample_rate, size_t(duration * sample_rate));
+            MTEST_ASSERT(spike_bender::save_audio_file(&in, in_file.as_string()) == STATUS_OK);
+        }
+
+        // The output sample rate is either kept or changed to the other common rate
+        char rates[2][16];
+        snprintf(rates[0], sizeof(rates[0]), "%d", int(sample_rate));
+        snprintf(rates[1], sizeof(rates[1]), "%d", (sample_rate != 44100) ? 44100 : 48000);
+
+        printf("Benchmark: %d channels, %.1f s @ %d Hz, best of %d runs\n",
+            int(channels), duration, int(sample_rate), int(repeats));
+
+        records_t list;
+        for (size_t ip=0; ip<sizeof(pass_counts)/sizeof(pass_counts[0]); ++ip)
+            for (size_t iw=0; iw<sizeof(weightings)/sizeof(weightings[0]); ++iw)
+                for (size_t is=0; is<2; ++is)
+                    for (size_t it=0; it<sizeof(thread_counts)/sizeof(thread_counts[0]); ++it)
+                        for (size_t ie=0; ie<sizeof(peak_modes)/sizeof(peak_modes[0]); ++ie)
+                        {
+                            char name[64];
+                            snprintf(name, sizeof(name), "np=%s wf=%s sr=%s th=%s ep=%s",
+                                pass_counts[ip], weightings[iw], rates[is], thread_counts[it], peak_modes[ie]);
+
+                            const char *args[MAX_ARGS];
+                            int nargs       = 0;
+                            args[nargs++]   = full_name();
+                            args[nargs++]   = "-if";
+                            args[nargs++]   = in_file.as_native();
+                            args[nargs++]   = "-of";
+                            args[nargs++]   = out_file.as_native();
+                            args[nargs++]   = "-np";
+                            args[nargs++]   = pass_counts[ip];
+                            args[nargs++]   = "-wf";
+                            args[nargs++]   = weightings[iw];
+                            args[nargs++]   = "-sr";
+                            args[nargs++]   = rates[is];
+                            args[nargs++]   = "-th";
+                            args[nargs++]   = thread_counts[it];
+
+                            // Keep the run with the lowest overall wall clock time
+                            records_t best;
+                            for (size_t k=0; k<repeats; ++k)
+                            {
+                                records_t run;
+                                MTEST_ASSERT_MSG(run_case(&run, run_file.as_native(), name, nargs, args, ie > 0, duration) == STATUS_OK,
+                                    "Failed to run benchmark case '%s'", name);
+
+                                const record_t *t   = find_record(&run, name, "total");
+                                const record_t *bt  = find_record(&best, name, "total");
+                                MTEST_ASSERT(t != NULL);
+                                if ((bt == NULL) || (t->fWallTime < bt->fWallTime))
+                                    best.swap(&run);
+                            }
+
+                            const record_t *t   = find_record(&best, name, "total");
+                            printf("  %-40s realtime %8.2fx, peak RSS %7.1f MB\n",
+                                name, t->fRealtime, process_peak_rss(&best, name) / 1048576.0);
+                            for (size_t k=0, n=best.size(); k<n; ++k)
+                            {
+                                const record_t *r   = best.uget(k);
+                                if (r != t)
+                                    printf("    %-38s %.3f s, %.2fx\n", r->sStage, r->fWallTime, r->fRealtime);
+                            }
+
+                            MTEST_ASSERT(list.add_n(best.size(), best.array()) != NULL);
+                        }
+
+        remove(in_file.as_native());
+        remove(out_file.as_native());
+        remove(run_file.as_native());
+
+        // Store the results, they may be used as the baseline for further runs
+        if (results != NULL)
+        {
+            MTEST_ASSERT_MSG(write_records(results, &list) == STATUS_OK,
+                "Could not write results file '%s'", results);
+            printf("Results written to '%s'\n", results);
+        }
+
+        // Compare with the baseline
+        if (baseline != NULL)
+        {
+            records_t base;
+            MTEST_ASSERT_MSG(read_records(&base, baseline) == STATUS_OK,
+                "Could not read baseline file '%s'", baseline);
+
+            printf("Comparison with baseline '%s', tolerance %.1f%%:\n", baseline, tolerance);
+            size_t regressions  = compare_records(&list, &base, tolerance);
+            MTEST_ASSERT_MSG(regressions == 0, "%d benchmark cases regressed", int(regressions));
+        }
+    }
+
+MTEST_END
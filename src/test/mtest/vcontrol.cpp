@@ -82,7 +82,7 @@ MTEST_BEGIN("spike_bender", vcontrol)
             MTEST_ASSERT(save_audio_file(&avg, path.as_string()) == STATUS_OK);
 
             // STEP 3: Adjust the gain
-            spike_bender::adjust_gain(&out, &gain, &in, &rms, rms_avg, 6.0f, 3.0f);
+            spike_bender::adjust_gain(&out, &gain, &in, &rms, 0, rms_avg, 6.0f, 3.0f);
             MTEST_ASSERT(path.fmt("%s/samples/vcontrol/%02d-gain-%d.wav", resources(), file_id++, pass) > 0);
             MTEST_ASSERT(save_audio_file(&gain, path.as_string()) == STATUS_OK);
             MTEST_ASSERT(path.fmt("%s/samples/vcontrol/%02d-output-%d.wav", resources(), file_id++, pass) > 0);
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/test-fw/ptest.h>
+
+#include <private/arena.h>
+#include <private/audio.h>
+
+#include <errno.h>
+#include <stdlib.h>
+
+namespace
+{
+    static bool     alloc_enabled   = false;    // Count the allocations
+    static size_t   alloc_bytes     = 0;        // Number of bytes requested from the allocator
+    static size_t   alloc_calls     = 0;        // Number of requests to the allocator
+
+    static inline void count_alloc(size_t size)
+    {
+        if (!alloc_enabled)
+            return;
+        __atomic_fetch_add(&alloc_bytes, size, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&alloc_calls, 1, __ATOMIC_RELAXED);
+    }
+    static const size_t sample_rates[] = { 44100, 96000 };
+    static const size_t channel_counts[] = { 1, 2 };
+    static const size_t durations[] = { 1, 10 };    // Seconds
+
+    /**
+     * Generate the synthetic signal: amplitude-modulated tone with noise and sparse spikes
+     */
+    static void generate(lsp::dspu::Sample *s, size_t channels, size_t sample_rate, size_t length)
+    {
+        uint32_t seed   = 0x1234567;
+
+        s->init(channels, length, length);
+        s->set_sample_rate(sample_rate);
+
+        for (size_t i=0; i<channels; ++i)
+        {
+            float *dst      = s->channel(i);
+            float kf        = 2.0f * M_PI * (220.0f * (i + 1)) / sample_rate;
+            float km        = 2.0f * M_PI * 0.5f / sample_rate;
+
+            for (size_t j=0; j<length; ++j)
+            {
+                seed            = seed * 1103515245 + 12345;
+                float noise     = float((seed >> 8) & 0xffff) / 32768.0f - 1.0f;
+                float env       = 0.05f + 0.45f * (1.0f + sinf(km * j));
+                float spike     = ((seed >> 24) == 0) ? 4.0f : 1.0f;
+
+                dst[j]          = (env * sinf(kf * j) + 0.02f * noise) * spike;
+            }
+        }
+    }
+}
+
+#if defined(__GLIBC__)
+/*
+ * The allocator functions of the test binary are replaced to count the requests.
+ * The operator new and the buffers of the libraries are served by malloc(), so all
+ * allocations are counted, reallocation is counted as allocation of the new size.
+ */
+extern "C"
+{
+    extern void *__libc_malloc(size_t size);
+    extern void *__libc_calloc(size_t nmemb, size_t size);
+    extern void *__libc_realloc(void *ptr, size_t size);
+    extern void *__libc_memalign(size_t alignment, size_t size);
+
+    void *malloc(size_t size) __THROW
+    {
+        count_alloc(size);
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t nmemb, size_t size) __THROW
+    {
+        count_alloc(nmemb * size);
+        return __libc_calloc(nmemb, size);
+    }
+
+    void *realloc(void *ptr, size_t size) __THROW
+    {
+        count_alloc(size);
+        return __libc_realloc(ptr, size);
+    }
+
+    void *memalign(size_t alignment, size_t size) __THROW
+    {
+        count_alloc(size);
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void **ptr, size_t alignment, size_t size) __THROW
+    {
+        count_alloc(size);
+        void *res = __libc_memalign(alignment, size);
+        if (res == NULL)
+            return ENOMEM;
+        *ptr = res;
+        return 0;
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size) __THROW
+    {
+        count_alloc(size);
+        return __libc_memalign(alignment, size);
+    }
+}
+    #define ALLOC_COUNTED       true
+#else
+    #define ALLOC_COUNTED       false
+#endif /* __GLIBC__ */
+
+PTEST_BEGIN("spike_bender", stages, 1, 10)
+
+    size_t      nCalls;
+
+    /**
+     * Start the measurement of the stage, the key tells the number of processed samples
+     * per call, so the performance reported by the loop in calls per second gives the
+     * throughput in samples per second
+     */
+    void start(char *buf, size_t len, const char *stage, const dspu::Sample *s)
+    {
+        snprintf(buf, len, "%s %d samples (%d ch x %d @ %d Hz)", stage,
+            int(s->channels() * s->length()), int(s->channels()), int(s->length()), int(s->sample_rate()));
+        nCalls          = 0;
+        alloc_bytes     = 0;
+        alloc_calls     = 0;
+        alloc_enabled   = true;
+    }
+
+    void finish(const char *label)
+    {
+        alloc_enabled   = false;
+        if (!ALLOC_COUNTED)
+        {
+            printf("  %s: allocations are not counted on this platform\n", label);
+            return;
+        }
+
+        size_t calls    = lsp_max(nCalls, size_t(1));
+        printf("  %s: %llu bytes in %llu allocations per call\n",
+            label, (unsigned long long)(alloc_bytes / calls), (unsigned long long)(alloc_calls / calls));
+    }
+
+    PTEST_MAIN
+    {
+        using namespace spike_bender;
+
+        char buf[128];
+        dspu::Sample in, out, rms;
+        ScratchArena arena;
+        float thresh[2];
+
+        for (size_t i=0; i<sizeof(sample_rates)/sizeof(sample_rates[0]); ++i)
+            for (size_t j=0; j<sizeof(channel_counts)/sizeof(channel_counts[0]); ++j)
+                for (size_t k=0; k<sizeof(durations)/sizeof(durations[0]); ++k)
+                {
+                    size_t srate    = sample_rates[i];
+                    size_t length   = srate * durations[k];
+                    size_t period   = size_t(dspu::millis_to_samples(srate, 40.0f)) | 1;
+
+                    generate(&in, channel_counts[j], srate, length);
+
+                    // Estimate thresholds the same way the tool does
+                    if (estimate_rms(&rms, &in, K_WEIGHT, period) != STATUS_OK)
+                        return;
+                    for (size_t c=0; c<in.channels(); ++c)
+                        thresh[c]       = dsp::abs_max(rms.channel(c), rms.length());
+
+                    // Weighting filter
+                    start(buf, sizeof(buf), "apply_weight", &in);
+                    PTEST_LOOP(buf,
+                        apply_weight(&out, &in, K_WEIGHT);
+                        ++nCalls;
+                    );
+                    finish(buf);
+
+                    // Short-time RMS
+                    start(buf, sizeof(buf), "estimate_rms", &in);
+                    PTEST_LOOP(buf,
+                        estimate_rms(&rms, &in, K_WEIGHT, period);
+                        ++nCalls;
+                    );
+                    finish(buf);
+
+                    // Envelope
+                    start(buf, sizeof(buf), "estimate_envelope", &in);
+                    PTEST_LOOP(buf,
+                        estimate_envelope(&out, &in, K_WEIGHT, period);
+                        ++nCalls;
+                    );
+                    finish(buf);
+
+                    // Gain adjustment, out of place to keep the input intact
+                    if (estimate_rms(&rms, &in, K_WEIGHT, period) != STATUS_OK)
+                        return;
+                    start(buf, sizeof(buf), "adjust_gain", &in);
+                    PTEST_LOOP(buf,
+                        adjust_gain(&out, NULL, &in, &rms, period / 2, thresh, 6.0f, 3.0f);
+                        ++nCalls;
+                    );
+                    finish(buf);
+
+                    // Peak elimination, in place as the tool does. The input is copied before each
+                    // call to process the same data, the time of copying is included but the
+                    // allocations of copying are not counted
+                    start(buf, sizeof(buf), "smash_amplitude", &in);
+                    PTEST_LOOP(buf,
+                        alloc_enabled   = false;
+                        out.copy(&in);
+                        alloc_enabled   = true;
+                        smash_amplitude(&out, &out, dspu::db_to_gain(1.0f), NULL, &arena);
+                        ++nCalls;
+                    );
+                    finish(buf);
+
+                    // Normalization, in place
+                    start(buf, sizeof(buf), "normalize", &out);
+                    PTEST_LOOP(buf,
+                        normalize(&out, 1.0f, NORM_ALWAYS);
+                        ++nCalls;
+                    );
+                    finish(buf);
+
+                    PTEST_SEPARATOR;
+                }
+    }
+
+PTEST_END
@@ -38,16 +38,25 @@ UTEST_BEGIN("spike_bender", cmdline)
 
         // Validate root parameters
         UTEST_ASSERT(cfg->nSampleRate == 88200);
+        UTEST_ASSERT(cfg->enResample == spike_bender::RESAMPLE_BEST);
         UTEST_ASSERT(cfg->sInFile.equals_ascii("in-file.wav"));
         UTEST_ASSERT(cfg->sOutFile.equals_ascii("out-file.wav"));
         UTEST_ASSERT(float_equals_adaptive(cfg->fRange, 8.0f));
         UTEST_ASSERT(float_equals_adaptive(cfg->fKnee, 1.0f));
+        UTEST_ASSERT(cfg->nDecimation == 16);
+        UTEST_ASSERT(cfg->enControlFormat == spike_bender::CONTROL_LOG16);
+        UTEST_ASSERT(cfg->nScanDecimation == 64);
+        UTEST_ASSERT(cfg->enGainCurve == spike_bender::GAIN_CURVE_TABLE);
         UTEST_ASSERT(cfg->nPasses == 2);
         UTEST_ASSERT(cfg->enWeighting == spike_bender::A_WEIGHT);
         UTEST_ASSERT(cfg->enNormalize == spike_bender::NORM_ALWAYS);
         UTEST_ASSERT(float_equals_adaptive(cfg->fNormGain, -6.0f));
         UTEST_ASSERT(float_equals_adaptive(cfg->fPeakThresh, dspu::db_to_gain(6.1f)));
         UTEST_ASSERT(cfg->bEliminatePeaks == true);
+        UTEST_ASSERT(cfg->bStreaming == true);
+        UTEST_ASSERT(cfg->nBlockSize == 4096);
+        UTEST_ASSERT(cfg->nThreads == 4);
+        UTEST_ASSERT(cfg->sStatsFile.equals_ascii("stats.json"));
     }
 
     void parse_cmdline(spike_bender::config_t *cfg)
@@ -55,17 +64,26 @@ UTEST_BEGIN("spike_bender", cmdline)
         static const char *ext_argv[] =
         {
             "-sr",  "88200",
+            "-rq",  "best",
             "-if",  "in-file.wav",
             "-of",  "out-file.wav",
             "-pt",  "6.1",
             "-ep",
             "-dr",  "8",
             "-k",   "1",
+            "-dc",  "16",
+            "-cf",  "log16",
+            "-sd",  "64",
+            "-gc",  "table",
             "-np",  "2",
             "-r",   "5",
             "-wf",  "A",
             "-ng",  "-6",
             "-n",   "always",
+            "-sm",
+            "-bs",  "4096",
+            "-th",  "4",
+            "-st",  "stats.json",
 
             NULL
         };
@@ -81,6 +99,104 @@ UTEST_BEGIN("spike_bender", cmdline)
         UTEST_ASSERT(res == STATUS_OK);
     }
 
+    void parse_batch_cmdline(spike_bender::config_t *cfg)
+    {
+        static const char *ext_argv[] =
+        {
+            "-id",  "in-dir",
+            "-od",  "out-dir",
+            "-on",  "{name}-out.wav",
+            "-j",   "3",
+            "-ac",  "cache-dir",
+
+            NULL
+        };
+
+        lltl::parray<char> argv;
+        UTEST_ASSERT(argv.add(const_cast<char *>(full_name())));
+        for (const char **pv = ext_argv; *pv != NULL; ++pv)
+        {
+            UTEST_ASSERT(argv.add(const_cast<char *>(*pv)));
+        }
+
+        status_t res = spike_bender::parse_cmdline(cfg, argv.size(), const_cast<const char **>(argv.array()));
+        UTEST_ASSERT(res == STATUS_OK);
+
+        UTEST_ASSERT(cfg->is_batch());
+        UTEST_ASSERT(cfg->sInDir.equals_ascii("in-dir"));
+        UTEST_ASSERT(cfg->sOutDir.equals_ascii("out-dir"));
+        UTEST_ASSERT(cfg->sOutName.equals_ascii("{name}-out.wav"));
+        UTEST_ASSERT(cfg->sBatchFile.is_empty());
+        UTEST_ASSERT(cfg->nJobs == 3);
+        UTEST_ASSERT(cfg->sCacheDir.equals_ascii("cache-dir"));
+    }
+
+    void parse_live_cmdline(spike_bender::config_t *cfg)
+    {
+        static const char *ext_argv[] =
+        {
+            "-lv",
+            "-ch",  "6",
+            "-sr",  "44100",
+            "-bs",  "256",
+
+            NULL
+        };
+
+        lltl::parray<char> argv;
+        UTEST_ASSERT(argv.add(const_cast<char *>(full_name())));
+        for (const char **pv = ext_argv; *pv != NULL; ++pv)
+        {
+            UTEST_ASSERT(argv.add(const_cast<char *>(*pv)));
+        }
+
+        status_t res = spike_bender::parse_cmdline(cfg, argv.size(), const_cast<const char **>(argv.array()));
+        UTEST_ASSERT(res == STATUS_OK);
+
+        UTEST_ASSERT(cfg->bLive);
+        UTEST_ASSERT(!cfg->is_batch());
+        UTEST_ASSERT(cfg->nChannels == 6);
+        UTEST_ASSERT(cfg->nSampleRate == 44100);
+        UTEST_ASSERT(cfg->nBlockSize == 256);
+        UTEST_ASSERT(cfg->sInFile.is_empty());
+        UTEST_ASSERT(cfg->sOutFile.is_empty());
+    }
+
+    void parse_sweep_cmdline(spike_bender::config_t *cfg)
+    {
+        static const char *ext_argv[] =
+        {
+            "-if",  "in-file.wav",
+            "-sw",  "sweep.txt",
+            "-dr",  "4",
+            "-j",   "2",
+
+            NULL
+        };
+
+        lltl::parray<char> argv;
+        UTEST_ASSERT(argv.add(const_cast<char *>(full_name())));
+        for (const char **pv = ext_argv; *pv != NULL; ++pv)
+        {
+            UTEST_ASSERT(argv.add(const_cast<char *>(*pv)));
+        }
+
+        status_t res = spike_bender::parse_cmdline(cfg, argv.size(), const_cast<const char **>(argv.array()));
+        UTEST_ASSERT(res == STATUS_OK);
+
+        UTEST_ASSERT(cfg->is_sweep());
+        UTEST_ASSERT(!cfg->is_batch());
+        UTEST_ASSERT(cfg->sSweepFile.equals_ascii("sweep.txt"));
+        UTEST_ASSERT(cfg->sInFile.equals_ascii("in-file.wav"));
+        UTEST_ASSERT(cfg->sOutFile.is_empty());
+        UTEST_ASSERT(cfg->nJobs == 2);
+
+        spike_bender::dynamics_t dyn;
+        cfg->get_dynamics(&dyn);
+        UTEST_ASSERT(float_equals_adaptive(dyn.fRange, 4.0f));
+        UTEST_ASSERT(dyn.nPasses == cfg->nPasses);
+    }
+
     UTEST_MAIN
     {
         // Parse configuration from file and cmdline
@@ -89,6 +205,18 @@ UTEST_BEGIN("spike_bender", cmdline)
 
         // Validate the final configuration
         validate_config(&cfg);
+
+        // Parse batch configuration
+        spike_bender::config_t batch;
+        parse_batch_cmdline(&batch);
+
+        // Parse live configuration
+        spike_bender::config_t live;
+        parse_live_cmdline(&live);
+
+        // Parse parameter sweep configuration
+        spike_bender::config_t sweep;
+        parse_sweep_cmdline(&sweep);
     }
 
 UTEST_END
@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/control.h>
+
+UTEST_BEGIN("spike_bender", control)
+
+    static constexpr size_t LENGTH          = 3000;
+
+    void check_f16()
+    {
+        static const float values[]     = { 0.0f, 1.0f, -2.0f, 0.5f, 65504.0f, 1e+6f, 6.1035156e-5f, 5.9604645e-8f, 1.0f / 3.0f };
+        static const uint16_t codes[]   = { 0x0000, 0x3c00, 0xc000, 0x3800, 0x7bff, 0x7c00, 0x0400, 0x0001, 0x3555 };
+        static constexpr size_t count   = sizeof(codes) / sizeof(codes[0]);
+
+        uint16_t h[count];
+        float v[count];
+        spike_bender::encode_f16(h, values, count);
+        spike_bender::decode_f16(v, h, count);
+
+        for (size_t i=0; i<count; ++i)
+        {
+            UTEST_ASSERT_MSG(h[i] == codes[i], "Code differs at index=%d: 0x%04x vs 0x%04x", int(i), int(h[i]), int(codes[i]));
+            if (codes[i] != 0x7c00)
+                UTEST_ASSERT(float_equals_relative(v[i], values[i], 1e-3f));
+        }
+        UTEST_ASSERT(isinf(v[5]));
+    }
+
+    void check_log16()
+    {
+        float src[LENGTH], dst[LENGTH];
+        uint16_t c[LENGTH];
+
+        // The relative error is limited by the half of the code step over the whole range
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = expf(-19.0f + 21.0f * float(i) / float(LENGTH));
+        spike_bender::encode_log16(c, src, LENGTH);
+        spike_bender::decode_log16(dst, c, LENGTH);
+        for (size_t i=0; i<LENGTH; ++i)
+            UTEST_ASSERT_MSG(fabsf(dst[i] - src[i]) <= src[i] * 2.5e-4f,
+                "Value differs at index=%d: %g vs %g", int(i), dst[i], src[i]);
+
+        // Zero, negative and too small values become zero, large values saturate
+        static const float edge[]       = { 0.0f, -1.0f, 1e-10f, 1e+10f };
+        spike_bender::encode_log16(c, edge, 4);
+        spike_bender::decode_log16(dst, c, 4);
+        UTEST_ASSERT((dst[0] == 0.0f) && (dst[1] == 0.0f) && (dst[2] == 0.0f));
+        UTEST_ASSERT((c[3] == 0xffff) && (dst[3] > 15.0f) && (dst[3] < 16.0f));
+    }
+
+    void check_buffer(spike_bender::control_format_t format, float tol)
+    {
+        spike_bender::ControlBuffer buf, tmp;
+        float src[LENGTH], dst[LENGTH];
+
+        UTEST_ASSERT(tmp.init(2, LENGTH, format) == STATUS_OK);
+        tmp.set_sample_rate(48000);
+        tmp.swap(&buf);
+        UTEST_ASSERT((buf.channels() == 2) && (buf.length() == LENGTH) && (buf.format() == format));
+        UTEST_ASSERT(buf.sample_rate() == 48000);
+        UTEST_ASSERT(tmp.length() == 0);
+
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = 0.5f + 0.4f * sinf(float(i) * 0.01f);
+
+        // Store in parts, fill the second channel with a constant
+        buf.store(0, 0, src, 1000);
+        buf.store(0, 1000, &src[1000], LENGTH - 1000);
+        buf.fill(1, 0, 0.25f, LENGTH);
+
+        buf.load(dst, 0, 0, LENGTH);
+        for (size_t i=0; i<LENGTH; ++i)
+            UTEST_ASSERT_MSG(float_equals_relative(dst[i], src[i], tol),
+                "Value differs at index=%d: %f vs %f", int(i), dst[i], src[i]);
+
+        buf.load(dst, 1, 100, LENGTH - 100);
+        for (size_t i=0; i<LENGTH - 100; ++i)
+            UTEST_ASSERT(dst[i] == 0.25f);
+    }
+
+    UTEST_MAIN
+    {
+        check_f16();
+        check_log16();
+        check_buffer(spike_bender::CONTROL_F32, 0.0f);
+        check_buffer(spike_bender::CONTROL_F16, 5e-4f);
+        check_buffer(spike_bender::CONTROL_LOG16, 2.5e-4f);
+    }
+
+UTEST_END
@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp-units/dynamics/DynamicProcessor.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/audio.h>
+#include <private/gain.h>
+
+UTEST_BEGIN("spike_bender", gain)
+
+    static constexpr size_t SAMPLE_RATE     = 8000;
+    static constexpr size_t LENGTH          = 4000;
+
+    // Provides access to the envelope follower
+    class Follower: public spike_bender::GainComputer
+    {
+        public:
+            void follow(float *dst, const float *src, size_t count)
+            {
+                GainComputer *self  = this;
+                follow_envelopes<1>(&self, &dst, &src, count);
+            }
+    };
+
+    void make_bursts(float *dst, float thresh)
+    {
+        // Short bursts above the threshold over the quiet signal
+        for (size_t i=0; i<LENGTH; ++i)
+            dst[i]          = ((i % 400) < 40) ? 2.0f * thresh : 0.01f * thresh;
+    }
+
+    void make_steps(float *dst, float thresh)
+    {
+        // Steps up and down across the reaction level and the threshold
+        static const float levels[] = { 0.1f, 0.8f, 2.0f, 0.3f, 0.6f, 0.05f, 1.5f, 0.4f };
+        static constexpr size_t n_levels = sizeof(levels) / sizeof(levels[0]);
+        for (size_t i=0; i<LENGTH; ++i)
+            dst[i]          = levels[(i * n_levels) / LENGTH] * thresh;
+    }
+
+    void check_dynamics(const float *src, float thresh, float range, float knee)
+    {
+        float env[LENGTH], ref[LENGTH], dst[LENGTH];
+
+        dspu::DynamicProcessor dp;
+        dp.construct();
+        spike_bender::configure_dynamics(&dp, SAMPLE_RATE, thresh, range, knee);
+        dp.process(ref, env, src, LENGTH);
+        dp.destroy();
+
+        // The default evaluation gives exactly the output of the dynamic processor
+        spike_bender::GainComputer gc;
+        UTEST_ASSERT(gc.init(SAMPLE_RATE, thresh, range, knee) == STATUS_OK);
+        UTEST_ASSERT(gc.curve() == spike_bender::GAIN_CURVE_EXACT);
+        gc.process(dst, src, LENGTH);
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            UTEST_ASSERT_MSG(dst[i] == ref[i],
+                "Exact gain differs at thresh=%f, index=%d: %f vs %f",
+                thresh, int(i), dst[i], ref[i]);
+        }
+
+        // The follower of the table mode reproduces the envelope of the dynamic processor
+        Follower f;
+        UTEST_ASSERT(f.init(SAMPLE_RATE, thresh, range, knee, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        f.follow(dst, src, LENGTH);
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            UTEST_ASSERT_MSG(float_equals_adaptive(dst[i], env[i], 1e-5f),
+                "Envelope differs at thresh=%f, index=%d: %f vs %f",
+                thresh, int(i), dst[i], env[i]);
+        }
+
+        // The gain of the table mode is within the interpolation error of the table
+        UTEST_ASSERT(gc.init(SAMPLE_RATE, thresh, range, knee, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        gc.process(dst, src, LENGTH);
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            UTEST_ASSERT_MSG(float_equals_adaptive(dst[i], ref[i], 1e-2f),
+                "Table gain differs at thresh=%f, index=%d: %f vs %f",
+                thresh, int(i), dst[i], ref[i]);
+        }
+    }
+
+    void check_curve(spike_bender::GainComputer *gc, float thresh, float range, float knee)
+    {
+        float src[LENGTH], dst[LENGTH];
+
+        dspu::DynamicProcessor dp;
+        dp.construct();
+        spike_bender::configure_dynamics(&dp, SAMPLE_RATE, thresh, range, knee);
+
+        UTEST_ASSERT(gc->init(SAMPLE_RATE, thresh, range, knee, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        UTEST_ASSERT(gc->threshold() == thresh);
+
+        // The constant envelope settles, so the gain should follow the static curve
+        // within the interpolation error of the table
+        for (float db = -60.0f; db <= 12.0f; db += 0.75f)
+        {
+            float x         = thresh * dspu::db_to_gain(db);
+            for (size_t i=0; i<LENGTH; ++i)
+                src[i]          = x;
+            gc->process(dst, src, LENGTH);
+
+            float gain      = dp.curve(x) / x;
+            UTEST_ASSERT_MSG(float_equals_adaptive(dst[LENGTH - 1], gain, 1e-2f),
+                "Gain differs at thresh=%f, range=%f, knee=%f, level=%f dB: %f vs %f",
+                thresh, range, knee, db, dst[LENGTH - 1], gain);
+        }
+
+        dp.destroy();
+    }
+
+    void check_lockstep()
+    {
+        static constexpr size_t LANES   = 7;
+        spike_bender::GainComputer single, lanes[LANES];
+        spike_bender::GainComputer *gc[LANES];
+        float src[LENGTH], ref[LENGTH], out[LANES][LENGTH];
+        float *dst[LANES];
+        const float *vsrc[LANES];
+
+        // Each lane has its own threshold and envelope, the result should not depend
+        // on the number of lanes processed together
+        for (size_t l=0; l<LANES; ++l)
+        {
+            UTEST_ASSERT(lanes[l].init(SAMPLE_RATE, 0.05f * (l + 1), 6.0f, 3.0f, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+            gc[l]           = &lanes[l];
+            dst[l]          = out[l];
+            vsrc[l]         = src;
+        }
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = 0.2f * (1.0f + sinf(float(i) * 0.01f));
+        spike_bender::GainComputer::process(gc, dst, vsrc, LANES, LENGTH);
+
+        for (size_t l=0; l<LANES; ++l)
+        {
+            UTEST_ASSERT(single.init(SAMPLE_RATE, 0.05f * (l + 1), 6.0f, 3.0f, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+            single.process(ref, src, LENGTH);
+            for (size_t i=0; i<LENGTH; ++i)
+            {
+                UTEST_ASSERT_MSG(ref[i] == out[l][i],
+                    "Gain differs at lane=%d, index=%d: %f vs %f",
+                    int(l), int(i), ref[i], out[l][i]);
+            }
+        }
+    }
+
+    void check_reuse()
+    {
+        float src[LENGTH], ref[LENGTH], dst[LENGTH];
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = 0.2f * (1.0f + sinf(float(i) * 0.01f));
+
+        spike_bender::GainComputer fresh;
+        UTEST_ASSERT(fresh.init(SAMPLE_RATE, 0.1f, 12.0f, 1.0f, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        fresh.process(ref, src, LENGTH);
+
+        // The exact mode between the table modes should not leave the table of the previous curve
+        spike_bender::GainComputer gc;
+        UTEST_ASSERT(gc.init(SAMPLE_RATE, 0.1f, 6.0f, 3.0f, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        gc.process(dst, src, LENGTH);
+        UTEST_ASSERT(gc.init(SAMPLE_RATE, 0.1f, 12.0f, 1.0f, spike_bender::GAIN_CURVE_EXACT) == STATUS_OK);
+        gc.process(dst, src, LENGTH);
+        UTEST_ASSERT(gc.init(SAMPLE_RATE, 0.1f, 12.0f, 1.0f, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        gc.process(dst, src, LENGTH);
+        for (size_t i=0; i<LENGTH; ++i)
+        {
+            UTEST_ASSERT_MSG(dst[i] == ref[i],
+                "Gain of the re-initialized table differs at index=%d: %f vs %f",
+                int(i), dst[i], ref[i]);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        spike_bender::GainComputer gc;
+
+        check_curve(&gc, 0.1f, 6.0f, 3.0f);
+        check_curve(&gc, 0.5f, 6.0f, 3.0f);
+        check_curve(&gc, 0.02f, 10.0f, 1.0f);
+
+        // The threshold shifts the curve, the table is left as is
+        UTEST_ASSERT(gc.init(SAMPLE_RATE, 0.1f, 6.0f, 3.0f, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        float a[LENGTH], b[LENGTH], src[LENGTH];
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = 0.05f;
+        gc.process(a, src, LENGTH);
+
+        UTEST_ASSERT(gc.init(SAMPLE_RATE, 0.1f, 6.0f, 3.0f, spike_bender::GAIN_CURVE_TABLE) == STATUS_OK);
+        gc.set_threshold(0.2f);
+        UTEST_ASSERT(gc.threshold() == 0.2f);
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = 0.1f;
+        gc.process(b, src, LENGTH);
+        UTEST_ASSERT(float_equals_adaptive(a[LENGTH - 1], b[LENGTH - 1], 1e-5f));
+
+        // Lockstep processing of several gain computers
+        check_lockstep();
+
+        // Switching between the modes with different curves
+        check_reuse();
+
+        // Reactions to bursts and steps of the envelope
+        make_bursts(src, 0.1f);
+        check_dynamics(src, 0.1f, 6.0f, 3.0f);
+        make_steps(src, 0.1f);
+        check_dynamics(src, 0.1f, 6.0f, 3.0f);
+        make_steps(src, 0.02f);
+        check_dynamics(src, 0.02f, 10.0f, 1.0f);
+    }
+
+UTEST_END
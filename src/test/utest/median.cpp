@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <stdlib.h>
+
+#include <private/audio.h>
+
+UTEST_BEGIN("spike_bender", median)
+
+    enum fill_t
+    {
+        F_RANDOM,
+        F_DUPLICATES,
+        F_SORTED,
+        F_REVERSE,
+        F_EQUAL,
+
+        F_TOTAL
+    };
+
+    static int compare_gain(const void *a, const void *b)
+    {
+        const float fa = *static_cast<const float *>(a);
+        const float fb = *static_cast<const float *>(b);
+        if (fa < fb)
+            return -1;
+        return (fa > fb) ? 1 : 0;
+    }
+
+    // The result of the former qsort-based implementation
+    static float reference_median(const lltl::darray<spike_bender::peak_t> *list)
+    {
+        const size_t size = list->size();
+        if (size < 2)
+            return (size > 0) ? list->uget(0)->gain : 0.0f;
+
+        float *v        = new float[size];
+        lsp_finally { delete [] v; };
+        for (size_t i=0; i<size; ++i)
+            v[i]            = list->uget(i)->gain;
+        qsort(v, size, sizeof(float), compare_gain);
+
+        if (size & 1)
+            return 0.5f * (v[size >> 1] + v[(size >> 1) + 1]);
+        return v[size >> 1];
+    }
+
+    void fill(lltl::darray<spike_bender::peak_t> *list, size_t size, fill_t type)
+    {
+        list->clear();
+        spike_bender::peak_t *p = list->append_n(size);
+        UTEST_ASSERT((p != NULL) || (size == 0));
+
+        for (size_t i=0; i<size; ++i)
+        {
+            p[i].index      = i;
+            switch (type)
+            {
+                case F_RANDOM:      p[i].gain = float(rand()) / RAND_MAX; break;
+                case F_DUPLICATES:  p[i].gain = float(rand() % 5) * 0.25f; break;
+                case F_SORTED:      p[i].gain = float(i); break;
+                case F_REVERSE:     p[i].gain = float(size - i); break;
+                default:            p[i].gain = 0.5f; break;
+            }
+        }
+    }
+
+    void check_median(lltl::darray<spike_bender::peak_t> *list, lltl::darray<float> *buf)
+    {
+        const float ref = reference_median(list);
+        float res       = -1.0f;
+        UTEST_ASSERT(spike_bender::median_value(&res, list, buf));
+        UTEST_ASSERT_MSG(res == ref, "Median differs for size=%d: %f vs %f", int(list->size()), res, ref);
+    }
+
+    UTEST_MAIN
+    {
+        lltl::darray<spike_bender::peak_t> list;
+        lltl::darray<float> buf;
+
+        srand(0);
+        static const size_t sizes[] = { 0, 1, 2, 3, 4, 5, 6, 7, 8, 15, 16, 100, 101, 1000, 1001, 10000 };
+        for (size_t i=0; i<sizeof(sizes)/sizeof(sizes[0]); ++i)
+        {
+            for (size_t j=0; j<F_TOTAL; ++j)
+            {
+                for (size_t k=0; k<4; ++k)
+                {
+                    fill(&list, sizes[i], fill_t(j));
+                    check_median(&list, &buf);
+                    check_median(&list, NULL);
+                }
+            }
+        }
+    }
+
+UTEST_END
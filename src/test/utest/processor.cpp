@@ -0,0 +1,237 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/common/status.h>
+#include <lsp-plug.in/dsp/dsp.h>
+#include <lsp-plug.in/dsp-units/units.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/audio.h>
+#include <private/config.h>
+#include <private/processor.h>
+#include <private/stream.h>
+#include <spike-bender/processor.h>
+
+UTEST_BEGIN("spike_bender", processor)
+
+    static constexpr size_t SAMPLE_RATE     = 8000;
+    static constexpr size_t CHANNELS        = 2;
+    static constexpr size_t LENGTH          = 40000;
+    static constexpr size_t BLOCK_SIZE      = 777;
+
+    void fill_signal(dspu::Sample *s)
+    {
+        UTEST_ASSERT(s->init(CHANNELS, LENGTH, LENGTH));
+        s->set_sample_rate(SAMPLE_RATE);
+
+        uint32_t seed = 0x1234;
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            float *dst = s->channel(i);
+            for (size_t j=0; j<LENGTH; ++j)
+            {
+                seed            = seed * 1664525 + 1013904223;
+                float noise     = float(seed >> 8) / float(1 << 24) - 0.5f;
+                float env       = 0.1f + 0.8f * fabsf(sinf(float(j) * (i + 1) * 0.0005f));
+                dst[j]          = env * (noise + sinf(float(j) * 0.05f));
+            }
+        }
+    }
+
+    void process_reference(dspu::Sample *s, const spike_bender::config_t *cfg)
+    {
+        dspu::Sample rms;
+        float level[CHANNELS];
+
+        size_t period   = size_t(dspu::millis_to_samples(SAMPLE_RATE, 400.0f)) | 1;
+        UTEST_ASSERT(spike_bender::estimate_rms(&rms, s, cfg->enWeighting, period) == STATUS_OK);
+        for (size_t i=0; i<CHANNELS; ++i)
+            level[i]        = dsp::abs_max(rms.channel(i), rms.length());
+
+        // The pre-scan gives the same level without decimation and the close one with decimation
+        float peak[CHANNELS], coarse[CHANNELS];
+        UTEST_ASSERT(spike_bender::estimate_rms_peak(peak, s, cfg->enWeighting, period, 1) == STATUS_OK);
+        UTEST_ASSERT(spike_bender::estimate_rms_peak(coarse, s, cfg->enWeighting, period, 64) == STATUS_OK);
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(peak[i] == level[i]);
+            UTEST_ASSERT(float_equals_adaptive(coarse[i], level[i], 1e-2f));
+        }
+
+        period          = size_t(dspu::millis_to_samples(SAMPLE_RATE, cfg->fReactivity)) | 1;
+        UTEST_ASSERT(spike_bender::process_passes(s, cfg->nPasses, cfg->enWeighting, period,
+            level, cfg->fRange, cfg->fKnee) == STATUS_OK);
+    }
+
+    template <class P, class S>
+    void process_blocks(dspu::Sample *s, P *p, S ok, S bad_state)
+    {
+        float *buf[CHANNELS];
+        size_t written;
+
+        // Analyze the signal
+        for (size_t off=0; off<LENGTH; off += BLOCK_SIZE)
+        {
+            size_t count    = lsp_min(LENGTH - off, BLOCK_SIZE);
+            for (size_t i=0; i<CHANNELS; ++i)
+                buf[i]          = s->channel(i, off);
+            UTEST_ASSERT(p->analyze(buf, count) == ok);
+        }
+
+        // Process the signal in place
+        size_t wr       = 0;
+        for (size_t off=0; off<LENGTH; off += BLOCK_SIZE)
+        {
+            size_t count    = lsp_min(LENGTH - off, BLOCK_SIZE);
+            float *dst[CHANNELS];
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                buf[i]          = s->channel(i, off);
+                dst[i]          = s->channel(i, wr);
+            }
+            UTEST_ASSERT(p->process(dst, buf, count, &written) == ok);
+            wr             += written;
+        }
+        UTEST_ASSERT(wr + p->latency() == LENGTH);
+        UTEST_ASSERT(p->analyze(buf, 0) == bad_state);
+
+        // Pull the latency tail
+        do
+        {
+            for (size_t i=0; i<CHANNELS; ++i)
+                buf[i]          = s->channel(i, wr);
+            UTEST_ASSERT(p->flush(buf, lsp_min(LENGTH - wr, BLOCK_SIZE), &written) == ok);
+            wr             += written;
+        } while (written > 0);
+        UTEST_ASSERT(wr == LENGTH);
+    }
+
+    void compare(const dspu::Sample *ref, const dspu::Sample *out)
+    {
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            const float *a  = ref->channel(i);
+            const float *b  = out->channel(i);
+            for (size_t j=0; j<LENGTH; ++j)
+            {
+                UTEST_ASSERT_MSG(float_equals_adaptive(a[j], b[j], 1e-5f),
+                    "Samples differ at channel=%d, index=%d: %f vs %f",
+                    int(i), int(j), a[j], b[j]);
+            }
+        }
+    }
+
+    void process_live(const spike_bender::config_t *cfg)
+    {
+        dspu::Sample s;
+        float *buf[CHANNELS];
+        size_t written, wr = 0;
+
+        fill_signal(&s);
+        spike_bender::Processor p;
+        UTEST_ASSERT(p.init(cfg, CHANNELS, SAMPLE_RATE) == STATUS_OK);
+        UTEST_ASSERT(p.live());
+
+        // The level is tracked while processing, no analysis is allowed
+        for (size_t i=0; i<CHANNELS; ++i)
+            buf[i]          = s.channel(i);
+        UTEST_ASSERT(p.analyze(buf, BLOCK_SIZE) == STATUS_BAD_STATE);
+
+        for (size_t off=0; off<LENGTH; off += BLOCK_SIZE)
+        {
+            size_t count    = lsp_min(LENGTH - off, BLOCK_SIZE);
+            float *dst[CHANNELS];
+            for (size_t i=0; i<CHANNELS; ++i)
+            {
+                buf[i]          = s.channel(i, off);
+                dst[i]          = s.channel(i, wr);
+            }
+            UTEST_ASSERT(p.process(dst, buf, count, &written) == STATUS_OK);
+            wr             += written;
+        }
+        do
+        {
+            for (size_t i=0; i<CHANNELS; ++i)
+                buf[i]          = s.channel(i, wr);
+            UTEST_ASSERT(p.flush(buf, lsp_min(LENGTH - wr, BLOCK_SIZE), &written) == STATUS_OK);
+            wr             += written;
+        } while (written > 0);
+        UTEST_ASSERT(wr == LENGTH);
+
+        for (size_t i=0; i<CHANNELS; ++i)
+        {
+            UTEST_ASSERT(p.level(i) > spike_bender::LIVE_LEVEL_MIN);
+            const float *v  = s.channel(i);
+            for (size_t j=0; j<LENGTH; ++j)
+                UTEST_ASSERT(isfinite(v[j]));
+        }
+    }
+
+    UTEST_MAIN
+    {
+        spike_bender::config_t cfg;
+        cfg.nPasses     = 3;
+        cfg.fReactivity = 20.0f;
+        cfg.nBlockSize  = 1000;
+        cfg.enWeighting = spike_bender::K_WEIGHT;
+
+        dspu::Sample ref, out;
+        fill_signal(&ref);
+        fill_signal(&out);
+        process_reference(&ref, &cfg);
+
+        // Process the signal twice to check that reset() restores the initial state
+        spike_bender::Processor p;
+        UTEST_ASSERT(p.init(&cfg, CHANNELS, SAMPLE_RATE) == STATUS_OK);
+        for (size_t k=0; k<2; ++k)
+        {
+            fill_signal(&out);
+            process_blocks(&out, &p, STATUS_OK, STATUS_BAD_STATE);
+            UTEST_ASSERT(p.reset() == STATUS_OK);
+            compare(&ref, &out);
+        }
+
+        // The public interface gives the same result
+        spike_bender::block_params_t params;
+        spike_bender::init_block_params(&params);
+        params.nPasses      = cfg.nPasses;
+        params.fReactivity  = cfg.fReactivity;
+        params.nBlockSize   = cfg.nBlockSize;
+        params.enWeighting  = spike_bender::BLOCK_WEIGHT_K;
+
+        spike_bender::BlockProcessor bp;
+        UTEST_ASSERT(bp.analyze(NULL, 0) == spike_bender::SB_BAD_STATE);
+        UTEST_ASSERT(bp.init(NULL, CHANNELS, SAMPLE_RATE) == spike_bender::SB_BAD_ARGUMENTS);
+        UTEST_ASSERT(bp.init(&params, 0, SAMPLE_RATE) == spike_bender::SB_BAD_ARGUMENTS);
+        UTEST_ASSERT(bp.init(&params, CHANNELS, SAMPLE_RATE) == spike_bender::SB_OK);
+        UTEST_ASSERT(bp.latency() == p.latency());
+        fill_signal(&out);
+        process_blocks(&out, &bp, spike_bender::SB_OK, spike_bender::SB_BAD_STATE);
+        compare(&ref, &out);
+
+        // Process the signal in live mode
+        cfg.bLive       = true;
+        process_live(&cfg);
+    }
+
+UTEST_END
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/audio.h>
+#include <private/window.h>
+
+UTEST_BEGIN("spike_bender", ramp)
+
+    static constexpr size_t LENGTH          = spike_bender::WINDOW_BLOCK_SIZE * 2 + 123;
+
+    // Scalar smoothstep used for gain compensation of smashed ranges
+    static inline float interpolate(float a, float b, float x)
+    {
+        float d = b - a;
+        return a + d * x * x * (3.0f - 2.0f * x);
+    }
+
+    void check_ramp(float *buf, float gain, float egain, size_t count)
+    {
+        for (size_t i=0; i<count; ++i)
+            buf[i]          = 0.5f + 0.25f * sinf(float(i) * 0.1f);
+        spike_bender::apply_peak_ramp(buf, gain, egain, count);
+
+        float k         = 1.0f / count;
+        for (size_t i=0; i<count; ++i)
+        {
+            float src       = 0.5f + 0.25f * sinf(float(i) * 0.1f);
+            float ref       = src * interpolate(gain, egain, i * k);
+            UTEST_ASSERT_MSG(float_equals_adaptive(buf[i], ref, 1e-5f),
+                "Ramp differs at gain=%f, egain=%f, count=%d, index=%d: %f vs %f",
+                gain, egain, int(count), int(i), buf[i], ref);
+        }
+    }
+
+    UTEST_MAIN
+    {
+        float *buf      = new float[LENGTH];
+        UTEST_ASSERT(buf != NULL);
+        lsp_finally { delete [] buf; };
+
+        static const size_t counts[] = { 1, 2, 7, 100, spike_bender::WINDOW_BLOCK_SIZE, spike_bender::WINDOW_BLOCK_SIZE + 1, LENGTH };
+        for (size_t i=0; i<sizeof(counts)/sizeof(counts[0]); ++i)
+        {
+            check_ramp(buf, 1.0f, 0.25f, counts[i]);
+            check_ramp(buf, 0.25f, 1.0f, counts[i]);
+            check_ramp(buf, 0.5f, 0.5f, counts[i]);
+            check_ramp(buf, 1.0f, 1.0f, counts[i]);
+        }
+    }
+
+UTEST_END
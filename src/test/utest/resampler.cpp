@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/stdlib/math.h>
+
+#include <private/resampler.h>
+
+UTEST_BEGIN("spike_bender", resampler)
+
+    static constexpr size_t LENGTH          = 12345;
+    static constexpr size_t BLOCK_SIZE      = 777;
+    static constexpr size_t FLUSH_SIZE      = 100;
+    static constexpr size_t EDGE            = 256;          // Samples at the edges affected by the zero padding
+    static constexpr float FREQUENCY        = 1000.0f;
+    static constexpr float AMPLITUDE        = 0.5f;
+
+    static inline float tone(size_t index, size_t sample_rate)
+    {
+        return AMPLITUDE * sinf(2.0f * M_PI * FREQUENCY * index / sample_rate);
+    }
+
+    size_t resample(float *dst, const float *src, spike_bender::Resampler *r)
+    {
+        size_t wr       = 0;
+        for (size_t off=0; off<LENGTH; off += BLOCK_SIZE)
+        {
+            size_t count    = lsp_min(LENGTH - off, BLOCK_SIZE);
+            size_t n        = r->process(&dst[wr], &src[off], count);
+            UTEST_ASSERT(n <= r->max_output(count));
+            wr             += n;
+        }
+
+        // The tail is flushed in small portions until the stream is complete
+        for (size_t n; (n = r->flush(&dst[wr], FLUSH_SIZE)) > 0; )
+        {
+            UTEST_ASSERT(n <= FLUSH_SIZE);
+            wr             += n;
+        }
+
+        return wr;
+    }
+
+    void check_rates(size_t src_rate, size_t dst_rate, spike_bender::resample_t quality, float tolerance)
+    {
+        printf("Testing %d -> %d Hz, quality %d\n", int(src_rate), int(dst_rate), int(quality));
+
+        spike_bender::Resampler r;
+        UTEST_ASSERT(spike_bender::Resampler::supported(src_rate, dst_rate));
+        UTEST_ASSERT(r.init(src_rate, dst_rate, quality) == STATUS_OK);
+
+        // The output has the length of the input at the new sample rate, rounded up
+        size_t length   = (LENGTH * dst_rate + src_rate - 1) / src_rate;
+        UTEST_ASSERT(r.output_length(LENGTH) == length);
+
+        float *src      = new float[LENGTH];
+        UTEST_ASSERT(src != NULL);
+        lsp_finally { delete [] src; };
+        float *dst      = new float[length * 2 + FLUSH_SIZE];
+        UTEST_ASSERT(dst != NULL);
+        lsp_finally { delete [] dst; };
+        float *out      = &dst[length + FLUSH_SIZE];
+
+        for (size_t i=0; i<LENGTH; ++i)
+            src[i]          = tone(i, src_rate);
+
+        size_t count    = resample(dst, src, &r);
+        UTEST_ASSERT_MSG(count == length, "Output length %d, expected %d", int(count), int(length));
+
+        // The latency is compensated: the output follows the analytic signal without phase shift
+        size_t edge     = (EDGE * dst_rate + src_rate - 1) / src_rate;
+        for (size_t i=edge; i<length - edge; ++i)
+        {
+            float ref       = tone(i, dst_rate);
+            UTEST_ASSERT_MSG(fabsf(dst[i] - ref) <= tolerance,
+                "Output differs from the analytic signal at index=%d: %f vs %f", int(i), dst[i], ref);
+        }
+
+        // The stream is processed again with the same result after reset
+        r.reset();
+        UTEST_ASSERT(resample(out, src, &r) == length);
+        for (size_t i=0; i<length; ++i)
+            UTEST_ASSERT_MSG(out[i] == dst[i], "Output after reset differs at index=%d: %f vs %f", int(i), out[i], dst[i]);
+    }
+
+    UTEST_MAIN
+    {
+        // Rational ratio, both directions
+        check_rates(44100, 48000, spike_bender::RESAMPLE_NORMAL, 5e-4f);
+        check_rates(48000, 44100, spike_bender::RESAMPLE_NORMAL, 5e-4f);
+        check_rates(44100, 48000, spike_bender::RESAMPLE_BEST, 5e-4f);
+        check_rates(48000, 44100, spike_bender::RESAMPLE_FAST, 1e-3f);
+
+        // Integer decimation and interpolation
+        check_rates(96000, 48000, spike_bender::RESAMPLE_NORMAL, 5e-4f);
+        check_rates(48000, 96000, spike_bender::RESAMPLE_NORMAL, 5e-4f);
+    }
+
+UTEST_END
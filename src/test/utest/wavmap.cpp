@@ -0,0 +1,278 @@
+/*
+ * Copyright (C) 2026 Linux Studio Plugins Project <https://lsp-plug.in/>
+ *           (C) 2026 Vladimir Sadovnikov <sadko4u@gmail.com>
+ *
+ * This file is part of spike-bender
+ * Created on: 14 окт. 2026 г.
+ *
+ * spike-bender is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * any later version.
+ *
+ * spike-bender is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with spike-bender. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <lsp-plug.in/test-fw/utest.h>
+#include <lsp-plug.in/test-fw/helpers.h>
+#include <lsp-plug.in/io/Path.h>
+#include <lsp-plug.in/stdlib/math.h>
+#include <lsp-plug.in/stdlib/stdio.h>
+#include <lsp-plug.in/stdlib/string.h>
+
+#include <private/wavmap.h>
+
+UTEST_BEGIN("spike_bender", wavmap)
+
+    static constexpr size_t CHANNELS        = 3;
+    static constexpr size_t FRAMES          = 1001;
+    static constexpr size_t SAMPLE_RATE     = 44100;
+    static constexpr uint16_t FORMAT_PCM    = 0x0001;
+    static constexpr uint16_t FORMAT_FLOAT  = 0x0003;
+
+    enum layout_t
+    {
+        L_RIFF          = 0,
+        L_EXTENSIBLE    = 1 << 0,       // WAVE_FORMAT_EXTENSIBLE with the format tag in the sub-format
+        L_ODD_CHUNK     = 1 << 1,       // Chunk of odd size followed by the padding byte before data
+        L_TRUNCATED     = 1 << 2,       // Data chunk is larger than the rest of the file
+        L_RF64          = 1 << 3,       // RF64 with 'ds64' chunk
+        L_NO_DS64       = 1 << 4        // RF64 without 'ds64' chunk
+    };
+
+    static float sample_value(size_t channel, size_t frame)
+    {
+        return 0.95f * sinf(float(frame) * 0.01f * (channel + 1));
+    }
+
+    static void put(FILE *fd, const void *data, size_t size)
+    {
+        fwrite(data, size, 1, fd);
+    }
+
+    static void put_u16(FILE *fd, uint16_t v)
+    {
+        uint8_t b[2] = { uint8_t(v), uint8_t(v >> 8) };
+        put(fd, b, sizeof(b));
+    }
+
+    static void put_u32(FILE *fd, uint32_t v)
+    {
+        put_u16(fd, uint16_t(v));
+        put_u16(fd, uint16_t(v >> 16));
+    }
+
+    static void put_u64(FILE *fd, uint64_t v)
+    {
+        put_u32(fd, uint32_t(v));
+        put_u32(fd, uint32_t(v >> 32));
+    }
+
+    /**
+     * Encode the sample and return the value expected after decoding
+     */
+    static double encode(FILE *fd, uint16_t tag, size_t bits, float v)
+    {
+        if (tag == FORMAT_FLOAT)
+        {
+            if (bits == 64)
+            {
+                double d = v;
+                uint64_t x;
+                memcpy(&x, &d, sizeof(x));
+                put_u64(fd, x);
+                return d;
+            }
+            uint32_t x;
+            memcpy(&x, &v, sizeof(x));
+            put_u32(fd, x);
+            return v;
+        }
+
+        switch (bits)
+        {
+            case 8:
+            {
+                int32_t q = int32_t(lrint(v * 127.0));
+                uint8_t b = uint8_t(q + 128);
+                put(fd, &b, 1);
+                return q / 128.0;
+            }
+            case 16:
+            {
+                int32_t q = int32_t(lrint(v * 32767.0));
+                put_u16(fd, uint16_t(q));
+                return q / 32768.0;
+            }
+            case 24:
+            {
+                int32_t q = int32_t(lrint(v * 8388607.0));
+                uint8_t b[3] = { uint8_t(q), uint8_t(q >> 8), uint8_t(q >> 16) };
+                put(fd, b, sizeof(b));
+                return q / 8388608.0;
+            }
+            default:
+            {
+                int32_t q = int32_t(lrint(v * 2147483647.0));
+                put_u32(fd, uint32_t(q));
+                return q / 2147483648.0;
+            }
+        }
+    }
+
+    void write_file(const char *path, uint16_t tag, size_t bits, size_t layout, double *expected)
+    {
+        FILE *fd        = fopen(path, "wb");
+        UTEST_ASSERT(fd != NULL);
+
+        const size_t frame_size = CHANNELS * (bits / 8);
+        const size_t data_size  = FRAMES * frame_size;
+        const bool rf64         = layout & (L_RF64 | L_NO_DS64);
+
+        put(fd, (rf64) ? "RF64" : "RIFF", 4);
+        put_u32(fd, (rf64) ? 0xffffffff : 0);           // The size of RIFF is not checked by the reader
+        put(fd, "WAVE", 4);
+        if (layout & L_RF64)
+        {
+            put(fd, "ds64", 4);
+            put_u32(fd, 28);
+            put_u64(fd, 0);
+            put_u64(fd, data_size);
+            put_u64(fd, FRAMES);
+            put_u32(fd, 0);
+        }
+
+        put(fd, "fmt ", 4);
+        put_u32(fd, (layout & L_EXTENSIBLE) ? 40 : 16);
+        put_u16(fd, (layout & L_EXTENSIBLE) ? 0xfffe : tag);
+        put_u16(fd, CHANNELS);
+        put_u32(fd, SAMPLE_RATE);
+        put_u32(fd, SAMPLE_RATE * frame_size);
+        put_u16(fd, frame_size);
+        put_u16(fd, bits);
+        if (layout & L_EXTENSIBLE)
+        {
+            static const uint8_t guid[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+            put_u16(fd, 22);                            // Size of the extension
+            put_u16(fd, bits);                          // Valid bits per sample
+            put_u32(fd, 0);                             // Channel mask
+            put_u16(fd, tag);                           // Sub-format
+            put(fd, guid, sizeof(guid));
+        }
+        if (layout & L_ODD_CHUNK)
+        {
+            put(fd, "LIST", 4);
+            put_u32(fd, 3);
+            put(fd, "abc", 3);
+            put(fd, "", 1);                             // Padding byte
+        }
+
+        put(fd, "data", 4);
+        put_u32(fd, (rf64) ? 0xffffffff : data_size);
+
+        // The truncated file holds the half of frames and the part of the next frame
+        size_t frames   = (layout & L_TRUNCATED) ? FRAMES / 2 : FRAMES;
+        for (size_t i=0; i<frames; ++i)
+            for (size_t j=0; j<CHANNELS; ++j)
+                expected[j * FRAMES + i] = encode(fd, tag, bits, sample_value(j, i));
+        if (layout & L_TRUNCATED)
+            encode(fd, tag, bits, sample_value(0, frames));
+
+        fclose(fd);
+    }
+
+    void check_file(size_t index, uint16_t tag, size_t bits, size_t layout)
+    {
+        printf("Testing tag=%d, bits=%d, layout=0x%x\n", int(tag), int(bits), int(layout));
+
+        io::Path path;
+        UTEST_ASSERT(path.fmt("%s/%s-%d.wav", tempdir(), full_name(), int(index)) > 0);
+
+        double *expected    = new double[CHANNELS * FRAMES];
+        UTEST_ASSERT(expected != NULL);
+        lsp_finally { delete [] expected; };
+        float *buf          = new float[FRAMES];
+        UTEST_ASSERT(buf != NULL);
+        lsp_finally { delete [] buf; };
+
+        write_file(path.as_native(), tag, bits, layout, expected);
+        lsp_finally { remove(path.as_native()); };
+
+        spike_bender::WavReader r;
+        if (layout & L_NO_DS64)
+        {
+            UTEST_ASSERT(r.open(path.as_string()) == STATUS_CORRUPTED_FILE);
+            return;
+        }
+        UTEST_ASSERT(r.open(path.as_string()) == STATUS_OK);
+        lsp_finally { r.close(); };
+
+        size_t frames   = (layout & L_TRUNCATED) ? FRAMES / 2 : FRAMES;
+        UTEST_ASSERT(r.channels() == CHANNELS);
+        UTEST_ASSERT(r.sample_rate() == SAMPLE_RATE);
+        UTEST_ASSERT_MSG(r.length() == frames, "Length %d, expected %d", int(r.length()), int(frames));
+
+        // Read each channel in two parts to check the offset
+        for (size_t j=0; j<CHANNELS; ++j)
+        {
+            size_t half     = frames / 3;
+            UTEST_ASSERT(r.read(buf, j, 0, half) == half);
+            UTEST_ASSERT(r.read(&buf[half], j, half, FRAMES) == frames - half);
+            UTEST_ASSERT(r.read(buf, j, frames, 1) == 0);
+
+            const double *v = &expected[j * FRAMES];
+            for (size_t i=0; i<frames; ++i)
+            {
+                UTEST_ASSERT_MSG(fabs(buf[i] - v[i]) <= 1e-7 * fabs(v[i]) + 1e-9,
+                    "Samples differ at channel=%d, index=%d: %f vs %f", int(j), int(i), buf[i], v[i]);
+            }
+        }
+        r.close();
+
+        // The samples are written back as 32-bit float and read without loss
+        spike_bender::WavWriter w;
+        UTEST_ASSERT(w.open(path.as_string(), CHANNELS, SAMPLE_RATE, frames) == STATUS_OK);
+        for (size_t j=0; j<CHANNELS; ++j)
+        {
+            const double *v = &expected[j * FRAMES];
+            for (size_t i=0; i<frames; ++i)
+                buf[i]          = float(v[i]);
+            UTEST_ASSERT(w.write(j, buf, 0, frames) == frames);
+        }
+        UTEST_ASSERT(w.close() == STATUS_OK);
+
+        UTEST_ASSERT(r.open(path.as_string()) == STATUS_OK);
+        UTEST_ASSERT(r.length() == frames);
+        for (size_t j=0; j<CHANNELS; ++j)
+        {
+            const double *v = &expected[j * FRAMES];
+            UTEST_ASSERT(r.read(buf, j, 0, frames) == frames);
+            for (size_t i=0; i<frames; ++i)
+                UTEST_ASSERT_MSG(buf[i] == float(v[i]), "Samples differ at channel=%d, index=%d", int(j), int(i));
+        }
+    }
+
+    UTEST_MAIN
+    {
+        static const size_t pcm_bits[]      = { 8, 16, 24, 32 };
+        static const size_t float_bits[]    = { 32, 64 };
+        static const size_t layouts[]       = { L_RIFF, L_EXTENSIBLE, L_ODD_CHUNK, L_TRUNCATED, L_RF64, L_RF64 | L_ODD_CHUNK, L_NO_DS64 };
+
+        size_t index = 0;
+        for (size_t i=0; i<sizeof(layouts)/sizeof(layouts[0]); ++i)
+        {
+            for (size_t j=0; j<sizeof(pcm_bits)/sizeof(pcm_bits[0]); ++j)
+                check_file(index++, FORMAT_PCM, pcm_bits[j], layouts[i]);
+            for (size_t j=0; j<sizeof(float_bits)/sizeof(float_bits[0]); ++j)
+                check_file(index++, FORMAT_FLOAT, float_bits[j], layouts[i]);
+        }
+    }
+
+UTEST_END